@@ -0,0 +1,103 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @defgroup    nanocbor_canonical NanoCBOR deterministic encoding
+ * @brief       Produce and verify deterministically encoded CBOR
+ *
+ * The encoder always emits the shortest form of integers, lengths and
+ * floats. What remains for deterministic encoding as described in RFC 8949
+ * section 4.2 is the order of map keys. A map written with
+ * @ref nanocbor_fmt_map_begin can be closed with
+ * @ref nanocbor_canonical_map_end to sort its entries in place:
+ *
+ * ```C
+ * nanocbor_canonical_entry_t scratch[8];
+ * nanocbor_deferred_t map;
+ *
+ * nanocbor_fmt_map_begin(&enc, &map);
+ * nanocbor_put_tstr(&enc, "name");
+ * nanocbor_put_tstr(&enc, "sensor");
+ * nanocbor_fmt_uint(&enc, 1);
+ * nanocbor_fmt_uint(&enc, 42);
+ * nanocbor_canonical_map_end(&enc, &map, scratch, 8);
+ * ```
+ *
+ * Nested maps are closed before their parent, so sorting every map of a
+ * document this way gives a deterministic encoding of the whole document.
+ * @ref nanocbor_canonical_check verifies received or stored documents.
+ *
+ * @{
+ *
+ * @file
+ */
+
+#ifndef NANOCBOR_CANONICAL_H
+#define NANOCBOR_CANONICAL_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "nanocbor/nanocbor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Scratch entry used while sorting a map, one per map entry
+ */
+typedef struct nanocbor_canonical_entry {
+    size_t offset;  /**< Offset of the entry in the map body */
+    size_t key_len; /**< Length of the encoded key */
+    size_t len;     /**< Length of the encoded key and value */
+} nanocbor_canonical_entry_t;
+
+/**
+ * @brief Sort the entries of a deferred length map and finish it
+ *
+ * Entries are sorted by the bytewise lexicographic order of their encoded
+ * keys. The entries are moved within the encoder buffer, so no memory
+ * beyond @p scratch is needed. Same requirements as
+ * @ref nanocbor_fmt_container_end apply.
+ *
+ * @param[in]   enc     encoder context
+ * @param[in]   map     deferred map started with @ref nanocbor_fmt_map_begin
+ * @param[in]   scratch scratch entries
+ * @param[in]   num     number of scratch entries
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              NANOCBOR_ERR_OVERFLOW when the map has more than
+ *                      @p num entries
+ * @return              NANOCBOR_ERR_INVALID_TYPE when the map contains a
+ *                      duplicate key or @p map is not a map
+ * @return              NANOCBOR_ERR_END when the map is not completely in
+ *                      the encoder buffer
+ */
+int nanocbor_canonical_map_end(nanocbor_encoder_t *enc, nanocbor_deferred_t *map,
+                               nanocbor_canonical_entry_t *scratch, size_t num);
+
+/**
+ * @brief Verify that the next item is deterministically encoded
+ *
+ * Checks that all integers, lengths and tags use their shortest form, that
+ * floats use the shortest form the encoder produces, that no indefinite
+ * length items are used and that map keys are unique and sorted. On
+ * success, @p it is advanced past the item.
+ *
+ * @param[in]   it      CBOR value to verify
+ *
+ * @return              NANOCBOR_OK when the item is deterministically
+ *                      encoded
+ * @return              NANOCBOR_ERR_INVALID_TYPE when it is not
+ * @return              negative on decode error
+ */
+int nanocbor_canonical_check(nanocbor_value_t *it);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NANOCBOR_CANONICAL_H */
+/** @} */
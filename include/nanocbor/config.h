@@ -23,12 +23,60 @@ extern "C" {
 #endif
 
 /**
- * @brief Recursion limit when using @ref nanocbor_skip.
+ * @brief Nesting depth limit when using @ref nanocbor_skip.
+ *
+ * Every level of nesting costs a 32 bit counter and a bit of stack space
+ * during the skip.
  */
 #ifndef NANOCBOR_RECURSION_MAX
 #define NANOCBOR_RECURSION_MAX  10
 #endif
 
+/**
+ * @brief Use SSE2 or NEON instructions, when available, to skip runs of
+ * single byte integers in @ref nanocbor_skip.
+ */
+#ifndef NANOCBOR_SKIP_SIMD
+#define NANOCBOR_SKIP_SIMD  1
+#endif
+
+/**
+ * @brief Validate text strings as UTF-8 while decoding
+ *
+ * When enabled, @ref nanocbor_get_tstr and @ref nanocbor_skip return
+ * NANOCBOR_ERR_INVALID_UTF8 for text strings that are not valid UTF-8.
+ */
+#ifndef NANOCBOR_VALIDATE_UTF8
+#define NANOCBOR_VALIDATE_UTF8  0
+#endif
+
+/**
+ * @brief Use AVX2, SSE2 or NEON instructions, when available, to validate
+ * runs of ASCII in @ref nanocbor_utf8_valid.
+ */
+#ifndef NANOCBOR_UTF8_SIMD
+#define NANOCBOR_UTF8_SIMD  1
+#endif
+
+/**
+ * @brief Keep decoder and encoder statistics and call a trace hook on
+ * errors, see nanocbor/stats.h
+ */
+#ifndef NANOCBOR_STATS
+#define NANOCBOR_STATS      0
+#endif
+
+/**
+ * @brief Replace the common decoder getters with inline fast paths
+ *
+ * Integer and bool getters decode immediate values inline and fall back to
+ * the regular functions otherwise, see nanocbor.h. This trades code size
+ * for speed and is meant for host builds.
+ */
+#ifndef NANOCBOR_INLINE
+#define NANOCBOR_INLINE     0
+#endif
+
 /**
  * @brief library providing htonll, be64toh or equivalent. Must also provide
  * the reverse operation (ntohll, htobe64 or equivalent)
@@ -64,6 +112,31 @@ extern "C" {
 #define NANOCBOR_HTOBE32_FUNC(he)   htobe32(he)
 #endif
 
+/**
+ * @brief call providing a count leading zeros operation
+ *
+ * must take a non-zero uint64_t and return the number of leading zero bits.
+ * When not available, header widths are determined with comparisons.
+ */
+#ifndef NANOCBOR_CLZ64_FUNC
+#if defined(__GNUC__) || defined(__clang__)
+#define NANOCBOR_CLZ64_FUNC(x)      __builtin_clzll(x)
+#endif
+#endif
+
+/**
+ * @brief Host stores multi-byte numbers big endian
+ *
+ * Selects the native byte order variants of the RFC 8746 typed array tags.
+ */
+#ifndef NANOCBOR_HOST_BIG_ENDIAN
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#define NANOCBOR_HOST_BIG_ENDIAN    1
+#else
+#define NANOCBOR_HOST_BIG_ENDIAN    0
+#endif
+#endif
+
 /**
  * @brief configuration for size_t SIZE_MAX equivalent
  */
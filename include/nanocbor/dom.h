@@ -0,0 +1,179 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @defgroup    nanocbor_dom NanoCBOR document tree
+ * @brief       Decode a CBOR item into a tree of nodes
+ *
+ * A single pass over an item builds a tree of decoded nodes in a caller
+ * supplied array. The children of an array, map or tag are stored
+ * contiguously, child n of a container is a single lookup. String nodes
+ * point into the decoded buffer, which must stay valid while the tree is
+ * used:
+ *
+ * ```C
+ * nanocbor_dom_node_t nodes[32];
+ * nanocbor_dom_t dom;
+ * size_t root;
+ *
+ * nanocbor_dom_init(&dom, nodes, 32);
+ * nanocbor_dom_build(&dom, &it, &root);
+ * const nanocbor_dom_node_t *temp =
+ *     nanocbor_dom_map_get_tstr(&dom, &nodes[root], "temp");
+ * ```
+ *
+ * A tree is written back with @ref nanocbor_dom_encode. Containers are
+ * written with a definite length and floats in their shortest lossless
+ * form, so the output can differ from the decoded input.
+ *
+ * @{
+ *
+ * @file
+ */
+
+#ifndef NANOCBOR_DOM_H
+#define NANOCBOR_DOM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "nanocbor/nanocbor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Node type for simple values, including booleans, null and
+ *        undefined. The other node types are the major CBOR types, with
+ *        NANOCBOR_TYPE_FLOAT for floating point numbers only.
+ */
+#define NANOCBOR_DOM_SIMPLE     (8U)
+
+/**
+ * @brief Tree node, one per CBOR item
+ */
+typedef struct nanocbor_dom_node {
+    union {
+        uint64_t num;           /**< Unsigned integer, the argument of a
+                                  *  negative integer (-1 - num), the tag
+                                  *  number or the simple value */
+        double fp;              /**< Floating point number */
+        const uint8_t *str;     /**< Byte or text string */
+    } v;                        /**< Value of the node */
+    size_t len;                 /**< Length of a string, number of children
+                                  *  of a container, twice the number of
+                                  *  pairs for a map, 1 for a tag */
+    uint32_t child;             /**< First child of a container or tag */
+    uint8_t type;               /**< Node type */
+} nanocbor_dom_node_t;
+
+/**
+ * @brief Document tree context
+ */
+typedef struct nanocbor_dom {
+    nanocbor_dom_node_t *nodes; /**< Nodes */
+    size_t size;                /**< Number of nodes available */
+    size_t used;                /**< Number of nodes used */
+} nanocbor_dom_t;
+
+/**
+ * @brief Initialize a tree with an array of nodes
+ *
+ * @param[out]  dom     tree context
+ * @param[in]   nodes   array of nodes
+ * @param[in]   size    number of nodes in the array
+ */
+void nanocbor_dom_init(nanocbor_dom_t *dom, nanocbor_dom_node_t *nodes,
+                       size_t size);
+
+/**
+ * @brief Decode the next item into the tree
+ *
+ * Multiple items can be added to the same tree. On success, @p it is
+ * advanced past the item.
+ *
+ * @param[in]   dom     tree context
+ * @param[in]   it      CBOR value to decode
+ * @param[out]  root    node index of the item
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              NANOCBOR_ERR_OVERFLOW when the nodes are exhausted
+ * @return              NANOCBOR_ERR_RECURSION when the item is nested
+ *                      deeper than @ref NANOCBOR_RECURSION_MAX
+ * @return              NANOCBOR_ERR_INVALID_TYPE when an indefinite length
+ *                      map ends without the value of its last key
+ * @return              negative on decode error
+ */
+int nanocbor_dom_build(nanocbor_dom_t *dom, nanocbor_value_t *it,
+                       size_t *root);
+
+/**
+ * @brief Retrieve child @p n of a container or tag node
+ *
+ * @param[in]   dom     tree context
+ * @param[in]   node    container or tag node
+ * @param[in]   n       child number, for maps the key of pair n is child
+ *                      2n, the value 2n + 1
+ *
+ * @return              child node, NULL when there is no child @p n
+ */
+static inline const nanocbor_dom_node_t *
+nanocbor_dom_child(const nanocbor_dom_t *dom, const nanocbor_dom_node_t *node,
+                   size_t n)
+{
+    bool parent = node->type == NANOCBOR_TYPE_ARR ||
+                  node->type == NANOCBOR_TYPE_MAP ||
+                  node->type == NANOCBOR_TYPE_TAG;
+    return (parent && n < node->len) ? &dom->nodes[node->child + n] : NULL;
+}
+
+/**
+ * @brief Retrieve the value for a text string key of a map node
+ *
+ * @param[in]   dom     tree context
+ * @param[in]   map     map node
+ * @param[in]   key     null terminated key
+ *
+ * @return              value node of the first matching key, NULL when not
+ *                      found
+ */
+const nanocbor_dom_node_t *nanocbor_dom_map_get_tstr(const nanocbor_dom_t *dom,
+                                                     const nanocbor_dom_node_t *map,
+                                                     const char *key);
+
+/**
+ * @brief Retrieve the value for an integer key of a map node
+ *
+ * @param[in]   dom     tree context
+ * @param[in]   map     map node
+ * @param[in]   key     integer key
+ *
+ * @return              value node of the first matching key, NULL when not
+ *                      found
+ */
+const nanocbor_dom_node_t *nanocbor_dom_map_get_int(const nanocbor_dom_t *dom,
+                                                    const nanocbor_dom_node_t *map,
+                                                    int64_t key);
+
+/**
+ * @brief Encode a node and its children
+ *
+ * @param[in]   dom     tree context
+ * @param[in]   node    node index
+ * @param[in]   enc     encoder context
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              negative on encode error
+ */
+int nanocbor_dom_encode(const nanocbor_dom_t *dom, size_t node,
+                        nanocbor_encoder_t *enc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NANOCBOR_DOM_H */
+/** @} */
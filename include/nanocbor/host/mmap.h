@@ -0,0 +1,74 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @defgroup    nanocbor_mmap NanoCBOR memory mapped files
+ * @ingroup     nanocbor_sequence
+ * @brief       Map CBOR files into memory for decoding without copies
+ *
+ * Host only, requires POSIX `mmap()`. Built when `NANOCBOR_HOST=1` is passed
+ * to make.
+ *
+ * ```C
+ * nanocbor_mmap_t file;
+ * if (nanocbor_mmap_open(&file, "records.cbor") == NANOCBOR_OK) {
+ *     nanocbor_value_t seq;
+ *     nanocbor_decoder_init(&seq, file.buf, file.len);
+ *     ...
+ *     nanocbor_mmap_close(&file);
+ * }
+ * ```
+ *
+ * @{
+ *
+ * @file
+ */
+
+#ifndef NANOCBOR_HOST_MMAP_H
+#define NANOCBOR_HOST_MMAP_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Memory mapped file
+ */
+typedef struct nanocbor_mmap {
+    const uint8_t *buf; /**< Content of the file */
+    size_t len;         /**< Length of the file */
+    int error;          /**< errno value of a failed open, 0 otherwise */
+} nanocbor_mmap_t;
+
+/**
+ * @brief Map a file read-only into memory
+ *
+ * The mapping is advised for sequential access. An empty file results in a
+ * NULL @p buf with zero @p len.
+ *
+ * @param[out]  map     memory mapped file
+ * @param[in]   path    path of the file to map
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              NANOCBOR_ERR_SYSTEM on failure, the errno value is
+ *                      stored in the @p error member of @p map
+ */
+int nanocbor_mmap_open(nanocbor_mmap_t *map, const char *path);
+
+/**
+ * @brief Unmap a file mapped with @ref nanocbor_mmap_open
+ *
+ * @param[in]   map     memory mapped file
+ */
+void nanocbor_mmap_close(nanocbor_mmap_t *map);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NANOCBOR_HOST_MMAP_H */
+/** @} */
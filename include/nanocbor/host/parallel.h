@@ -0,0 +1,103 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @defgroup    nanocbor_parallel NanoCBOR parallel sequence processing
+ * @ingroup     nanocbor_sequence
+ * @brief       Validate or process the records of a CBOR sequence in
+ *              multiple threads
+ *
+ * Host only, requires POSIX threads. Built when `NANOCBOR_HOST=1` is passed
+ * to make.
+ *
+ * The sequence is split in slices with @ref nanocbor_sequence_split, a pool
+ * of threads then validates every record of a slice with @ref nanocbor_skip
+ * and passes it to an optional callback. Every record gets its own decoder
+ * value limited to the record. The result is the same as processing the
+ * sequence serially: the first failing record in sequence order is
+ * reported, no matter which thread found it.
+ *
+ * Finding the slice boundaries is a serial walk over the headers of the
+ * records, string payloads are jumped over. What runs in parallel is the
+ * rest of the work: the callback and, with @ref NANOCBOR_VALIDATE_UTF8 set,
+ * validating text strings. Without either, validation is no more than the
+ * header walk, the sequence is then validated in a single pass by the
+ * calling thread.
+ *
+ * @{
+ *
+ * @file
+ */
+
+#ifndef NANOCBOR_HOST_PARALLEL_H
+#define NANOCBOR_HOST_PARALLEL_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "nanocbor/nanocbor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of slices per thread, more slices balance the load better
+ */
+#ifndef NANOCBOR_PARALLEL_SLICES_PER_THREAD
+#define NANOCBOR_PARALLEL_SLICES_PER_THREAD     (4U)
+#endif
+
+/**
+ * @brief Record callback, called concurrently from multiple threads
+ *
+ * @param[in]   ctx     context pointer passed to
+ *                      @ref nanocbor_parallel_process
+ * @param[in]   record  decoder value containing only the record
+ * @param[in]   offset  offset of the record in the sequence
+ *
+ * @return              NANOCBOR_OK to continue
+ * @return              negative to stop with an error
+ */
+typedef int (*nanocbor_parallel_cb_t)(void *ctx, nanocbor_value_t *record,
+                                      size_t offset);
+
+/**
+ * @brief Result of processing a sequence
+ */
+typedef struct nanocbor_parallel_result {
+    size_t records;     /**< Number of records before the first failure */
+    size_t offset;      /**< Offset of the first failing record, or the
+                          *  length of the sequence */
+    int res;            /**< NANOCBOR_OK or the error of the first failing
+                          *  record */
+} nanocbor_parallel_result_t;
+
+/**
+ * @brief Validate and process every record of a CBOR sequence in parallel
+ *
+ * The calling thread takes part in the processing. When fewer threads can
+ * be started than requested, the remaining threads do the work. Without
+ * @p cb and without @ref NANOCBOR_VALIDATE_UTF8, @p threads is ignored.
+ *
+ * @param[in]   buf     CBOR sequence
+ * @param[in]   len     length of @p buf
+ * @param[in]   threads number of threads, 0 for one per online CPU
+ * @param[in]   cb      record callback, NULL to only validate
+ * @param[in]   ctx     context pointer passed to @p cb
+ * @param[out]  result  result of the processing
+ *
+ * @return              NANOCBOR_OK when every record is processed
+ * @return              negative error of the first failing record
+ */
+int nanocbor_parallel_process(const uint8_t *buf, size_t len, unsigned threads,
+                              nanocbor_parallel_cb_t cb, void *ctx,
+                              nanocbor_parallel_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NANOCBOR_HOST_PARALLEL_H */
+/** @} */
@@ -0,0 +1,175 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @defgroup    nanocbor_pool NanoCBOR encoder buffer pool
+ * @brief       Lock-free pool of encoder output buffers shared by threads
+ *
+ * Host only, requires POSIX threads and the GCC `__atomic` builtins. Built
+ * when `NANOCBOR_HOST=1` is passed to make.
+ *
+ * Buffers come in power of two size classes, starting at
+ * @ref NANOCBOR_POOL_MIN_SIZE. Every thread keeps a small cache of returned
+ * buffers per class, buffers beyond the cache go to a shared lock-free
+ * free list. A buffer can be returned by a different thread than the one
+ * that took it. Once the pool is warm, taking and returning buffers doesn't
+ * allocate.
+ *
+ * An encoder initialized with @ref nanocbor_pool_encoder_init moves to a
+ * larger buffer from the pool when it runs out of space:
+ *
+ * ```C
+ * nanocbor_encoder_t enc;
+ * nanocbor_pool_buf_t out;
+ * if (nanocbor_pool_encoder_init(&enc, &out, pool, 256) == NANOCBOR_OK) {
+ *     encode_message(&enc);
+ *     send(sock, out.buf, nanocbor_encoded_len(&enc), 0);
+ *     nanocbor_pool_put(pool, out.buf);
+ * }
+ * ```
+ *
+ * @{
+ *
+ * @file
+ */
+
+#ifndef NANOCBOR_HOST_POOL_H
+#define NANOCBOR_HOST_POOL_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "nanocbor/nanocbor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Size of the smallest buffer class, must be a power of two
+ */
+#ifndef NANOCBOR_POOL_MIN_SIZE
+#define NANOCBOR_POOL_MIN_SIZE      (64U)
+#endif
+
+/**
+ * @brief Number of size classes, each class doubles the buffer size
+ *
+ * Larger requests are served by `malloc()` and freed when returned.
+ */
+#ifndef NANOCBOR_POOL_CLASSES
+#define NANOCBOR_POOL_CLASSES       (16U)
+#endif
+
+/**
+ * @brief Number of buffers per size class kept in the cache of a thread
+ */
+#ifndef NANOCBOR_POOL_CACHE_SIZE
+#define NANOCBOR_POOL_CACHE_SIZE    (8U)
+#endif
+
+/**
+ * @brief Buffer pool, opaque
+ */
+typedef struct nanocbor_pool nanocbor_pool_t;
+
+/**
+ * @brief Pool buffer used by an encoder, see @ref nanocbor_pool_encoder_init
+ */
+typedef struct nanocbor_pool_buf {
+    nanocbor_pool_t *pool;  /**< Pool the buffer is taken from */
+    uint8_t *buf;           /**< Start of the encoded data */
+    size_t size;            /**< Capacity of @p buf */
+} nanocbor_pool_buf_t;
+
+/**
+ * @brief Create a buffer pool
+ *
+ * @param[in]   buffers maximum number of buffers owned by the pool, further
+ *                      buffers are allocated and freed on every use
+ *
+ * @return              the pool, NULL when out of memory
+ */
+nanocbor_pool_t *nanocbor_pool_create(size_t buffers);
+
+/**
+ * @brief Free a pool and all buffers owned by it
+ *
+ * Must not be called while other threads use the pool, all buffers must
+ * have been returned. Threads that used
+ * the pool and are still running should call @ref nanocbor_pool_flush first,
+ * their cache bookkeeping is leaked otherwise.
+ *
+ * @param[in]   pool    pool to destroy
+ */
+void nanocbor_pool_destroy(nanocbor_pool_t *pool);
+
+/**
+ * @brief Take a buffer of at least @p size bytes from the pool
+ *
+ * @param[in]   pool    pool to take the buffer from
+ * @param[in]   size    minimum size of the buffer
+ *
+ * @return              the buffer, NULL when out of memory
+ */
+uint8_t *nanocbor_pool_get(nanocbor_pool_t *pool, size_t size);
+
+/**
+ * @brief Return a buffer to the pool
+ *
+ * @param[in]   pool    pool the buffer was taken from
+ * @param[in]   buf     buffer to return, NULL is ignored
+ */
+void nanocbor_pool_put(nanocbor_pool_t *pool, uint8_t *buf);
+
+/**
+ * @brief Usable size of a buffer taken from a pool
+ *
+ * @param[in]   buf     buffer returned by @ref nanocbor_pool_get
+ *
+ * @return              size of the buffer, at least the requested size
+ */
+size_t nanocbor_pool_capacity(const uint8_t *buf);
+
+/**
+ * @brief Move the buffers cached by the calling thread to the shared free
+ *        list
+ *
+ * Called automatically when a thread exits.
+ *
+ * @param[in]   pool    pool to flush the cache of
+ */
+void nanocbor_pool_flush(nanocbor_pool_t *pool);
+
+/**
+ * @brief Initialize an encoder with a buffer from the pool
+ *
+ * When the buffer is full, the encoder moves the data to a buffer with at
+ * least double the size and returns the old buffer to the pool. @p out
+ * always describes the current buffer, the encoded data starts at
+ * `out->buf`. Return `out->buf` to the pool with @ref nanocbor_pool_put when
+ * done, also when encoding failed.
+ *
+ * Checkpoints and deferred length containers don't survive a move to a
+ * larger buffer, size @p hint to the expected message size when using them.
+ *
+ * @param[out]  enc     encoder context to initialize
+ * @param[out]  out     buffer of the encoder, must stay valid while encoding
+ * @param[in]   pool    pool to take buffers from
+ * @param[in]   hint    initial buffer size
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              NANOCBOR_ERR_END when no buffer could be allocated,
+ *                      as when growing the buffer fails
+ */
+int nanocbor_pool_encoder_init(nanocbor_encoder_t *enc,
+                               nanocbor_pool_buf_t *out,
+                               nanocbor_pool_t *pool, size_t hint);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NANOCBOR_HOST_POOL_H */
+/** @} */
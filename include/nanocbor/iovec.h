@@ -0,0 +1,132 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @defgroup    nanocbor_iovec NanoCBOR scatter-gather encoder
+ * @brief       Encode large strings by reference instead of by copy
+ *
+ * The scatter-gather encoder wraps a regular encoder. Headers and small
+ * items are written into the encoder buffer as usual. The bodies of large
+ * byte and text strings are not copied: the encoder records a reference to
+ * the caller-owned payload in a list of I/O vectors. The finished message is
+ * the concatenation of all vectors and can be sent with `writev()`,
+ * `sendmsg()` or a DMA descriptor chain without copying the payloads.
+ *
+ * ```C
+ * nanocbor_iovec_encoder_t ienc;
+ * nanocbor_iovec_t iov[8];
+ *
+ * nanocbor_iovec_encoder_init(&ienc, buf, sizeof(buf), iov, 8, 256);
+ * nanocbor_fmt_array(&ienc.enc, 2);
+ * nanocbor_fmt_uint(&ienc.enc, 1);
+ * nanocbor_iovec_put_bstr(&ienc, frame, frame_len);
+ * int num = nanocbor_iovec_finish(&ienc);
+ * ```
+ *
+ * Payloads referenced must stay valid until the message is sent.
+ *
+ * @{
+ *
+ * @file
+ */
+
+#ifndef NANOCBOR_IOVEC_H
+#define NANOCBOR_IOVEC_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "nanocbor/nanocbor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief I/O vector, laid out like the POSIX
+ *        `struct iovec`
+ */
+typedef struct nanocbor_iovec {
+    const void *base;   /**< Start of the segment */
+    size_t len;         /**< Length of the segment */
+} nanocbor_iovec_t;
+
+/**
+ * @brief Scatter-gather encoder context
+ */
+typedef struct nanocbor_iovec_encoder {
+    nanocbor_encoder_t enc; /**< Encoder for the headers and small items */
+    nanocbor_iovec_t *iov;  /**< I/O vectors of the message */
+    size_t iov_max;         /**< Number of vectors in the array */
+    size_t iov_num;         /**< Number of vectors used */
+    const uint8_t *seg;     /**< Start of the segment not yet recorded */
+    size_t threshold;       /**< Strings of at least this length are
+                              *  referenced instead of copied */
+} nanocbor_iovec_encoder_t;
+
+/**
+ * @brief Initialize a scatter-gather encoder
+ *
+ * Regular items are written with the encoder functions on the `enc` member
+ * of the context, for example `nanocbor_fmt_uint(&ienc.enc, 42)`.
+ *
+ * @param[out]  ienc        scatter-gather encoder context
+ * @param[in]   buf         buffer for the headers and small items
+ * @param[in]   len         length of @p buf
+ * @param[in]   iov         array of I/O vectors to fill
+ * @param[in]   iov_max     number of vectors in @p iov
+ * @param[in]   threshold   minimum length of a string body to reference
+ */
+void nanocbor_iovec_encoder_init(nanocbor_iovec_encoder_t *ienc,
+                                 uint8_t *buf, size_t len,
+                                 nanocbor_iovec_t *iov, size_t iov_max,
+                                 size_t threshold);
+
+/**
+ * @brief Write a byte string, referencing the body when it is large
+ *
+ * @param[in]   ienc    scatter-gather encoder context
+ * @param[in]   str     byte string to encode
+ * @param[in]   len     length of @p str
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              NANOCBOR_ERR_END when the buffer or the I/O vectors
+ *                      are exhausted
+ */
+int nanocbor_iovec_put_bstr(nanocbor_iovec_encoder_t *ienc,
+                            const uint8_t *str, size_t len);
+
+/**
+ * @brief Write a text string, referencing the body when it is large
+ *
+ * @param[in]   ienc    scatter-gather encoder context
+ * @param[in]   str     text string to encode
+ * @param[in]   len     length of @p str
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              NANOCBOR_ERR_END when the buffer or the I/O vectors
+ *                      are exhausted
+ */
+int nanocbor_iovec_put_tstr(nanocbor_iovec_encoder_t *ienc,
+                            const char *str, size_t len);
+
+/**
+ * @brief Finish the message and record the last segment
+ *
+ * The total length of the message is available with
+ * @ref nanocbor_encoded_len on the `enc` member.
+ *
+ * @param[in]   ienc    scatter-gather encoder context
+ *
+ * @return              number of I/O vectors of the message
+ * @return              NANOCBOR_ERR_END when the I/O vectors are exhausted
+ */
+int nanocbor_iovec_finish(nanocbor_iovec_encoder_t *ienc);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NANOCBOR_IOVEC_H */
+/** @} */
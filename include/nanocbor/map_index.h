@@ -0,0 +1,125 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @defgroup    nanocbor_map_index NanoCBOR map key index
+ * @brief       Index of map keys for repeated lookups
+ *
+ * Searching a map with @ref nanocbor_get_key_tstr walks the map from the
+ * start for every key. The map index walks the map once and stores the
+ * position of every value in a caller supplied hash table, keyed by text
+ * string or integer key. Every lookup afterwards is a hash table probe.
+ *
+ * Keys of other types are skipped and can't be looked up. When a key occurs
+ * multiple times, the first occurrence is used.
+ *
+ * @{
+ *
+ * @file
+ */
+
+#ifndef NANOCBOR_MAP_INDEX_H
+#define NANOCBOR_MAP_INDEX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "nanocbor/nanocbor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Map index entry
+ */
+typedef struct nanocbor_map_index_entry {
+    nanocbor_value_t value; /**< Decoder value positioned at the map value */
+    const uint8_t *str;     /**< Text string key, NULL for integer keys */
+    size_t str_len;         /**< Length of the text string key */
+    int64_t num;            /**< Integer key */
+    uint32_t hash;          /**< Hash of the key */
+    bool used;              /**< Entry contains a key */
+} nanocbor_map_index_entry_t;
+
+/**
+ * @brief Map index context
+ */
+typedef struct nanocbor_map_index {
+    nanocbor_map_index_entry_t *entries; /**< Hash table entries */
+    size_t size;            /**< Number of entries in the table */
+    size_t used;            /**< Number of keys stored in the table */
+} nanocbor_map_index_t;
+
+/**
+ * @brief Initialize a map index with a table of entries
+ *
+ * The table must have at least one entry for every key in the map to index.
+ * Lookups become slow when the table is almost full, a table with twice the
+ * number of entries is recommended.
+ *
+ * @param[out]  index   map index context
+ * @param[in]   entries table of entries
+ * @param[in]   size    number of entries in the table
+ */
+void nanocbor_map_index_init(nanocbor_map_index_t *index,
+                             nanocbor_map_index_entry_t *entries, size_t size);
+
+/**
+ * @brief Index all text string and integer keys of a map
+ *
+ * @pre @p map is inside a map, see @ref nanocbor_enter_map
+ *
+ * @p map itself is not advanced.
+ *
+ * @param[in]   index   map index context
+ * @param[in]   map     map to index
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              NANOCBOR_ERR_OVERFLOW when the table is full
+ * @return              NANOCBOR_ERR_END when the map is truncated
+ * @return              negative on decode error
+ */
+int nanocbor_map_index_build(nanocbor_map_index_t *index,
+                             const nanocbor_value_t *map);
+
+/**
+ * @brief Look up a text string key in the index
+ *
+ * The resulting @p value is undefined if @p key was not found.
+ *
+ * @param[in]   index   map index context
+ * @param[in]   key     null terminated text string key
+ * @param[out]  value   decoder value positioned at the value belonging to
+ *                      @p key
+ *
+ * @return              NANOCBOR_OK if @p key was found
+ * @return              NANOCBOR_NOT_FOUND otherwise
+ */
+int nanocbor_map_index_get_tstr(const nanocbor_map_index_t *index,
+                                const char *key, nanocbor_value_t *value);
+
+/**
+ * @brief Look up an integer key in the index
+ *
+ * The resulting @p value is undefined if @p key was not found.
+ *
+ * @param[in]   index   map index context
+ * @param[in]   key     integer key
+ * @param[out]  value   decoder value positioned at the value belonging to
+ *                      @p key
+ *
+ * @return              NANOCBOR_OK if @p key was found
+ * @return              NANOCBOR_NOT_FOUND otherwise
+ */
+int nanocbor_map_index_get_int(const nanocbor_map_index_t *index,
+                               int64_t key, nanocbor_value_t *value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NANOCBOR_MAP_INDEX_H */
+/** @} */
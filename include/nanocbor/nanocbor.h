@@ -13,6 +13,7 @@
  *  - All major types
  *  - Arrays including indefinite length arrays
  *  - Maps including indefinite length maps
+ *  - Indefinite length byte and text strings
  *  - Safe for decoding untrusted input
  *
  * Not included:
@@ -34,6 +35,8 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#include "nanocbor/config.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -137,6 +140,18 @@ typedef enum {
      * @brief Decoder could not find the requested entry
      */
     NANOCBOR_NOT_FOUND = -5,
+
+    /**
+     * @brief Text string is not valid UTF-8, see
+     *        @ref NANOCBOR_VALIDATE_UTF8
+     */
+    NANOCBOR_ERR_INVALID_UTF8 = -6,
+
+    /**
+     * @brief Host system call failed, the host function reports the errno
+     *        value separately
+     */
+    NANOCBOR_ERR_SYSTEM = -7,
 } nanocbor_error_t;
 
 
@@ -150,15 +165,73 @@ typedef struct nanocbor_value {
     uint8_t flags;        /**< Flags for decoding hints                   */
 } nanocbor_value_t;
 
+/**
+ * @brief encoder context forward declaration
+ */
+typedef struct nanocbor_encoder nanocbor_encoder_t;
+
+/**
+ * @brief Encoder sink callback, called when the encoder buffer is too small
+ *
+ * The callback must make at least @p len bytes available between `enc->cur`
+ * and `enc->end`. This can be done by moving the buffer to a larger
+ * allocation (the bytes already written must be preserved and `cur` and
+ * `end` updated), or by consuming the bytes written so far, for example by
+ * transmitting them, and rewinding `cur` to the start of the buffer.
+ *
+ * @param[in]   enc     Encoder context
+ * @param[in]   ctx     Context pointer supplied at initialization
+ * @param[in]   len     Number of bytes required at `enc->cur`
+ *
+ * @return              NANOCBOR_OK when @p len bytes are available
+ * @return              Negative on error
+ */
+typedef int (*nanocbor_encoder_sink_t)(nanocbor_encoder_t *enc, void *ctx,
+                                       size_t len);
+
 /**
  * @brief encoder context
  */
-typedef struct nanocbor_encoder {
+struct nanocbor_encoder {
     uint8_t *cur;   /**< Current position in the buffer */
     uint8_t *end;   /**< end of the buffer                      */
     size_t len;     /**< Length in bytes of supplied cbor data. Incremented
                       *  separate from the buffer check  */
-} nanocbor_encoder_t;
+    nanocbor_encoder_sink_t sink;   /**< Called when the buffer is full,
+                                      *  NULL when not used */
+    void *ctx;      /**< Context pointer passed to the sink */
+    struct nanocbor_deferred *deferred; /**< Innermost open deferred length
+                                          *  container, NULL when none */
+};
+
+/**
+ * @brief Saved encoder position, see @ref nanocbor_encoder_save
+ */
+typedef struct nanocbor_encoder_checkpoint {
+    uint8_t *cur;   /**< Saved buffer position */
+    size_t len;     /**< Saved encoded length */
+} nanocbor_encoder_checkpoint_t;
+
+/**
+ * @brief Header space reserved for a deferred length container, fits a 32
+ *        bit count
+ */
+#define NANOCBOR_DEFERRED_HDR_LEN   (1U + sizeof(uint32_t))
+
+/**
+ * @brief Deferred length container, see @ref nanocbor_fmt_array_begin
+ */
+typedef struct nanocbor_deferred {
+    uint8_t *hdr;   /**< Reserved header in the encoder buffer */
+    size_t len;     /**< Encoded length at the start of the container */
+    uint8_t type;   /**< Major type of the container */
+    struct nanocbor_deferred *parent; /**< Enclosing deferred container */
+    const uint8_t *scan;    /**< Content up to here is counted */
+    uint64_t need;          /**< Items missing to complete the last item */
+    uint64_t payload;       /**< String bytes to pass before the next header */
+    size_t indefinite;      /**< Depth of open indefinite length items */
+    uint32_t items;         /**< Number of items counted */
+} nanocbor_deferred_t;
 
 /**
  * @name decoder flags
@@ -194,6 +267,47 @@ typedef struct nanocbor_encoder {
 void nanocbor_decoder_init(nanocbor_value_t *value,
                            const uint8_t *buf, size_t len);
 
+/**
+ * @brief Continue decoding from a new buffer
+ *
+ * This allows decoding CBOR data that arrives in chunks, such as block-wise
+ * CoAP transfers, with a bounded buffer. When a decode call fails with
+ * NANOCBOR_ERR_END and @ref nanocbor_needs_input returns true, the
+ * unconsumed bytes (starting at `value->cur`, see
+ * @ref nanocbor_decoder_pending) must be moved to the start of a buffer and
+ * the next chunk appended. Decoding then continues with the same @p value
+ * after calling this function. Decode calls don't advance the context on
+ * error, so the failed call can simply be repeated.
+ *
+ * The container state of @p value is retained. Only the innermost
+ * container value has to be resumed, the parent values are updated by
+ * @ref nanocbor_leave_container.
+ *
+ * A single CBOR item, such as a byte string, must fit completely in the
+ * buffer to be decoded.
+ *
+ * @param[in]   value   decoder value context
+ * @param[in]   buf     Buffer to continue decoding from
+ * @param[in]   len     Length in bytes of the buffer
+ */
+void nanocbor_decoder_resume(nanocbor_value_t *value,
+                             const uint8_t *buf, size_t len);
+
+/**
+ * @brief Check if more input is expected for the current container
+ *
+ * Use this to distinguish a truncated buffer from the end of a container
+ * when a decode call returns NANOCBOR_ERR_END or @ref nanocbor_at_end returns
+ * true. Outside of a container this always returns true, as the number of
+ * items is not known.
+ *
+ * @param[in]   it      decoder value context
+ *
+ * @return              true if the container expects more items
+ * @return              false if the container is complete
+ */
+bool nanocbor_needs_input(const nanocbor_value_t *it);
+
 /**
  * @brief Retrieve the type of the CBOR value at the current position
  *
@@ -259,6 +373,19 @@ int nanocbor_get_uint16(nanocbor_value_t *cvalue, uint16_t *value);
  */
 int nanocbor_get_uint32(nanocbor_value_t *cvalue, uint32_t *value);
 
+/**
+ * @brief Retrieve a positive integer as uint64_t from the stream
+ *
+ * The resulting @p value is undefined if the result is an error condition
+ *
+ * @param[in]   cvalue  CBOR value to decode from
+ * @param[out]  value   returned positive integer
+ *
+ * @return              number of bytes read
+ * @return              negative on error
+ */
+int nanocbor_get_uint64(nanocbor_value_t *cvalue, uint64_t *value);
+
 /**
  * @brief Retrieve a signed integer as int8_t from the stream
  *
@@ -306,6 +433,23 @@ int nanocbor_get_int16(nanocbor_value_t *cvalue, int16_t *value);
  */
 int nanocbor_get_int32(nanocbor_value_t *cvalue, int32_t *value);
 
+/**
+ * @brief Retrieve a signed integer as int64_t from the stream
+ *
+ * If the value at `cvalue` is outside the int64_t range, error is returned.
+ * This is the case for positive and negative integers with a magnitude
+ * greater than 63 bit.
+ *
+ * The resulting @p value is undefined if the result is an error condition
+ *
+ * @param[in]   cvalue  CBOR value to decode from
+ * @param[out]  value   returned signed integer
+ *
+ * @return              number of bytes read
+ * @return              negative on error
+ */
+int nanocbor_get_int64(nanocbor_value_t *cvalue, int64_t *value);
+
 /**
  * @brief Retrieve a decimal fraction from the stream as a int32_t mantisa and
  *        int32_t exponent
@@ -323,11 +467,43 @@ int nanocbor_get_int32(nanocbor_value_t *cvalue, int32_t *value);
  */
 int nanocbor_get_decimal_frac(nanocbor_value_t *cvalue, int32_t *e, int32_t *m);
 
+/**
+ * @brief Retrieve a half or single precision floating point value from the
+ *        stream
+ *
+ * Half precision values are converted to single precision. If the value at
+ * `cvalue` is a double precision float, error is returned.
+ *
+ * The resulting @p value is undefined if the result is an error condition
+ *
+ * @param[in]   cvalue  CBOR value to decode from
+ * @param[out]  value   returned floating point value
+ *
+ * @return              number of bytes read
+ * @return              negative on error
+ */
+int nanocbor_get_float(nanocbor_value_t *cvalue, float *value);
+
+/**
+ * @brief Retrieve a half, single or double precision floating point value
+ *        from the stream
+ *
+ * The resulting @p value is undefined if the result is an error condition
+ *
+ * @param[in]   cvalue  CBOR value to decode from
+ * @param[out]  value   returned floating point value
+ *
+ * @return              number of bytes read
+ * @return              negative on error
+ */
+int nanocbor_get_double(nanocbor_value_t *cvalue, double *value);
+
 /**
  * @brief Retrieve a byte string from the stream
  *
  * The resulting @p buf and @p len are undefined if the result is an error
- * condition
+ * condition. Indefinite length byte strings are decoded with
+ * @ref nanocbor_enter_bstr.
  *
  * @param[in]   cvalue  CBOR value to decode from
  * @param[out]  buf     pointer to the byte string
@@ -342,17 +518,112 @@ int nanocbor_get_bstr(nanocbor_value_t *cvalue, const uint8_t **buf, size_t *len
  * @brief Retrieve a text string from the stream
  *
  * The resulting @p buf and @p len are undefined if the result is an error
- * condition
+ * condition. Indefinite length text strings are decoded with
+ * @ref nanocbor_enter_tstr.
  *
  * @param[in]   cvalue  CBOR value to decode from
  * @param[out]  buf     pointer to the text string
  * @param[out]  len     length of the text string
  *
  * @return              NANOCBOR_OK on success
+ * @return              NANOCBOR_ERR_INVALID_UTF8 when the string is not
+ *                      valid UTF-8 and @ref NANOCBOR_VALIDATE_UTF8 is set
  * @return              negative on error
  */
 int nanocbor_get_tstr(nanocbor_value_t *cvalue, const uint8_t **buf, size_t *len);
 
+/**
+ * @brief Enter the chunks of a byte string
+ *
+ * The chunks are retrieved without copying with @ref nanocbor_get_bstr until
+ * @ref nanocbor_at_end returns true on @p chunks, after which
+ * @ref nanocbor_leave_container advances @p it past the string. A definite
+ * length byte string is handled as a single chunk, so both forms can be
+ * decoded in the same way:
+ *
+ * ```C
+ * nanocbor_value_t chunks;
+ * if (nanocbor_enter_bstr(&it, &chunks) == NANOCBOR_OK) {
+ *     while (!nanocbor_at_end(&chunks)) {
+ *         if (nanocbor_get_bstr(&chunks, &buf, &len) < 0) {
+ *             break;
+ *         }
+ *         process(buf, len);
+ *     }
+ *     nanocbor_leave_container(&it, &chunks);
+ * }
+ * ```
+ *
+ * @param[in]   it      CBOR value to decode from
+ * @param[out]  chunks  CBOR value to decode the chunks with
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              negative on error
+ */
+int nanocbor_enter_bstr(const nanocbor_value_t *it, nanocbor_value_t *chunks);
+
+/**
+ * @brief Enter the chunks of a text string
+ *
+ * Text string variant of @ref nanocbor_enter_bstr, the chunks are retrieved
+ * with @ref nanocbor_get_tstr.
+ *
+ * @param[in]   it      CBOR value to decode from
+ * @param[out]  chunks  CBOR value to decode the chunks with
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              negative on error
+ */
+int nanocbor_enter_tstr(const nanocbor_value_t *it, nanocbor_value_t *chunks);
+
+/**
+ * @brief Copy a definite or indefinite length byte string into a buffer
+ *
+ * On success @p it is advanced past the string.
+ *
+ * @param[in]   it      CBOR value to decode from
+ * @param[out]  buf     buffer to copy the string into
+ * @param[in]   size    size of @p buf
+ * @param[out]  len     length of the string
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              NANOCBOR_ERR_OVERFLOW when the string doesn't fit
+ * @return              negative on error
+ */
+int nanocbor_gather_bstr(nanocbor_value_t *it, uint8_t *buf, size_t size,
+                         size_t *len);
+
+/**
+ * @brief Copy a definite or indefinite length text string into a buffer
+ *
+ * On success @p it is advanced past the string. The string is not
+ * terminated.
+ *
+ * @param[in]   it      CBOR value to decode from
+ * @param[out]  buf     buffer to copy the string into
+ * @param[in]   size    size of @p buf
+ * @param[out]  len     length of the string
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              NANOCBOR_ERR_OVERFLOW when the string doesn't fit
+ * @return              negative on error
+ */
+int nanocbor_gather_tstr(nanocbor_value_t *it, uint8_t *buf, size_t size,
+                         size_t *len);
+
+/**
+ * @brief Check whether a buffer is valid UTF-8
+ *
+ * Rejects overlong encodings, surrogates and code points above U+10FFFF as
+ * required for CBOR text strings.
+ *
+ * @param[in]   buf     buffer to check
+ * @param[in]   len     length of @p buf
+ *
+ * @return              true when @p buf is valid UTF-8
+ */
+bool nanocbor_utf8_valid(const uint8_t *buf, size_t len);
+
 /**
  * @brief Search for a tstr key in a map.
  *
@@ -370,6 +641,48 @@ int nanocbor_get_tstr(nanocbor_value_t *cvalue, const uint8_t **buf, size_t *len
 int nanocbor_get_key_tstr(nanocbor_value_t *start, const char *key,
                           nanocbor_value_t *value);
 
+/**
+ * @brief Search for an integer key in a map.
+ *
+ * Keys of other types are skipped. The resulting @p value is undefined if
+ * @p key was not found.
+ *
+ * @pre @p start is inside a map
+ *
+ * @param[in]   start   pointer to the map to search
+ * @param[in]   key     integer key
+ * @param[out]  value   pointer to the value belonging to @p key if found
+ *
+ * @return              NANOCBOR_OK if @p key was found
+ * @return              negative on error / not found
+ */
+int nanocbor_get_key_int(const nanocbor_value_t *start, int32_t key,
+                         nanocbor_value_t *value);
+
+/**
+ * @brief Search for multiple integer keys in a map in a single pass.
+ *
+ * The map is walked once, filling @p values for every key in @p keys that
+ * is found. The walk stops as soon as all keys are found. Keys of other
+ * types are skipped. When a key occurs multiple times, the first occurrence
+ * is used.
+ *
+ * The `cur` member of the values for keys that were not found is set to
+ * `NULL`.
+ *
+ * @pre @p start is inside a map
+ *
+ * @param[in]   start   pointer to the map to search
+ * @param[in]   keys    array of @p num integer keys
+ * @param[out]  values  array of @p num values, one for every key
+ * @param[in]   num     number of keys
+ *
+ * @return              number of keys found
+ * @return              negative on error
+ */
+int nanocbor_get_keys_int(const nanocbor_value_t *start, const int32_t *keys,
+                          nanocbor_value_t *values, size_t num);
+
 /**
  * @brief Enter a array type
  *
@@ -404,6 +717,63 @@ int nanocbor_enter_map(const nanocbor_value_t *it, nanocbor_value_t *map);
  */
 void nanocbor_leave_container(nanocbor_value_t *it, nanocbor_value_t *container);
 
+/**
+ * @brief Retrieve an array of unsigned integers into a buffer
+ *
+ * Enters the array at @p it and decodes up to @p max elements into @p out
+ * with a single pass over the encoded elements. On success @p it is
+ * advanced past the array. On failure @p it is not advanced and @p count
+ * holds the number of elements decoded before the failure.
+ *
+ * @param[in]   it      CBOR value to decode the array from
+ * @param[out]  out     buffer for the decoded elements
+ * @param[in]   max     number of elements @p out can hold
+ * @param[out]  count   number of elements decoded
+ *
+ * @return              NANOCBOR_OK when the complete array is decoded
+ * @return              NANOCBOR_ERR_OVERFLOW when the array has more than
+ *                      @p max elements or an element doesn't fit in uint32_t
+ * @return              negative on other decode errors
+ */
+int nanocbor_get_uint32_array(nanocbor_value_t *it, uint32_t *out, size_t max,
+                              size_t *count);
+
+/**
+ * @brief Retrieve an array of signed integers into a buffer
+ *
+ * See @ref nanocbor_get_uint32_array for the decoding behavior.
+ *
+ * @param[in]   it      CBOR value to decode the array from
+ * @param[out]  out     buffer for the decoded elements
+ * @param[in]   max     number of elements @p out can hold
+ * @param[out]  count   number of elements decoded
+ *
+ * @return              NANOCBOR_OK when the complete array is decoded
+ * @return              NANOCBOR_ERR_OVERFLOW when the array has more than
+ *                      @p max elements or an element doesn't fit in int32_t
+ * @return              negative on other decode errors
+ */
+int nanocbor_get_int32_array(nanocbor_value_t *it, int32_t *out, size_t max,
+                             size_t *count);
+
+/**
+ * @brief Retrieve an array of floats into a buffer
+ *
+ * See @ref nanocbor_get_uint32_array for the decoding behavior.
+ *
+ * @param[in]   it      CBOR value to decode the array from
+ * @param[out]  out     buffer for the decoded elements
+ * @param[in]   max     number of elements @p out can hold
+ * @param[out]  count   number of elements decoded
+ *
+ * @return              NANOCBOR_OK when the complete array is decoded
+ * @return              NANOCBOR_ERR_OVERFLOW when the array has more than
+ *                      @p max elements or an element doesn't fit in float
+ * @return              negative on other decode errors
+ */
+int nanocbor_get_float_array(nanocbor_value_t *it, float *out, size_t max,
+                             size_t *count);
+
 /**
  * @brief Retrieve a tag as positive uint32_t from the stream
  *
@@ -416,6 +786,18 @@ void nanocbor_leave_container(nanocbor_value_t *it, nanocbor_value_t *container)
  */
 int nanocbor_get_tag(nanocbor_value_t *cvalue, uint32_t *tag);
 
+/**
+ * @brief Skip all tags in front of the next value
+ *
+ * Tags of any size are skipped, the value itself is not consumed.
+ *
+ * @param[in]   cvalue  CBOR value to decode from
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              NANOCBOR_ERR_END when a tag is truncated
+ */
+int nanocbor_skip_tags(nanocbor_value_t *cvalue);
+
 /**
  * @brief Retrieve a null value from the stream
  *
@@ -443,9 +825,12 @@ int nanocbor_get_bool(nanocbor_value_t *cvalue, bool *value);
  * @brief Skip to the next value in the CBOR stream
  *
  * This function is able to skip over nested structures in the CBOR stream
- * such as (nested) arrays and maps. It uses limited recursion to do so.
+ * such as (nested) arrays and maps. It does so without recursion, keeping
+ * only the number of remaining items for every nesting level.
  *
- * Recursion is limited with @ref NANOCBOR_RECURSION_MAX
+ * The nesting depth is limited with @ref NANOCBOR_RECURSION_MAX. With
+ * @ref NANOCBOR_VALIDATE_UTF8 set, text strings are validated. On error,
+ * @p it is not advanced.
  *
  * @param[in]   it  CBOR stream to skip a value from
  *
@@ -454,6 +839,20 @@ int nanocbor_get_bool(nanocbor_value_t *cvalue, bool *value);
  */
 int nanocbor_skip(nanocbor_value_t *it);
 
+/**
+ * @brief Skip to the next value, only checking the structure of the value
+ *
+ * Same as @ref nanocbor_skip, except that text strings are not validated
+ * and no statistics are counted. Meant for finding item boundaries ahead of
+ * a full decode, a skipped value is not necessarily valid.
+ *
+ * @param[in]   it  CBOR stream to skip a value from
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              negative on error
+ */
+int nanocbor_skip_structure(nanocbor_value_t *it);
+
 /**
  * @brief Skip a single simple value in the CBOR stream
  *
@@ -519,6 +918,22 @@ static inline bool nanocbor_in_container(const nanocbor_value_t *container)
     return container->flags & (NANOCBOR_DECODER_FLAG_CONTAINER);
 }
 
+/**
+ * @brief Retrieve the number of bytes not yet consumed by the decoder
+ *
+ * These bytes have to be retained when resuming decoding with
+ * @ref nanocbor_decoder_resume.
+ *
+ * @param[in]   value   decoder value context
+ *
+ * @return              number of bytes from the current position to the end
+ *                      of the buffer
+ */
+static inline size_t nanocbor_decoder_pending(const nanocbor_value_t *value)
+{
+    return value->cur < value->end ? (size_t)(value->end - value->cur) : 0;
+}
+
 /** @} */
 
 /**
@@ -539,6 +954,27 @@ static inline bool nanocbor_in_container(const nanocbor_value_t *container)
 void nanocbor_encoder_init(nanocbor_encoder_t *enc,
                            uint8_t *buf, size_t len);
 
+/**
+ * @brief Initializes an encoder context with a buffer and a sink callback
+ *
+ * The encoder writes into @p buf until it is full. When an item doesn't fit
+ * in the remaining space, @p sink is called to provide more space. This
+ * allows encoding a CBOR structure of unknown size in a single pass, without
+ * first determining the required size with a `NULL` buffer.
+ *
+ * It is safe to pass `NULL` to @p buf with @p len is `0` and have the sink
+ * supply the initial buffer.
+ *
+ * @param[in]   enc     Encoder context
+ * @param[in]   buf     Buffer to write into
+ * @param[in]   len     length of the buffer
+ * @param[in]   sink    callback to call when the buffer is full
+ * @param[in]   ctx     context pointer passed to @p sink
+ */
+void nanocbor_encoder_sink_init(nanocbor_encoder_t *enc,
+                                uint8_t *buf, size_t len,
+                                nanocbor_encoder_sink_t sink, void *ctx);
+
 /**
  * @brief Retrieve the encoded length of the CBOR structure
  *
@@ -552,6 +988,61 @@ void nanocbor_encoder_init(nanocbor_encoder_t *enc,
  */
 size_t nanocbor_encoded_len(nanocbor_encoder_t *enc);
 
+/**
+ * @brief Retrieve the number of bytes left in the encoder buffer
+ *
+ * This doesn't include any space that the sink could still provide.
+ *
+ * @param[in]   enc     Encoder context
+ *
+ * @return              Number of bytes that can be written without
+ *                      overflowing the buffer
+ */
+size_t nanocbor_encoder_remaining(const nanocbor_encoder_t *enc);
+
+/**
+ * @brief Save the encoder position to roll back to
+ *
+ * Together with @ref nanocbor_encoder_restore this allows packing items
+ * into a fixed size buffer without a scratch copy: an item that fails to
+ * fit is removed again.
+ *
+ * ```C
+ * nanocbor_encoder_checkpoint_t cp;
+ * size_t num = 0;
+ * for (; num < count; num++) {
+ *     nanocbor_encoder_save(&enc, &cp);
+ *     if (encode_record(&enc, &records[num]) < 0) {
+ *         nanocbor_encoder_restore(&enc, &cp);
+ *         break;
+ *     }
+ * }
+ * ```
+ *
+ * A checkpoint is invalidated when the sink moves or rewinds the buffer.
+ * Checkpoints inside a deferred length container must be taken after
+ * @ref nanocbor_fmt_array_begin or @ref nanocbor_fmt_map_begin and must
+ * not be restored after the container is closed. Deferred containers
+ * started after the checkpoint are discarded on restore.
+ *
+ * @param[in]   enc     Encoder context
+ * @param[out]  cp      checkpoint to save the position in
+ */
+void nanocbor_encoder_save(const nanocbor_encoder_t *enc,
+                           nanocbor_encoder_checkpoint_t *cp);
+
+/**
+ * @brief Roll the encoder back to a saved position
+ *
+ * Everything written after @ref nanocbor_encoder_save is discarded and the
+ * encoded length is reset, including the length of items that didn't fit.
+ *
+ * @param[in]   enc     Encoder context
+ * @param[in]   cp      checkpoint saved with @ref nanocbor_encoder_save
+ */
+void nanocbor_encoder_restore(nanocbor_encoder_t *enc,
+                              const nanocbor_encoder_checkpoint_t *cp);
+
 /**
  * @brief Write a CBOR boolean value into a buffer
  *
@@ -628,6 +1119,35 @@ int nanocbor_fmt_bstr(nanocbor_encoder_t *enc, size_t len);
  */
 int nanocbor_fmt_tstr(nanocbor_encoder_t *enc, size_t len);
 
+/**
+ * @brief Write an indefinite-length byte string indicator
+ *
+ * The chunks are written with @ref nanocbor_put_bstr, or with
+ * @ref nanocbor_fmt_bstr followed by the chunk data, and terminated with
+ * @ref nanocbor_fmt_end_indefinite.
+ *
+ * @param[in]   enc     Encoder context
+ *
+ * @return              Number of bytes written
+ * @return              Negative on error
+ */
+int nanocbor_fmt_bstr_indefinite(nanocbor_encoder_t *enc);
+
+/**
+ * @brief Write an indefinite-length text string indicator
+ *
+ * The chunks are written with @ref nanocbor_put_tstrn, or with
+ * @ref nanocbor_fmt_tstr followed by the chunk data, and terminated with
+ * @ref nanocbor_fmt_end_indefinite. Every chunk must be valid UTF-8 on its
+ * own.
+ *
+ * @param[in]   enc     Encoder context
+ *
+ * @return              Number of bytes written
+ * @return              Negative on error
+ */
+int nanocbor_fmt_tstr_indefinite(nanocbor_encoder_t *enc);
+
 /**
  * @brief Copy a byte string with indicator into the encoder buffer
  *
@@ -663,6 +1183,18 @@ int nanocbor_put_tstr(nanocbor_encoder_t *enc, const char *str);
  */
 int nanocbor_put_tstrn(nanocbor_encoder_t *enc, const char *str, size_t len);
 
+/**
+ * @brief Copy already encoded CBOR into the encoder buffer
+ *
+ * @param[in]   enc     Encoder context
+ * @param[in]   buf     encoded CBOR to copy
+ * @param[in]   len     number of bytes to copy
+ *
+ * @return              NANOCBOR_OK if the bytes fit
+ * @return              Negative on error
+ */
+int nanocbor_put_raw(nanocbor_encoder_t *enc, const uint8_t *buf, size_t len);
+
 /**
  * @brief Write an array indicator with @p len items
  *
@@ -723,6 +1255,70 @@ int nanocbor_fmt_map_indefinite(nanocbor_encoder_t *enc);
  */
 int nanocbor_fmt_end_indefinite(nanocbor_encoder_t *enc);
 
+/**
+ * @brief Start an array of which the number of items is not yet known
+ *
+ * Reserves space for the array header. The items of the array are written
+ * with the regular functions and the array is closed with
+ * @ref nanocbor_fmt_container_end, which writes the smallest definite length
+ * header for the number of items written. Unlike
+ * @ref nanocbor_fmt_array_indefinite, the resulting CBOR is definite length.
+ *
+ * The whole container must stay in the encoder buffer until it is closed. An
+ * encoder without a buffer or with a sink that flushes or moves the buffer
+ * can't be used for deferred length containers.
+ *
+ * @param[in]   enc     Encoder context
+ * @param[out]  deferred deferred container context
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              Negative on error
+ */
+int nanocbor_fmt_array_begin(nanocbor_encoder_t *enc,
+                             nanocbor_deferred_t *deferred);
+
+/**
+ * @brief Start a map of which the number of items is not yet known
+ *
+ * See @ref nanocbor_fmt_array_begin
+ *
+ * @param[in]   enc     Encoder context
+ * @param[out]  deferred deferred container context
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              Negative on error
+ */
+int nanocbor_fmt_map_begin(nanocbor_encoder_t *enc,
+                           nanocbor_deferred_t *deferred);
+
+/**
+ * @brief Close a container started with @ref nanocbor_fmt_array_begin or
+ *        @ref nanocbor_fmt_map_begin
+ *
+ * Writes the header for the number of items written into the container. The
+ * content of the container is moved when the header is shorter than the
+ * reserved space. Containers nested inside must be closed first.
+ *
+ * Items are counted once, from the headers written since the last deferred
+ * container was started or closed. The content isn't decoded: strings are
+ * not validated and nesting depth is not limited. Bytes written with
+ * @ref nanocbor_put_raw must form complete headers, string content may be
+ * split over multiple calls.
+ *
+ * @param[in]   enc     Encoder context
+ * @param[in]   deferred deferred container context
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              NANOCBOR_ERR_END when the container did not fit in
+ *                      the buffer
+ * @return              NANOCBOR_ERR_END when the last item is incomplete
+ * @return              NANOCBOR_ERR_INVALID_TYPE when a map has a key
+ *                      without value, a nested container is still open or
+ *                      the content is not valid CBOR
+ */
+int nanocbor_fmt_container_end(nanocbor_encoder_t *enc,
+                               nanocbor_deferred_t *deferred);
+
 /**
  * @brief Write a Null value into the encoder buffer
  *
@@ -733,6 +1329,18 @@ int nanocbor_fmt_end_indefinite(nanocbor_encoder_t *enc);
  */
 int nanocbor_fmt_null(nanocbor_encoder_t *enc);
 
+/**
+ * @brief Write a simple value into the encoder buffer
+ *
+ * @param[in]   enc     Encoder context
+ * @param[in]   value   Simple value, values 24 to 31 are reserved
+ *
+ * @return              Number of bytes written
+ * @return              NANOCBOR_ERR_INVALID_TYPE for a reserved value
+ * @return              Negative on error
+ */
+int nanocbor_fmt_simple(nanocbor_encoder_t *enc, uint8_t value);
+
 /**
  * @brief Write a float value into the encoder buffer
  *
@@ -766,6 +1374,263 @@ int nanocbor_fmt_double(nanocbor_encoder_t *enc, double num);
  */
 int nanocbor_fmt_decimal_frac(nanocbor_encoder_t *enc, int32_t e, int32_t m);
 
+/**
+ * @brief Write an array of unsigned integers into the encoder buffer
+ *
+ * Writes the array header and all elements with a single space check, the
+ * output is identical to @ref nanocbor_fmt_array followed by
+ * @ref nanocbor_fmt_uint for every element. Nothing is written when the
+ * complete array doesn't fit.
+ *
+ * @param[in]   enc     Encoder context
+ * @param[in]   nums    Integers to encode
+ * @param[in]   num     Number of integers in @p nums
+ *
+ * @return              Number of bytes written
+ * @return              NANOCBOR_ERR_END when the array doesn't fit
+ * @return              NANOCBOR_ERR_OVERFLOW when @p num is too large
+ */
+int nanocbor_fmt_uint_array(nanocbor_encoder_t *enc, const uint32_t *nums,
+                            size_t num);
+
+/**
+ * @brief Write an array of signed integers into the encoder buffer
+ *
+ * Writes the array header and all elements with a single space check, the
+ * output is identical to @ref nanocbor_fmt_array followed by
+ * @ref nanocbor_fmt_int for every element. Nothing is written when the
+ * complete array doesn't fit.
+ *
+ * @param[in]   enc     Encoder context
+ * @param[in]   nums    Integers to encode
+ * @param[in]   num     Number of integers in @p nums
+ *
+ * @return              Number of bytes written
+ * @return              NANOCBOR_ERR_END when the array doesn't fit
+ * @return              NANOCBOR_ERR_OVERFLOW when @p num is too large
+ */
+int nanocbor_fmt_int_array(nanocbor_encoder_t *enc, const int32_t *nums,
+                           size_t num);
+
+/**
+ * @brief Write an array of floats into the encoder buffer
+ *
+ * Writes the array header and all elements with a single space check, the
+ * output is identical to @ref nanocbor_fmt_array followed by
+ * @ref nanocbor_fmt_float for every element. Nothing is written when the
+ * complete array doesn't fit.
+ *
+ * @param[in]   enc     Encoder context
+ * @param[in]   nums    Floating points to encode
+ * @param[in]   num     Number of floating points in @p nums
+ *
+ * @return              Number of bytes written
+ * @return              NANOCBOR_ERR_END when the array doesn't fit
+ * @return              NANOCBOR_ERR_OVERFLOW when @p num is too large
+ */
+int nanocbor_fmt_float_array(nanocbor_encoder_t *enc, const float *nums,
+                             size_t num);
+
+/** @} */
+
+/**
+ * @name NanoCBOR inline decoder fast paths
+ *
+ * With @ref NANOCBOR_INLINE enabled, the getters below are replaced by
+ * static inline versions. They decode items with an immediate argument
+ * directly and call the regular function for everything else, with the
+ * same results in all cases.
+ * @{
+ */
+#if NANOCBOR_INLINE
+
+/* An item is available, true unless at the end of the buffer or of a
+ * definite length container. Callers must reject the break marker. */
+static inline bool nanocbor_inline_has_item(const nanocbor_value_t *it)
+{
+    return it->cur < it->end &&
+           (!(it->flags & NANOCBOR_DECODER_FLAG_CONTAINER) ||
+            (it->flags & NANOCBOR_DECODER_FLAG_INDEFINITE) || it->remaining);
+}
+
+static inline bool nanocbor_inline_at_end(const nanocbor_value_t *it)
+{
+    return !nanocbor_inline_has_item(it) ||
+           (nanocbor_container_indefinite(it) &&
+            *it->cur == (NANOCBOR_MASK_FLOAT | NANOCBOR_VALUE_MASK));
+}
+
+static inline int nanocbor_inline_get_type(const nanocbor_value_t *value)
+{
+    if (nanocbor_inline_at_end(value)) {
+        return NANOCBOR_ERR_END;
+    }
+    return *value->cur >> NANOCBOR_TYPE_OFFSET;
+}
+
+/* Immediate unsigned integer, returns the value or -1 */
+static inline int nanocbor_inline_uint(const nanocbor_value_t *it)
+{
+    if (nanocbor_inline_has_item(it) && *it->cur < NANOCBOR_SIZE_BYTE) {
+        return *it->cur;
+    }
+    return -1;
+}
+
+/* Immediate signed integer, sets @p value and returns true if found */
+static inline bool nanocbor_inline_int(const nanocbor_value_t *it,
+                                       int8_t *value)
+{
+    if (nanocbor_inline_has_item(it)) {
+        uint8_t byte = *it->cur;
+        if (byte < NANOCBOR_SIZE_BYTE) {
+            *value = (int8_t)byte;
+            return true;
+        }
+        if (byte >= NANOCBOR_MASK_NINT &&
+            byte < (NANOCBOR_MASK_NINT | NANOCBOR_SIZE_BYTE)) {
+            *value = (int8_t)(-1 - (int)(byte & NANOCBOR_VALUE_MASK));
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline void nanocbor_inline_advance(nanocbor_value_t *it)
+{
+    it->cur++;
+    it->remaining--;
+}
+
+static inline int nanocbor_inline_get_uint8(nanocbor_value_t *cvalue,
+                                            uint8_t *value)
+{
+    int num = nanocbor_inline_uint(cvalue);
+
+    if (num < 0) {
+        return nanocbor_get_uint8(cvalue, value);
+    }
+    *value = (uint8_t)num;
+    nanocbor_inline_advance(cvalue);
+    return 1;
+}
+
+static inline int nanocbor_inline_get_uint16(nanocbor_value_t *cvalue,
+                                             uint16_t *value)
+{
+    int num = nanocbor_inline_uint(cvalue);
+
+    if (num < 0) {
+        return nanocbor_get_uint16(cvalue, value);
+    }
+    *value = (uint16_t)num;
+    nanocbor_inline_advance(cvalue);
+    return 1;
+}
+
+static inline int nanocbor_inline_get_uint32(nanocbor_value_t *cvalue,
+                                             uint32_t *value)
+{
+    int num = nanocbor_inline_uint(cvalue);
+
+    if (num < 0) {
+        return nanocbor_get_uint32(cvalue, value);
+    }
+    *value = (uint32_t)num;
+    nanocbor_inline_advance(cvalue);
+    return 1;
+}
+
+static inline int nanocbor_inline_get_uint64(nanocbor_value_t *cvalue,
+                                             uint64_t *value)
+{
+    int num = nanocbor_inline_uint(cvalue);
+
+    if (num < 0) {
+        return nanocbor_get_uint64(cvalue, value);
+    }
+    *value = (uint64_t)num;
+    nanocbor_inline_advance(cvalue);
+    return 1;
+}
+
+static inline int nanocbor_inline_get_int8(nanocbor_value_t *cvalue,
+                                           int8_t *value)
+{
+    int8_t num = 0;
+
+    if (!nanocbor_inline_int(cvalue, &num)) {
+        return nanocbor_get_int8(cvalue, value);
+    }
+    *value = num;
+    nanocbor_inline_advance(cvalue);
+    return 1;
+}
+
+static inline int nanocbor_inline_get_int16(nanocbor_value_t *cvalue,
+                                            int16_t *value)
+{
+    int8_t num = 0;
+
+    if (!nanocbor_inline_int(cvalue, &num)) {
+        return nanocbor_get_int16(cvalue, value);
+    }
+    *value = num;
+    nanocbor_inline_advance(cvalue);
+    return 1;
+}
+
+static inline int nanocbor_inline_get_int32(nanocbor_value_t *cvalue,
+                                            int32_t *value)
+{
+    int8_t num = 0;
+
+    if (!nanocbor_inline_int(cvalue, &num)) {
+        return nanocbor_get_int32(cvalue, value);
+    }
+    *value = num;
+    nanocbor_inline_advance(cvalue);
+    return 1;
+}
+
+static inline int nanocbor_inline_get_int64(nanocbor_value_t *cvalue,
+                                            int64_t *value)
+{
+    int8_t num = 0;
+
+    if (!nanocbor_inline_int(cvalue, &num)) {
+        return nanocbor_get_int64(cvalue, value);
+    }
+    *value = num;
+    nanocbor_inline_advance(cvalue);
+    return 1;
+}
+
+static inline int nanocbor_inline_get_bool(nanocbor_value_t *cvalue,
+                                           bool *value)
+{
+    if (cvalue->cur < cvalue->end &&
+        (*cvalue->cur | 1U) == (NANOCBOR_MASK_FLOAT | NANOCBOR_SIMPLE_TRUE)) {
+        *value = *cvalue->cur & 1U;
+        nanocbor_inline_advance(cvalue);
+        return NANOCBOR_OK;
+    }
+    return nanocbor_get_bool(cvalue, value);
+}
+
+#define nanocbor_at_end(it)             nanocbor_inline_at_end(it)
+#define nanocbor_get_type(value)        nanocbor_inline_get_type(value)
+#define nanocbor_get_uint8(it, value)   nanocbor_inline_get_uint8(it, value)
+#define nanocbor_get_uint16(it, value)  nanocbor_inline_get_uint16(it, value)
+#define nanocbor_get_uint32(it, value)  nanocbor_inline_get_uint32(it, value)
+#define nanocbor_get_uint64(it, value)  nanocbor_inline_get_uint64(it, value)
+#define nanocbor_get_int8(it, value)    nanocbor_inline_get_int8(it, value)
+#define nanocbor_get_int16(it, value)   nanocbor_inline_get_int16(it, value)
+#define nanocbor_get_int32(it, value)   nanocbor_inline_get_int32(it, value)
+#define nanocbor_get_int64(it, value)   nanocbor_inline_get_int64(it, value)
+#define nanocbor_get_bool(it, value)    nanocbor_inline_get_bool(it, value)
+
+#endif /* NANOCBOR_INLINE */
 /** @} */
 
 #ifdef __cplusplus
@@ -0,0 +1,127 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @defgroup    nanocbor_query NanoCBOR path queries
+ * @brief       Extract multiple fields from a document in a single pass
+ *
+ * Paths are compiled once into a trie of path segments. A query run walks
+ * the document once, descends only into the containers that are on one of
+ * the paths and skips everything else:
+ *
+ * ```C
+ * nanocbor_query_node_t nodes[8];
+ * nanocbor_query_t query;
+ * nanocbor_value_t results[2];
+ *
+ * nanocbor_query_init(&query, nodes, 8);
+ * int temp = nanocbor_query_add(&query, "/3/\"temp\"/0");
+ * int unit = nanocbor_query_add(&query, "/3/\"unit\"");
+ * nanocbor_query_run(&query, &doc, results);
+ * ```
+ *
+ * A path is a sequence of segments, each starting with a `/`. A segment is
+ * either a text string key in double quotes or an integer. An integer
+ * matches an integer key of a map or an index of an array. The path `/`
+ * matches the document itself. When a key occurs multiple times in a map,
+ * the first occurrence is used. Tags are skipped when descending.
+ *
+ * @{
+ *
+ * @file
+ */
+
+#ifndef NANOCBOR_QUERY_H
+#define NANOCBOR_QUERY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "nanocbor/nanocbor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Maximum number of distinct segments following a single segment
+ */
+#define NANOCBOR_QUERY_CHILDREN_MAX     (32U)
+
+/**
+ * @brief Path trie node, one per distinct path segment
+ */
+typedef struct nanocbor_query_node {
+    const char *str;    /**< Text string segment, NULL for an integer */
+    size_t str_len;     /**< Length of the text string segment */
+    int64_t num;        /**< Integer segment */
+    uint16_t child;     /**< First child node, 0 for none */
+    uint16_t sibling;   /**< Next sibling node, 0 for none */
+    uint16_t children;  /**< Number of child nodes */
+    int16_t result;     /**< Index of the path ending here, -1 for none */
+} nanocbor_query_node_t;
+
+/**
+ * @brief Compiled query
+ */
+typedef struct nanocbor_query {
+    nanocbor_query_node_t *nodes;   /**< Trie nodes, the first is the root */
+    size_t size;                    /**< Number of nodes available */
+    size_t used;                    /**< Number of nodes used */
+    size_t paths;                   /**< Number of paths added */
+} nanocbor_query_t;
+
+/**
+ * @brief Initialize a query with an array of trie nodes
+ *
+ * Every distinct path segment requires a node, plus one for the root.
+ *
+ * @param[out]  query   query context
+ * @param[in]   nodes   array of trie nodes, at least one
+ * @param[in]   size    number of nodes in the array, at most 65535
+ */
+void nanocbor_query_init(nanocbor_query_t *query, nanocbor_query_node_t *nodes,
+                         size_t size);
+
+/**
+ * @brief Add a path to the query
+ *
+ * Text string segments refer to @p path, it must stay valid while the
+ * query is used.
+ *
+ * @param[in]   query   query context
+ * @param[in]   path    null terminated path
+ *
+ * @return              index of the path in the results
+ * @return              NANOCBOR_ERR_INVALID_TYPE if @p path is malformed
+ * @return              NANOCBOR_ERR_OVERFLOW when the nodes are exhausted
+ * @return              NANOCBOR_ERR_RECURSION when @p path has more than
+ *                      @ref NANOCBOR_RECURSION_MAX segments
+ */
+int nanocbor_query_add(nanocbor_query_t *query, const char *path);
+
+/**
+ * @brief Resolve all paths of the query against a document
+ *
+ * @p doc itself is not advanced. Paths not found in the document have a
+ * result with a NULL `cur` member.
+ *
+ * @param[in]   query   query context
+ * @param[in]   doc     decoder value positioned at the document
+ * @param[out]  results decoder values positioned at the items found, one
+ *                      per path
+ *
+ * @return              number of paths found
+ * @return              negative on decode error
+ */
+int nanocbor_query_run(const nanocbor_query_t *query,
+                       const nanocbor_value_t *doc, nanocbor_value_t *results);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NANOCBOR_QUERY_H */
+/** @} */
@@ -0,0 +1,168 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @defgroup    nanocbor_schema NanoCBOR schema driven decoding
+ * @brief       Decode CBOR maps into C structs using a descriptor table
+ *
+ * Instead of a chain of getter calls for every member of a known structure,
+ * a constant table describes the map keys, their expected type and the
+ * location of the matching struct member. A single call decodes the whole
+ * map into the struct:
+ *
+ * ```C
+ * struct record { uint16_t id; int32_t temp; nanocbor_schema_str_t name; };
+ *
+ * static const nanocbor_schema_field_t fields[] = {
+ *     { .key = 1, .type = NANOCBOR_SCHEMA_UINT,
+ *       .flags = NANOCBOR_SCHEMA_REQUIRED,
+ *       NANOCBOR_SCHEMA_MEMBER(struct record, id) },
+ *     { .key = 2, .type = NANOCBOR_SCHEMA_INT,
+ *       NANOCBOR_SCHEMA_MEMBER(struct record, temp) },
+ *     { .name = "n", .type = NANOCBOR_SCHEMA_TSTR,
+ *       NANOCBOR_SCHEMA_MEMBER(struct record, name) },
+ * };
+ * static const nanocbor_schema_t schema = { fields, 3 };
+ * ```
+ *
+ * Map entries with unknown keys are skipped. When a key occurs multiple
+ * times, the first occurrence is used.
+ *
+ * @{
+ *
+ * @file
+ */
+
+#ifndef NANOCBOR_SCHEMA_H
+#define NANOCBOR_SCHEMA_H
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "nanocbor/nanocbor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Maximum number of fields in a single schema
+ */
+#define NANOCBOR_SCHEMA_FIELDS_MAX  (32U)
+
+/**
+ * @brief Schema field types
+ */
+typedef enum {
+    /**
+     * @brief Unsigned integer member of 1, 2, 4 or 8 bytes
+     */
+    NANOCBOR_SCHEMA_UINT,
+    /**
+     * @brief Signed integer member of 1, 2, 4 or 8 bytes
+     */
+    NANOCBOR_SCHEMA_INT,
+    /**
+     * @brief bool member
+     */
+    NANOCBOR_SCHEMA_BOOL,
+    /**
+     * @brief float or double member
+     */
+    NANOCBOR_SCHEMA_FLOAT,
+    /**
+     * @brief Byte string, @ref nanocbor_schema_str_t member
+     */
+    NANOCBOR_SCHEMA_BSTR,
+    /**
+     * @brief Text string, @ref nanocbor_schema_str_t member
+     */
+    NANOCBOR_SCHEMA_TSTR,
+    /**
+     * @brief Any CBOR item, @ref nanocbor_value_t member positioned at the
+     *        item for decoding by the caller
+     */
+    NANOCBOR_SCHEMA_VALUE,
+    /**
+     * @brief Nested map, struct member decoded with the nested schema
+     */
+    NANOCBOR_SCHEMA_MAP,
+} nanocbor_schema_type_t;
+
+/**
+ * @name Schema field flags
+ * @{
+ */
+#define NANOCBOR_SCHEMA_REQUIRED    (0x01U) /**< Field must be present */
+/** @} */
+
+/**
+ * @brief String member, pointing into the decoded buffer
+ */
+typedef struct nanocbor_schema_str {
+    const uint8_t *buf; /**< Start of the string */
+    size_t len;         /**< Length of the string */
+} nanocbor_schema_str_t;
+
+/**
+ * @brief Offset and size initializer for a struct member of a schema field
+ */
+#define NANOCBOR_SCHEMA_MEMBER(type, member) \
+    .offset = offsetof(type, member), .size = sizeof(((type *)0)->member)
+
+struct nanocbor_schema;
+
+/**
+ * @brief Schema field descriptor
+ */
+typedef struct nanocbor_schema_field {
+    const char *name;   /**< Text string key, NULL to use the integer key */
+    const struct nanocbor_schema *nested; /**< Schema for a
+                                            *  NANOCBOR_SCHEMA_MAP field */
+    int32_t key;        /**< Integer key, used when name is NULL */
+    uint16_t offset;    /**< Offset of the member in the struct */
+    uint16_t size;      /**< Size of the member in the struct */
+    uint8_t type;       /**< Field type, @ref nanocbor_schema_type_t */
+    uint8_t flags;      /**< Field flags */
+} nanocbor_schema_field_t;
+
+/**
+ * @brief Schema describing a CBOR map
+ */
+typedef struct nanocbor_schema {
+    const nanocbor_schema_field_t *fields;  /**< Field descriptors */
+    size_t num;                             /**< Number of fields */
+} nanocbor_schema_t;
+
+/**
+ * @brief Decode a map into a struct as described by @p schema
+ *
+ * Members of fields not present in the map are left untouched. On success,
+ * @p it is advanced past the map. Nested maps are limited to
+ * @ref NANOCBOR_RECURSION_MAX levels, also for schemas that refer to
+ * themselves.
+ *
+ * @param[in]   it      CBOR value to decode the map from
+ * @param[in]   schema  description of the map
+ * @param[out]  out     struct to decode into
+ * @param[out]  found   bitmask of the fields found, bit n for field n, may
+ *                      be NULL
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              NANOCBOR_NOT_FOUND when a required field is missing
+ * @return              NANOCBOR_ERR_RECURSION when the maps are nested too
+ *                      deep
+ * @return              negative on decode error
+ */
+int nanocbor_schema_decode(nanocbor_value_t *it, const nanocbor_schema_t *schema,
+                           void *out, uint32_t *found);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NANOCBOR_SCHEMA_H */
+/** @} */
@@ -0,0 +1,90 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @defgroup    nanocbor_sequence NanoCBOR CBOR sequences
+ * @brief       Iterate over and split RFC 8742 CBOR sequences
+ *
+ * A CBOR sequence is a concatenation of CBOR items without any framing. The
+ * sequence iterator walks a buffer one top level item at a time:
+ *
+ * ```C
+ * nanocbor_value_t seq;
+ * const uint8_t *item;
+ * size_t len;
+ * int res;
+ *
+ * nanocbor_decoder_init(&seq, buf, buf_len);
+ * while ((res = nanocbor_sequence_next(&seq, &item, &len)) == NANOCBOR_OK) {
+ *     handle_record(item, len);
+ * }
+ * ```
+ *
+ * CBOR is not self-synchronizing, item boundaries can only be found by
+ * walking the sequence from the start. @ref nanocbor_sequence_split finds
+ * boundaries with a pass that only checks the structure of the items, so
+ * that the slices can be decoded independently, for example by multiple
+ * threads.
+ *
+ * @{
+ *
+ * @file
+ * @see         [rfc 8742](https://tools.ietf.org/html/rfc8742)
+ */
+
+#ifndef NANOCBOR_SEQUENCE_H
+#define NANOCBOR_SEQUENCE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "nanocbor/nanocbor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Retrieve the next item of a CBOR sequence
+ *
+ * @param[in]   seq     decoder value initialized with the sequence
+ * @param[out]  item    start of the item
+ * @param[out]  len     length of the item
+ *
+ * @return              NANOCBOR_OK when an item is returned
+ * @return              NANOCBOR_NOT_FOUND at the end of the sequence
+ * @return              negative when the next item is truncated or
+ *                      malformed, @p seq is not advanced
+ */
+int nanocbor_sequence_next(nanocbor_value_t *seq, const uint8_t **item,
+                           size_t *len);
+
+/**
+ * @brief Split a CBOR sequence in slices of about equal size
+ *
+ * Slice n starts at @p offsets[n] and ends where the next slice starts, the
+ * last slice ends at the end of the buffer. Every slice contains at least
+ * one item, fewer than @p num slices are returned when the sequence has
+ * fewer items or when items are larger than a slice. Items are skipped with
+ * @ref nanocbor_skip_structure and the items of the last slice are not
+ * walked at all, the consumer of a slice still has to decode its items.
+ *
+ * @param[in]   buf     CBOR sequence
+ * @param[in]   len     length of @p buf
+ * @param[out]  offsets start offsets of the slices
+ * @param[in]   num     maximum number of slices, size of @p offsets
+ *
+ * @return              number of slices
+ * @return              negative when the structure of the sequence is
+ *                      truncated or malformed
+ */
+int nanocbor_sequence_split(const uint8_t *buf, size_t len, size_t *offsets,
+                            size_t num);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NANOCBOR_SEQUENCE_H */
+/** @} */
@@ -0,0 +1,129 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @defgroup    nanocbor_stats NanoCBOR statistics and tracing
+ * @brief       Optional counters and trace hook for the decoder and encoder
+ *
+ * With @ref NANOCBOR_STATS enabled, the decoder and encoder update the
+ * counters in @ref nanocbor_stats and report errors to a trace callback.
+ * When disabled, none of this is compiled in.
+ *
+ * The getters inlined by @ref NANOCBOR_INLINE bypass the library and are
+ * not counted.
+ *
+ * The counters are shared by all decoder and encoder contexts. Defining
+ * @ref NANOCBOR_STATS_STORAGE as `_Thread_local` or `__thread` gives every
+ * thread its own counters, otherwise concurrent use gives inexact counts.
+ *
+ * @{
+ *
+ * @file
+ */
+
+#ifndef NANOCBOR_STATS_H
+#define NANOCBOR_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "nanocbor/config.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Storage class of the counters, empty for global counters
+ */
+#ifndef NANOCBOR_STATS_STORAGE
+#define NANOCBOR_STATS_STORAGE
+#endif
+
+/**
+ * @brief Trace events
+ */
+typedef enum {
+    NANOCBOR_TRACE_DECODE_ERROR,    /**< A getter returned an error */
+    NANOCBOR_TRACE_SKIP_ERROR,      /**< @ref nanocbor_skip failed */
+    NANOCBOR_TRACE_ENCODE_FULL,     /**< The encoder ran out of space */
+} nanocbor_trace_event_t;
+
+/**
+ * @brief Trace callback
+ *
+ * @param[in]   ctx     context pointer passed to @ref nanocbor_trace_set
+ * @param[in]   event   event type
+ * @param[in]   pos     position in the decoded or encoded buffer
+ * @param[in]   code    error code
+ */
+typedef void (*nanocbor_trace_cb_t)(void *ctx, nanocbor_trace_event_t event,
+                                    const uint8_t *pos, int code);
+
+/**
+ * @brief Decoder and encoder counters
+ */
+typedef struct nanocbor_stats {
+    uint64_t decoded;       /**< Items consumed by the getters and
+                              *  @ref nanocbor_skip */
+    uint64_t skipped;       /**< Items visited by @ref nanocbor_skip,
+                              *  including nested items */
+    uint64_t skipped_bytes; /**< Bytes skipped by @ref nanocbor_skip */
+    uint64_t key_probes;    /**< Map keys compared in the key lookups */
+    uint64_t errors;        /**< Errors reported to the trace callback */
+    uint64_t encode_full;   /**< Writes that did not fit the encoder
+                              *  buffer, not counting size determination
+                              *  with a NULL buffer */
+    uint64_t sink_calls;    /**< Calls to the encoder sink */
+    uint32_t skip_depth;    /**< Deepest nesting seen by @ref nanocbor_skip */
+} nanocbor_stats_t;
+
+#if NANOCBOR_STATS || defined(DOXYGEN)
+
+/**
+ * @brief The counters
+ */
+extern NANOCBOR_STATS_STORAGE nanocbor_stats_t nanocbor_stats;
+
+/**
+ * @brief Clear all counters
+ */
+void nanocbor_stats_reset(void);
+
+/**
+ * @brief Set the trace callback
+ *
+ * @param[in]   cb      callback, NULL to disable tracing
+ * @param[in]   ctx     context pointer passed to the callback
+ */
+void nanocbor_trace_set(nanocbor_trace_cb_t cb, void *ctx);
+
+/* Report an event to the trace callback, internal use */
+void nanocbor_trace(nanocbor_trace_event_t event, const uint8_t *pos,
+                    int code);
+
+#define NANOCBOR_STATS_ADD(field, num) \
+    (nanocbor_stats.field += (uint64_t)(num))
+#define NANOCBOR_STATS_MAX(field, num) \
+    do { \
+        if ((num) > nanocbor_stats.field) { \
+            nanocbor_stats.field = (num); \
+        } \
+    } while (0)
+#define NANOCBOR_TRACE(event, pos, code) nanocbor_trace(event, pos, code)
+
+#else
+
+#define NANOCBOR_STATS_ADD(field, num)      do { } while (0)
+#define NANOCBOR_STATS_MAX(field, num)      do { } while (0)
+#define NANOCBOR_TRACE(event, pos, code)    do { } while (0)
+
+#endif /* NANOCBOR_STATS */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NANOCBOR_STATS_H */
+/** @} */
@@ -0,0 +1,136 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @defgroup    nanocbor_tape NanoCBOR structural index
+ * @brief       Flat index of every item in a document for random access
+ *
+ * Navigating a document with the decoder parses every byte walked over.
+ * When the same large document is queried many times, the tape walks the
+ * document once and stores an entry per item in a caller supplied array, in
+ * document order. Afterwards skipping a container is a single lookup and the
+ * elements of a container can be reached without parsing.
+ *
+ * Tags are a prefix of the item they tag: the entry starts at the first tag
+ * and has the type of the tagged item.
+ *
+ * @{
+ *
+ * @file
+ */
+
+#ifndef NANOCBOR_TAPE_H
+#define NANOCBOR_TAPE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "nanocbor/nanocbor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Tape entry, one per CBOR item
+ */
+typedef struct nanocbor_tape_entry {
+    uint32_t offset;    /**< Offset of the item, including tags */
+    uint32_t end;       /**< Offset just past the item */
+    uint32_t next;      /**< Index of the first entry after the item and
+                          *  everything nested in it */
+    uint32_t count;     /**< Number of child items, twice the number of
+                          *  pairs for a map */
+    uint8_t type;       /**< Major type of the item */
+} nanocbor_tape_entry_t;
+
+/**
+ * @brief Tape context
+ */
+typedef struct nanocbor_tape {
+    const uint8_t *buf;             /**< Indexed document */
+    nanocbor_tape_entry_t *entries; /**< Entries, in document order */
+    size_t size;                    /**< Number of entries available */
+    size_t used;                    /**< Number of entries used */
+} nanocbor_tape_t;
+
+/**
+ * @brief Initialize a tape with an array of entries
+ *
+ * @param[out]  tape    tape context
+ * @param[in]   entries array of entries
+ * @param[in]   size    number of entries in the array
+ */
+void nanocbor_tape_init(nanocbor_tape_t *tape, nanocbor_tape_entry_t *entries,
+                        size_t size);
+
+/**
+ * @brief Index all items in @p buf
+ *
+ * Every top level item in @p buf is indexed, the first one at entry 0. The
+ * buffer must stay valid while the tape is used.
+ *
+ * @param[in]   tape    tape context
+ * @param[in]   buf     CBOR document
+ * @param[in]   len     length of @p buf, at most 4 GiB
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              NANOCBOR_ERR_OVERFLOW when the entries are exhausted
+ * @return              NANOCBOR_ERR_RECURSION when the document is nested
+ *                      deeper than @ref NANOCBOR_RECURSION_MAX
+ * @return              negative on decode error
+ */
+int nanocbor_tape_build(nanocbor_tape_t *tape, const uint8_t *buf, size_t len);
+
+/**
+ * @brief Retrieve the entry following an item and its children
+ *
+ * For a child of a container, this is the next child when there is one.
+ *
+ * @param[in]   tape    tape context
+ * @param[in]   idx     entry index
+ *
+ * @return              entry index, equal to `tape->used` after the last item
+ */
+static inline size_t nanocbor_tape_next(const nanocbor_tape_t *tape,
+                                        size_t idx)
+{
+    return tape->entries[idx].next;
+}
+
+/**
+ * @brief Retrieve child @p n of a container
+ *
+ * This is a single lookup for containers without nested containers and a
+ * walk over the preceding children otherwise.
+ *
+ * @param[in]   tape    tape context
+ * @param[in]   idx     entry index of the container
+ * @param[in]   n       child number, for maps the key of pair n is child
+ *                      2n, the value 2n + 1
+ * @param[out]  child   entry index of the child
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              NANOCBOR_NOT_FOUND when the container has no child
+ *                      @p n
+ */
+int nanocbor_tape_child(const nanocbor_tape_t *tape, size_t idx, size_t n,
+                        size_t *child);
+
+/**
+ * @brief Initialize a decoder value to decode the item of an entry
+ *
+ * @param[in]   tape    tape context
+ * @param[in]   idx     entry index
+ * @param[out]  value   decoder value limited to the item
+ */
+void nanocbor_tape_value(const nanocbor_tape_t *tape, size_t idx,
+                         nanocbor_value_t *value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NANOCBOR_TAPE_H */
+/** @} */
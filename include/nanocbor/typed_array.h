@@ -0,0 +1,185 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @defgroup    nanocbor_typed_array NanoCBOR RFC 8746 typed arrays
+ * @brief       Numeric arrays encoded as a tagged byte string
+ *
+ * A typed array stores the elements of a numeric array as their raw machine
+ * representation in a byte string, tagged with the element type and byte
+ * order. Encoding is a copy of the array and decoding can hand out a
+ * pointer straight into the input buffer when the byte order of the array
+ * matches the host and the elements are suitably aligned:
+ *
+ * ```C
+ * nanocbor_typed_array_t arr;
+ * if (nanocbor_get_typed_array(&it, &arr) == NANOCBOR_OK &&
+ *         arr.type == NANOCBOR_TAG_TYPED_UINT16) {
+ *     const uint16_t *samples = nanocbor_typed_array_view(&arr);
+ *     if (!samples) {
+ *         nanocbor_typed_array_copy(&arr, buf, ARRAY_SIZE(buf));
+ *     }
+ * }
+ * ```
+ *
+ * @{
+ *
+ * @file
+ * @see         [rfc 8746](https://tools.ietf.org/html/rfc8746)
+ */
+
+#ifndef NANOCBOR_TYPED_ARRAY_H
+#define NANOCBOR_TYPED_ARRAY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "nanocbor/config.h"
+#include "nanocbor/nanocbor.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @name RFC 8746 typed array tags
+ * @{
+ */
+#define NANOCBOR_TAG_TYPED_UINT8         (64U) /**< uint8 */
+#define NANOCBOR_TAG_TYPED_UINT16_BE     (65U) /**< uint16, big endian */
+#define NANOCBOR_TAG_TYPED_UINT32_BE     (66U) /**< uint32, big endian */
+#define NANOCBOR_TAG_TYPED_UINT64_BE     (67U) /**< uint64, big endian */
+#define NANOCBOR_TAG_TYPED_UINT8_CLAMPED (68U) /**< uint8, clamped */
+#define NANOCBOR_TAG_TYPED_UINT16_LE     (69U) /**< uint16, little endian */
+#define NANOCBOR_TAG_TYPED_UINT32_LE     (70U) /**< uint32, little endian */
+#define NANOCBOR_TAG_TYPED_UINT64_LE     (71U) /**< uint64, little endian */
+#define NANOCBOR_TAG_TYPED_SINT8         (72U) /**< sint8 */
+#define NANOCBOR_TAG_TYPED_SINT16_BE     (73U) /**< sint16, big endian */
+#define NANOCBOR_TAG_TYPED_SINT32_BE     (74U) /**< sint32, big endian */
+#define NANOCBOR_TAG_TYPED_SINT64_BE     (75U) /**< sint64, big endian */
+#define NANOCBOR_TAG_TYPED_SINT16_LE     (77U) /**< sint16, little endian */
+#define NANOCBOR_TAG_TYPED_SINT32_LE     (78U) /**< sint32, little endian */
+#define NANOCBOR_TAG_TYPED_SINT64_LE     (79U) /**< sint64, little endian */
+#define NANOCBOR_TAG_TYPED_FLOAT16_BE    (80U) /**< binary16, big endian */
+#define NANOCBOR_TAG_TYPED_FLOAT32_BE    (81U) /**< binary32, big endian */
+#define NANOCBOR_TAG_TYPED_FLOAT64_BE    (82U) /**< binary64, big endian */
+#define NANOCBOR_TAG_TYPED_FLOAT128_BE   (83U) /**< binary128, big endian */
+#define NANOCBOR_TAG_TYPED_FLOAT16_LE    (84U) /**< binary16, little endian */
+#define NANOCBOR_TAG_TYPED_FLOAT32_LE    (85U) /**< binary32, little endian */
+#define NANOCBOR_TAG_TYPED_FLOAT64_LE    (86U) /**< binary64, little endian */
+#define NANOCBOR_TAG_TYPED_FLOAT128_LE   (87U) /**< binary128, little endian */
+/** @} */
+
+/**
+ * @name Typed array tags in the host byte order
+ * @{
+ */
+#if NANOCBOR_HOST_BIG_ENDIAN
+#define NANOCBOR_TAG_TYPED_UINT16   NANOCBOR_TAG_TYPED_UINT16_BE  /**< uint16 */
+#define NANOCBOR_TAG_TYPED_UINT32   NANOCBOR_TAG_TYPED_UINT32_BE  /**< uint32 */
+#define NANOCBOR_TAG_TYPED_UINT64   NANOCBOR_TAG_TYPED_UINT64_BE  /**< uint64 */
+#define NANOCBOR_TAG_TYPED_SINT16   NANOCBOR_TAG_TYPED_SINT16_BE  /**< sint16 */
+#define NANOCBOR_TAG_TYPED_SINT32   NANOCBOR_TAG_TYPED_SINT32_BE  /**< sint32 */
+#define NANOCBOR_TAG_TYPED_SINT64   NANOCBOR_TAG_TYPED_SINT64_BE  /**< sint64 */
+#define NANOCBOR_TAG_TYPED_FLOAT32  NANOCBOR_TAG_TYPED_FLOAT32_BE /**< float  */
+#define NANOCBOR_TAG_TYPED_FLOAT64  NANOCBOR_TAG_TYPED_FLOAT64_BE /**< double */
+#else
+#define NANOCBOR_TAG_TYPED_UINT16   NANOCBOR_TAG_TYPED_UINT16_LE  /**< uint16 */
+#define NANOCBOR_TAG_TYPED_UINT32   NANOCBOR_TAG_TYPED_UINT32_LE  /**< uint32 */
+#define NANOCBOR_TAG_TYPED_UINT64   NANOCBOR_TAG_TYPED_UINT64_LE  /**< uint64 */
+#define NANOCBOR_TAG_TYPED_SINT16   NANOCBOR_TAG_TYPED_SINT16_LE  /**< sint16 */
+#define NANOCBOR_TAG_TYPED_SINT32   NANOCBOR_TAG_TYPED_SINT32_LE  /**< sint32 */
+#define NANOCBOR_TAG_TYPED_SINT64   NANOCBOR_TAG_TYPED_SINT64_LE  /**< sint64 */
+#define NANOCBOR_TAG_TYPED_FLOAT32  NANOCBOR_TAG_TYPED_FLOAT32_LE /**< float  */
+#define NANOCBOR_TAG_TYPED_FLOAT64  NANOCBOR_TAG_TYPED_FLOAT64_LE /**< double */
+#endif
+/** @} */
+
+/**
+ * @brief Decoded typed array
+ */
+typedef struct nanocbor_typed_array {
+    const uint8_t *buf; /**< Elements, pointing into the decoded buffer */
+    size_t num;         /**< Number of elements */
+    uint32_t tag;       /**< Typed array tag as encoded */
+    uint32_t type;      /**< Typed array tag in the host byte order */
+    uint8_t size;       /**< Size of a single element in bytes */
+} nanocbor_typed_array_t;
+
+/**
+ * @brief Size of a single element of a typed array
+ *
+ * @param[in]   tag     typed array tag
+ *
+ * @return              element size in bytes
+ * @return              0 if @p tag is not a typed array tag
+ */
+size_t nanocbor_typed_array_elem_size(uint32_t tag);
+
+/**
+ * @brief Write a typed array into the encoder buffer
+ *
+ * The elements are copied as is, they must be in the byte order of @p tag.
+ * Use the host byte order tags such as @ref NANOCBOR_TAG_TYPED_UINT16 to
+ * encode a C array.
+ *
+ * @param[in]   enc     Encoder context
+ * @param[in]   tag     typed array tag
+ * @param[in]   data    elements to write
+ * @param[in]   num     number of elements in @p data
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              NANOCBOR_ERR_INVALID_TYPE if @p tag is not a typed
+ *                      array tag
+ * @return              Negative on error
+ */
+int nanocbor_put_typed_array(nanocbor_encoder_t *enc, uint32_t tag,
+                             const void *data, size_t num);
+
+/**
+ * @brief Retrieve a typed array from the stream
+ *
+ * On success, @p it is advanced past the typed array.
+ *
+ * @param[in]   it      CBOR value to decode from
+ * @param[out]  arr     decoded typed array
+ *
+ * @return              NANOCBOR_OK on success
+ * @return              NANOCBOR_ERR_INVALID_TYPE if the value is not a
+ *                      typed array or the byte string length is not a
+ *                      multiple of the element size
+ * @return              Negative on error
+ */
+int nanocbor_get_typed_array(nanocbor_value_t *it, nanocbor_typed_array_t *arr);
+
+/**
+ * @brief Direct access to the elements of a typed array
+ *
+ * @param[in]   arr     decoded typed array
+ *
+ * @return              pointer to the elements in the decoded buffer if
+ *                      they are in the host byte order and aligned
+ * @return              NULL otherwise, use @ref nanocbor_typed_array_copy
+ */
+const void *nanocbor_typed_array_view(const nanocbor_typed_array_t *arr);
+
+/**
+ * @brief Copy the elements of a typed array in the host byte order
+ *
+ * @param[in]   arr     decoded typed array
+ * @param[out]  out     buffer for the elements
+ * @param[in]   max     number of elements @p out can hold
+ *
+ * @return              number of elements copied
+ */
+size_t nanocbor_typed_array_copy(const nanocbor_typed_array_t *arr, void *out,
+                                 size_t max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NANOCBOR_TYPED_ARRAY_H */
+/** @} */
@@ -0,0 +1,327 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @ingroup nanocbor_canonical
+ * @{
+ * @file
+ * @brief   Deterministic encoding implementation
+ * @}
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nanocbor/config.h"
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/canonical.h"
+
+/* Bytewise lexicographic comparison of two encoded items */
+static int _compare(const uint8_t *a, size_t a_len, const uint8_t *b,
+                    size_t b_len)
+{
+    int cmp = memcmp(a, b, a_len < b_len ? a_len : b_len);
+    if (cmp == 0 && a_len != b_len) {
+        cmp = a_len < b_len ? -1 : 1;
+    }
+    return cmp;
+}
+
+static void _reverse(uint8_t *buf, size_t len)
+{
+    for (size_t i = 0; i < len / 2; i++) {
+        uint8_t tmp = buf[i];
+        buf[i] = buf[len - 1 - i];
+        buf[len - 1 - i] = tmp;
+    }
+}
+
+/* Rotate buf so that the last @p tail bytes move to the front */
+static void _rotate(uint8_t *buf, size_t len, size_t tail)
+{
+    _reverse(buf, len - tail);
+    _reverse(buf + len - tail, tail);
+    _reverse(buf, len);
+}
+
+int nanocbor_canonical_map_end(nanocbor_encoder_t *enc, nanocbor_deferred_t *map,
+                               nanocbor_canonical_entry_t *scratch, size_t num)
+{
+    size_t written = enc->len - map->len;
+
+    if (map->type != NANOCBOR_MASK_MAP) {
+        return NANOCBOR_ERR_INVALID_TYPE;
+    }
+    /* Same precondition as nanocbor_fmt_container_end, checked before the
+     * buffer is modified */
+    if (!map->hdr || written < NANOCBOR_DEFERRED_HDR_LEN ||
+        (size_t)(enc->cur - map->hdr) != written) {
+        return NANOCBOR_ERR_END;
+    }
+    if (enc->deferred != map) {
+        return NANOCBOR_ERR_INVALID_TYPE;
+    }
+    uint8_t *body = map->hdr + NANOCBOR_DEFERRED_HDR_LEN;
+    size_t body_len = written - NANOCBOR_DEFERRED_HDR_LEN;
+    nanocbor_value_t it;
+    size_t entries = 0;
+
+    /* Index the entries, insertion sorted on their keys */
+    nanocbor_decoder_init(&it, body, body_len);
+    while (!nanocbor_at_end(&it)) {
+        nanocbor_canonical_entry_t entry;
+        entry.offset = (size_t)(it.cur - body);
+        int res = nanocbor_skip(&it);
+        if (res < 0) {
+            return res;
+        }
+        entry.key_len = (size_t)(it.cur - body) - entry.offset;
+        if (nanocbor_at_end(&it)) {
+            return NANOCBOR_ERR_INVALID_TYPE;
+        }
+        res = nanocbor_skip(&it);
+        if (res < 0) {
+            return res;
+        }
+        entry.len = (size_t)(it.cur - body) - entry.offset;
+        if (entries == num) {
+            return NANOCBOR_ERR_OVERFLOW;
+        }
+        size_t pos = entries++;
+        for (; pos > 0; pos--) {
+            const nanocbor_canonical_entry_t *prev = &scratch[pos - 1];
+            int cmp = _compare(body + prev->offset, prev->key_len,
+                               body + entry.offset, entry.key_len);
+            if (cmp == 0) {
+                return NANOCBOR_ERR_INVALID_TYPE;
+            }
+            if (cmp < 0) {
+                break;
+            }
+            scratch[pos] = *prev;
+        }
+        scratch[pos] = entry;
+    }
+
+    /* Move the entries into place one by one. Rotating an entry to the
+     * front of the unsorted part shifts the entries it passes. */
+    size_t sorted = 0;
+    for (size_t i = 0; i < entries; i++) {
+        nanocbor_canonical_entry_t *entry = &scratch[i];
+        if (entry->offset != sorted) {
+            _rotate(body + sorted, entry->offset + entry->len - sorted,
+                    entry->len);
+            for (size_t j = i + 1; j < entries; j++) {
+                if (scratch[j].offset < entry->offset) {
+                    scratch[j].offset += entry->len;
+                }
+            }
+            entry->offset = sorted;
+        }
+        sorted += entry->len;
+    }
+    /* The entries are counted already, the content moved behind the point
+     * the encoder counted up to */
+    map->scan = enc->cur;
+    map->need = 0;
+    map->payload = 0;
+    map->indefinite = 0;
+    map->items = (uint32_t)(entries * 2U);
+    return nanocbor_fmt_container_end(enc, map);
+}
+
+/* Smallest argument for each of the 1, 2, 4 and 8 byte forms */
+static const uint64_t _arg_min[] = {
+    NANOCBOR_SIZE_BYTE, 0x100U, 0x10000U, 0x100000000U,
+};
+
+/* Read the argument of the header at *cur, rejecting non-shortest forms and
+ * indefinite lengths */
+static int _get_arg(const uint8_t **cur, const uint8_t *end, uint64_t *arg)
+{
+    const uint8_t *pos = *cur;
+    uint8_t info = *pos++ & NANOCBOR_VALUE_MASK;
+
+    if (info < NANOCBOR_SIZE_BYTE) {
+        *arg = info;
+    }
+    else if (info <= NANOCBOR_SIZE_LONG) {
+        size_t bytes = 1U << (info - NANOCBOR_SIZE_BYTE);
+        if ((size_t)(end - pos) < bytes) {
+            return NANOCBOR_ERR_END;
+        }
+        *arg = 0;
+        for (size_t i = 0; i < bytes; i++) {
+            *arg = (*arg << 8U) | *pos++;
+        }
+        if (*arg < _arg_min[info - NANOCBOR_SIZE_BYTE]) {
+            return NANOCBOR_ERR_INVALID_TYPE;
+        }
+    }
+    else {
+        return NANOCBOR_ERR_INVALID_TYPE;
+    }
+    *cur = pos;
+    return NANOCBOR_OK;
+}
+
+/* Check a major type 7 item by encoding it again */
+static int _check_simple(const uint8_t **cur, const uint8_t *end)
+{
+    const uint8_t *pos = *cur;
+    uint8_t info = *pos & NANOCBOR_VALUE_MASK;
+    uint8_t tmp[1 + sizeof(double)];
+    nanocbor_encoder_t enc;
+    nanocbor_value_t val;
+    int res = 1;
+
+    nanocbor_decoder_init(&val, pos, (size_t)(end - pos));
+    nanocbor_encoder_init(&enc, tmp, sizeof(tmp));
+    if (info == NANOCBOR_SIZE_BYTE) {
+        if ((size_t)(end - pos) < 2) {
+            return NANOCBOR_ERR_END;
+        }
+        /* Simple values below 32 have a single byte encoding */
+        res = pos[1] < 32U ? NANOCBOR_ERR_INVALID_TYPE : 2;
+    }
+    else if (info == NANOCBOR_SIZE_SHORT) {
+        res = (size_t)(end - pos) < 3 ? NANOCBOR_ERR_END : 3;
+    }
+    else if (info == NANOCBOR_SIZE_WORD) {
+        float num = 0;
+        res = nanocbor_get_float(&val, &num);
+        if (res > 0 && (nanocbor_fmt_float(&enc, num) < 0 ||
+                        nanocbor_encoded_len(&enc) != (size_t)res)) {
+            res = NANOCBOR_ERR_INVALID_TYPE;
+        }
+    }
+    else if (info == NANOCBOR_SIZE_LONG) {
+        double num = 0;
+        res = nanocbor_get_double(&val, &num);
+        if (res > 0 && (nanocbor_fmt_double(&enc, num) < 0 ||
+                        nanocbor_encoded_len(&enc) != (size_t)res)) {
+            res = NANOCBOR_ERR_INVALID_TYPE;
+        }
+    }
+    else if (info > NANOCBOR_SIZE_LONG) {
+        res = NANOCBOR_ERR_INVALID_TYPE;
+    }
+    if (res < 0) {
+        return res;
+    }
+    *cur = pos + res;
+    return NANOCBOR_OK;
+}
+
+/* Open container during the check */
+typedef struct {
+    uint64_t left;          /* Items left, keys and values for a map */
+    const uint8_t *key;     /* Start of the key being checked */
+    const uint8_t *prev;    /* Previous key of the map */
+    size_t prev_len;        /* Length of the previous key */
+    bool map;               /* Container is a map */
+} _frame_t;
+
+/* Item finished at @p cur, check the key order if it was a map key */
+static int _complete(_frame_t *frame, const uint8_t *cur)
+{
+    if (frame->key) {
+        size_t len = (size_t)(cur - frame->key);
+        if (frame->prev &&
+            _compare(frame->prev, frame->prev_len, frame->key, len) >= 0) {
+            return NANOCBOR_ERR_INVALID_TYPE;
+        }
+        frame->prev = frame->key;
+        frame->prev_len = len;
+        frame->key = NULL;
+    }
+    return NANOCBOR_OK;
+}
+
+int nanocbor_canonical_check(nanocbor_value_t *it)
+{
+    _frame_t frames[NANOCBOR_RECURSION_MAX + 1];
+    const uint8_t *cur = it->cur;
+    const uint8_t *end = it->end;
+    size_t depth = 0;
+    bool tagged = false;
+    int res = NANOCBOR_OK;
+
+    memset(&frames[0], 0, sizeof(frames[0]));
+    frames[0].left = 1;
+    while (true) {
+        _frame_t *frame = &frames[depth];
+
+        /* A tagged item continues the item started by the tag */
+        if (!tagged) {
+            if (frame->left == 0) {
+                if (depth == 0) {
+                    break;
+                }
+                res = _complete(&frames[--depth], cur);
+                if (res < 0) {
+                    return res;
+                }
+                continue;
+            }
+            if (frame->map && (frame->left % 2) == 0) {
+                frame->key = cur;
+            }
+            frame->left--;
+        }
+        tagged = false;
+        if (cur >= end) {
+            return NANOCBOR_ERR_END;
+        }
+
+        uint8_t type = *cur >> NANOCBOR_TYPE_OFFSET;
+        uint64_t arg = 0;
+        if (type == NANOCBOR_TYPE_FLOAT) {
+            res = _check_simple(&cur, end);
+        }
+        else {
+            res = _get_arg(&cur, end, &arg);
+        }
+        if (res < 0) {
+            return res;
+        }
+        switch (type) {
+            case NANOCBOR_TYPE_BSTR:
+            case NANOCBOR_TYPE_TSTR:
+                if ((uint64_t)(end - cur) < arg) {
+                    return NANOCBOR_ERR_END;
+                }
+                cur += arg;
+                break;
+            case NANOCBOR_TYPE_ARR:
+            case NANOCBOR_TYPE_MAP:
+                if (depth == NANOCBOR_RECURSION_MAX) {
+                    return NANOCBOR_ERR_RECURSION;
+                }
+                /* Every item takes at least a byte */
+                if (arg > (uint64_t)(end - cur)) {
+                    return NANOCBOR_ERR_END;
+                }
+                frame = &frames[++depth];
+                memset(frame, 0, sizeof(*frame));
+                frame->map = (type == NANOCBOR_TYPE_MAP);
+                frame->left = frame->map ? arg * 2 : arg;
+                continue;
+            case NANOCBOR_TYPE_TAG:
+                tagged = true;
+                continue;
+            default:
+                break;
+        }
+        res = _complete(frame, cur);
+        if (res < 0) {
+            return res;
+        }
+    }
+    res = nanocbor_skip(it);
+    return res < 0 ? res : NANOCBOR_OK;
+}
@@ -17,24 +17,71 @@
 #include <stdlib.h>
 #include <string.h>
 
+/* The definitions below are the out-of-line slow paths */
+#undef NANOCBOR_INLINE
+#define NANOCBOR_INLINE 0
+
 #include "nanocbor/config.h"
 #include "nanocbor/nanocbor.h"
+#include "nanocbor/stats.h"
 
 #include NANOCBOR_BYTEORDER_HEADER
 
+#if NANOCBOR_SKIP_SIMD && defined(__SSE2__)
+#include <emmintrin.h>
+#define NANOCBOR_SKIP_SIMD_SSE2
+#elif NANOCBOR_SKIP_SIMD && defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define NANOCBOR_SKIP_SIMD_NEON
+#endif
+
+#if NANOCBOR_STATS
+NANOCBOR_STATS_STORAGE nanocbor_stats_t nanocbor_stats;
+static nanocbor_trace_cb_t _trace_cb;
+static void *_trace_ctx;
+
+void nanocbor_stats_reset(void)
+{
+    memset(&nanocbor_stats, 0, sizeof(nanocbor_stats));
+}
+
+void nanocbor_trace_set(nanocbor_trace_cb_t cb, void *ctx)
+{
+    _trace_cb = cb;
+    _trace_ctx = ctx;
+}
+
+void nanocbor_trace(nanocbor_trace_event_t event, const uint8_t *pos,
+                    int code)
+{
+    nanocbor_stats.errors++;
+    if (_trace_cb) {
+        _trace_cb(_trace_ctx, event, pos, code);
+    }
+}
+#endif
 
 void nanocbor_decoder_init(nanocbor_value_t *value,
                            const uint8_t *buf, size_t len)
 {
     value->cur = buf;
     value->end = buf + len;
+    value->remaining = 0;
     value->flags = 0;
 }
 
+void nanocbor_decoder_resume(nanocbor_value_t *value,
+                             const uint8_t *buf, size_t len)
+{
+    value->cur = buf;
+    value->end = buf + len;
+}
+
 static void _advance(nanocbor_value_t *cvalue, unsigned int res)
 {
     cvalue->cur += res;
     cvalue->remaining--;
+    NANOCBOR_STATS_ADD(decoded, 1);
 }
 
 static int _advance_if(nanocbor_value_t *cvalue, int res)
@@ -42,6 +89,9 @@ static int _advance_if(nanocbor_value_t *cvalue, int res)
     if (res > 0) {
         _advance(cvalue, (unsigned int)res);
     }
+    else if (res < 0) {
+        NANOCBOR_TRACE(NANOCBOR_TRACE_DECODE_ERROR, cvalue->cur, res);
+    }
     return res;
 }
 
@@ -85,6 +135,16 @@ bool nanocbor_at_end(const nanocbor_value_t *it)
     return end;
 }
 
+bool nanocbor_needs_input(const nanocbor_value_t *it)
+{
+    if (nanocbor_container_indefinite(it)) {
+        /* Not complete until the end marker is seen */
+        return _over_end(it) ||
+            *it->cur != (NANOCBOR_TYPE_FLOAT << NANOCBOR_TYPE_OFFSET | NANOCBOR_VALUE_MASK);
+    }
+    return !nanocbor_in_container(it) || it->remaining > 0;
+}
+
 int nanocbor_get_type(const nanocbor_value_t *value)
 {
     if (nanocbor_at_end(value)) {
@@ -93,7 +153,7 @@ int nanocbor_get_type(const nanocbor_value_t *value)
     return (_get_type(value) >> NANOCBOR_TYPE_OFFSET);
 }
 
-static int _get_uint64(const nanocbor_value_t *cvalue, uint32_t *value, uint8_t max, int type)
+static int _get_uint64(const nanocbor_value_t *cvalue, uint64_t *value, uint8_t max, int type)
 {
     int ctype = nanocbor_get_type(cvalue);
 
@@ -124,80 +184,74 @@ static int _get_uint64(const nanocbor_value_t *cvalue, uint32_t *value, uint8_t
     /* Copy the value from cbor to the least significant bytes */
     memcpy(((uint8_t *)&tmp) + sizeof(uint64_t) - bytes, cvalue->cur + 1U, bytes);
     /* NOLINTNEXTLINE: user supplied function */
-    tmp = NANOCBOR_BE64TOH_FUNC(tmp);
-    *value = 0;
-    memcpy(value, &tmp, bytes);
+    *value = NANOCBOR_BE64TOH_FUNC(tmp);
 
     return (int)(1 + bytes);
 }
 
-static int _get_and_advance_uint8(nanocbor_value_t *cvalue, uint8_t *value,
-                                   int type)
+static int _get_and_advance_uint64(nanocbor_value_t *cvalue, uint64_t *value,
+                                   uint8_t max, int type)
 {
-    uint32_t tmp = 0;
-    int res = _get_uint64(cvalue, &tmp, NANOCBOR_SIZE_BYTE,
-                          type);
-    *value = (uint8_t)tmp;
+    int res = _get_uint64(cvalue, value, max, type);
 
     return _advance_if(cvalue, res);
 }
 
-static int _get_and_advance_uint16(nanocbor_value_t *cvalue, uint16_t *value,
-                                   int type)
+int nanocbor_get_uint8(nanocbor_value_t *cvalue, uint8_t *value)
 {
-    uint32_t tmp = 0;
-    int res = _get_uint64(cvalue, &tmp, NANOCBOR_SIZE_SHORT,
-                          type);
-    *value = (uint16_t)tmp;
+    uint64_t tmp = 0;
+    int res = _get_and_advance_uint64(cvalue, &tmp, NANOCBOR_SIZE_BYTE,
+                                      NANOCBOR_TYPE_UINT);
+    *value = (uint8_t)tmp;
 
-    return _advance_if(cvalue, res);
+    return res;
 }
 
-static int _get_and_advance_uint32(nanocbor_value_t *cvalue, uint32_t *value,
-                                   int type)
+int nanocbor_get_uint16(nanocbor_value_t *cvalue, uint16_t *value)
 {
-    uint32_t tmp = 0;
-    int res = _get_uint64(cvalue, &tmp, NANOCBOR_SIZE_WORD,
-                          type);
-    *value = tmp;
+    uint64_t tmp = 0;
+    int res = _get_and_advance_uint64(cvalue, &tmp, NANOCBOR_SIZE_SHORT,
+                                      NANOCBOR_TYPE_UINT);
+    *value = (uint16_t)tmp;
 
-    return _advance_if(cvalue, res);
+    return res;
 }
 
-int nanocbor_get_uint8(nanocbor_value_t *cvalue, uint8_t *value)
+int nanocbor_get_uint32(nanocbor_value_t *cvalue, uint32_t *value)
 {
-    return _get_and_advance_uint8(cvalue, value, NANOCBOR_TYPE_UINT);
-}
+    uint64_t tmp = 0;
+    int res = _get_and_advance_uint64(cvalue, &tmp, NANOCBOR_SIZE_WORD,
+                                      NANOCBOR_TYPE_UINT);
+    *value = (uint32_t)tmp;
 
-int nanocbor_get_uint16(nanocbor_value_t *cvalue, uint16_t *value)
-{
-    return _get_and_advance_uint16(cvalue, value, NANOCBOR_TYPE_UINT);
+    return res;
 }
 
-int nanocbor_get_uint32(nanocbor_value_t *cvalue, uint32_t *value)
+int nanocbor_get_uint64(nanocbor_value_t *cvalue, uint64_t *value)
 {
-    return _get_and_advance_uint32(cvalue, value, NANOCBOR_TYPE_UINT);
+    return _get_and_advance_uint64(cvalue, value, NANOCBOR_SIZE_LONG,
+                                   NANOCBOR_TYPE_UINT);
 }
 
-static int _get_and_advance_int32(nanocbor_value_t *cvalue, int32_t *value, uint8_t max,
-                                  uint32_t bound)
+static int _get_and_advance_int64(nanocbor_value_t *cvalue, int64_t *value, uint8_t max,
+                                  uint64_t bound)
 {
     int type = nanocbor_get_type(cvalue);
     if (type < 0) {
-        return type;
+        return _advance_if(cvalue, type);
     }
     int res = NANOCBOR_ERR_INVALID_TYPE;
     if (type == NANOCBOR_TYPE_NINT || type == NANOCBOR_TYPE_UINT) {
-        uint32_t intermediate = 0;
+        uint64_t intermediate = 0;
         res = _get_uint64(cvalue, &intermediate, max, type);
         if (intermediate > bound) {
             res = NANOCBOR_ERR_OVERFLOW;
         }
-        if (type == NANOCBOR_TYPE_NINT) {
-            *value = (-(int32_t)intermediate) - 1;
+        else if (type == NANOCBOR_TYPE_NINT) {
+            *value = (-(int64_t)intermediate) - 1;
         }
         else {
-            *value = (int32_t)intermediate;
+            *value = (int64_t)intermediate;
         }
     }
     return _advance_if(cvalue, res);
@@ -205,8 +259,8 @@ static int _get_and_advance_int32(nanocbor_value_t *cvalue, int32_t *value, uint
 
 int nanocbor_get_int8(nanocbor_value_t *cvalue, int8_t *value)
 {
-    int32_t tmp = 0;
-    int res = _get_and_advance_int32(cvalue, &tmp, NANOCBOR_SIZE_BYTE, INT8_MAX);
+    int64_t tmp = 0;
+    int res = _get_and_advance_int64(cvalue, &tmp, NANOCBOR_SIZE_BYTE, INT8_MAX);
 
     *value = (int8_t)tmp;
 
@@ -215,8 +269,8 @@ int nanocbor_get_int8(nanocbor_value_t *cvalue, int8_t *value)
 
 int nanocbor_get_int16(nanocbor_value_t *cvalue, int16_t *value)
 {
-    int32_t tmp = 0;
-    int res = _get_and_advance_int32(cvalue, &tmp, NANOCBOR_SIZE_SHORT, INT16_MAX);
+    int64_t tmp = 0;
+    int res = _get_and_advance_int64(cvalue, &tmp, NANOCBOR_SIZE_SHORT, INT16_MAX);
 
     *value = (int16_t)tmp;
 
@@ -225,21 +279,145 @@ int nanocbor_get_int16(nanocbor_value_t *cvalue, int16_t *value)
 
 int nanocbor_get_int32(nanocbor_value_t *cvalue, int32_t *value)
 {
-    return _get_and_advance_int32(cvalue, value, NANOCBOR_SIZE_WORD, INT32_MAX);
+    int64_t tmp = 0;
+    int res = _get_and_advance_int64(cvalue, &tmp, NANOCBOR_SIZE_WORD, INT32_MAX);
+
+    *value = (int32_t)tmp;
+
+    return res;
+}
+
+int nanocbor_get_int64(nanocbor_value_t *cvalue, int64_t *value)
+{
+    return _get_and_advance_int64(cvalue, value, NANOCBOR_SIZE_LONG, INT64_MAX);
 }
 
 int nanocbor_get_tag(nanocbor_value_t *cvalue, uint32_t *tag)
 {
-    int res = _get_uint64(cvalue, tag, NANOCBOR_SIZE_WORD, NANOCBOR_TYPE_TAG);
+    uint64_t tmp = 0;
+    int res = _get_uint64(cvalue, &tmp, NANOCBOR_SIZE_WORD, NANOCBOR_TYPE_TAG);
 
     if (res >= 0) {
+        *tag = (uint32_t)tmp;
         cvalue->cur += res;
         res = NANOCBOR_OK;
     }
+    else {
+        NANOCBOR_TRACE(NANOCBOR_TRACE_DECODE_ERROR, cvalue->cur, res);
+    }
+
+    return res;
+}
+
+int nanocbor_skip_tags(nanocbor_value_t *cvalue)
+{
+    while (nanocbor_get_type(cvalue) == NANOCBOR_TYPE_TAG) {
+        uint64_t tmp = 0;
+        int res = _get_uint64(cvalue, &tmp, NANOCBOR_SIZE_LONG,
+                              NANOCBOR_TYPE_TAG);
+        if (res < 0) {
+            NANOCBOR_TRACE(NANOCBOR_TRACE_DECODE_ERROR, cvalue->cur, res);
+            return res;
+        }
+        cvalue->cur += res;
+    }
+    return NANOCBOR_OK;
+}
 
+/* Half float to single float conversion related defines */
+#define HALF_EXP_SHIFTED_MASK                   (0x7C00U << 13U)
+#define HALF_SIGN_MASK                                 (0x8000U)
+#define HALF_TO_FLOAT_SHIFT                                (13U)
+#define HALF_TO_FLOAT_SIGN_SHIFT                           (16U)
+#define HALF_TO_FLOAT_EXP_ADJUST            ((127U - 15U) << 23U)
+#define HALF_TO_FLOAT_INF_ADJUST            ((128U - 16U) << 23U)
+#define HALF_TO_FLOAT_DENORM_ADJUST                  (1U << 23U)
+#define HALF_TO_FLOAT_DENORM_MAGIC                 (113U << 23U)
+
+static float _bits_to_float(uint32_t bits)
+{
+    float res = 0;
+    memcpy(&res, &bits, sizeof(res));
+    return res;
+}
+
+static uint32_t _float_to_bits(float num)
+{
+    uint32_t res = 0;
+    memcpy(&res, &num, sizeof(res));
     return res;
 }
 
+/* Convert half precision to single precision by shifting the exponent and
+ * fraction in place and rebiasing the exponent, with only infinity/NaN and
+ * subnormals requiring an extra adjustment */
+static float _half_to_float(uint16_t half)
+{
+    uint32_t single = ((uint32_t)half & ~HALF_SIGN_MASK) << HALF_TO_FLOAT_SHIFT;
+    uint32_t exp = single & HALF_EXP_SHIFTED_MASK;
+
+    single += HALF_TO_FLOAT_EXP_ADJUST;
+    if (exp == HALF_EXP_SHIFTED_MASK) {
+        /* Infinity or NaN, exponent must be all ones */
+        single += HALF_TO_FLOAT_INF_ADJUST;
+    }
+    else if (exp == 0) {
+        /* Zero or subnormal, renormalize using the FPU */
+        single += HALF_TO_FLOAT_DENORM_ADJUST;
+        single = _float_to_bits(_bits_to_float(single) -
+                                _bits_to_float(HALF_TO_FLOAT_DENORM_MAGIC));
+    }
+    single |= ((uint32_t)half & HALF_SIGN_MASK) << HALF_TO_FLOAT_SIGN_SHIFT;
+    return _bits_to_float(single);
+}
+
+static int _get_float_bits(const nanocbor_value_t *cvalue, uint64_t *bits,
+                           uint8_t max)
+{
+    int type = nanocbor_get_type(cvalue);
+
+    if (type < 0) {
+        return type;
+    }
+    uint8_t size = *cvalue->cur & NANOCBOR_VALUE_MASK;
+    if (type != NANOCBOR_TYPE_FLOAT || size < NANOCBOR_SIZE_SHORT ||
+        size > NANOCBOR_SIZE_LONG) {
+        return NANOCBOR_ERR_INVALID_TYPE;
+    }
+    return _get_uint64(cvalue, bits, max, NANOCBOR_TYPE_FLOAT);
+}
+
+int nanocbor_get_float(nanocbor_value_t *cvalue, float *value)
+{
+    uint64_t bits = 0;
+    int res = _get_float_bits(cvalue, &bits, NANOCBOR_SIZE_WORD);
+
+    if (res == 1 + sizeof(uint16_t)) {
+        *value = _half_to_float((uint16_t)bits);
+    }
+    else if (res == 1 + sizeof(uint32_t)) {
+        *value = _bits_to_float((uint32_t)bits);
+    }
+    return _advance_if(cvalue, res);
+}
+
+int nanocbor_get_double(nanocbor_value_t *cvalue, double *value)
+{
+    uint64_t bits = 0;
+    int res = _get_float_bits(cvalue, &bits, NANOCBOR_SIZE_LONG);
+
+    if (res == 1 + sizeof(uint16_t)) {
+        *value = (double)_half_to_float((uint16_t)bits);
+    }
+    else if (res == 1 + sizeof(uint32_t)) {
+        *value = (double)_bits_to_float((uint32_t)bits);
+    }
+    else if (res == 1 + sizeof(uint64_t)) {
+        memcpy(value, &bits, sizeof(*value));
+    }
+    return _advance_if(cvalue, res);
+}
+
 int nanocbor_get_decimal_frac(nanocbor_value_t *cvalue, int32_t *e, int32_t *m)
 {
     int res = NANOCBOR_NOT_FOUND;
@@ -265,17 +443,27 @@ int nanocbor_get_decimal_frac(nanocbor_value_t *cvalue, int32_t *e, int32_t *m)
 
 static int _get_str(nanocbor_value_t *cvalue, const uint8_t **buf, size_t *len, uint8_t type)
 {
-    *len = 0;
-    int res = _get_uint64(cvalue, (uint32_t*)len, NANOCBOR_SIZE_SIZET, type);
+    uint64_t tmp = 0;
+    int res = _get_uint64(cvalue, &tmp, NANOCBOR_SIZE_SIZET, type);
+    *len = (size_t)tmp;
 
-    if (cvalue->end - cvalue->cur < 0 || (size_t)(cvalue->end - cvalue->cur) < *len) {
-        return NANOCBOR_ERR_END;
+    if (res >= 0 && (size_t)(cvalue->end - cvalue->cur) - (size_t)res < *len) {
+        res = NANOCBOR_ERR_END;
     }
+#if NANOCBOR_VALIDATE_UTF8
+    if (res >= 0 && type == NANOCBOR_TYPE_TSTR &&
+        !nanocbor_utf8_valid(cvalue->cur + res, *len)) {
+        res = NANOCBOR_ERR_INVALID_UTF8;
+    }
+#endif
     if (res >= 0) {
         *buf = (cvalue->cur) + res;
         _advance(cvalue, (unsigned int)((size_t)res + *len));
         res = NANOCBOR_OK;
     }
+    else {
+        NANOCBOR_TRACE(NANOCBOR_TRACE_DECODE_ERROR, cvalue->cur, res);
+    }
     return res;
 }
 
@@ -321,11 +509,12 @@ static int _enter_container(const nanocbor_value_t *it, nanocbor_value_t *contai
         return NANOCBOR_OK;
     }
 
-    int res = _get_uint64(it, &container->remaining,
-                          NANOCBOR_SIZE_WORD, type);
+    uint64_t remaining = 0;
+    int res = _get_uint64(it, &remaining, NANOCBOR_SIZE_WORD, type);
     if (res < 0) {
         return res;
     }
+    container->remaining = (uint32_t)remaining;
     container->flags = NANOCBOR_DECODER_FLAG_CONTAINER;
     container->cur = it->cur + res;
     return NANOCBOR_OK;
@@ -358,12 +547,92 @@ void nanocbor_leave_container(nanocbor_value_t *it, nanocbor_value_t *container)
     else {
         it->cur = container->cur;
     }
+    /* The container might have been resumed in a different buffer */
+    it->end = container->end;
+}
+
+static int _enter_str(const nanocbor_value_t *it, nanocbor_value_t *chunks,
+                      uint8_t type)
+{
+    int ctype = nanocbor_get_type(it);
+
+    if (ctype < 0) {
+        return ctype;
+    }
+    if (ctype != type) {
+        return NANOCBOR_ERR_INVALID_TYPE;
+    }
+    chunks->end = it->end;
+    if ((*it->cur & NANOCBOR_VALUE_MASK) == NANOCBOR_SIZE_INDEFINITE) {
+        chunks->flags = NANOCBOR_DECODER_FLAG_INDEFINITE |
+                        NANOCBOR_DECODER_FLAG_CONTAINER;
+        chunks->cur = it->cur + 1;
+        chunks->remaining = 0;
+    }
+    else {
+        /* A definite length string is its own single chunk */
+        chunks->flags = NANOCBOR_DECODER_FLAG_CONTAINER;
+        chunks->cur = it->cur;
+        chunks->remaining = 1;
+    }
+    return NANOCBOR_OK;
+}
+
+int nanocbor_enter_bstr(const nanocbor_value_t *it, nanocbor_value_t *chunks)
+{
+    return _enter_str(it, chunks, NANOCBOR_TYPE_BSTR);
+}
+
+int nanocbor_enter_tstr(const nanocbor_value_t *it, nanocbor_value_t *chunks)
+{
+    return _enter_str(it, chunks, NANOCBOR_TYPE_TSTR);
+}
+
+static int _gather_str(nanocbor_value_t *it, uint8_t *buf, size_t size,
+                       size_t *len, uint8_t type)
+{
+    nanocbor_value_t chunks;
+    int res = _enter_str(it, &chunks, type);
+
+    *len = 0;
+    while (res == NANOCBOR_OK && !nanocbor_at_end(&chunks)) {
+        const uint8_t *chunk = NULL;
+        size_t chunk_len = 0;
+
+        res = _get_str(&chunks, &chunk, &chunk_len, type);
+        if (res == NANOCBOR_OK && size - *len < chunk_len) {
+            res = NANOCBOR_ERR_OVERFLOW;
+        }
+        else if (res == NANOCBOR_OK) {
+            memcpy(buf + *len, chunk, chunk_len);
+            *len += chunk_len;
+        }
+    }
+    if (res == NANOCBOR_OK && nanocbor_needs_input(&chunks)) {
+        res = NANOCBOR_ERR_END;
+    }
+    if (res == NANOCBOR_OK) {
+        nanocbor_leave_container(it, &chunks);
+    }
+    return res;
+}
+
+int nanocbor_gather_bstr(nanocbor_value_t *it, uint8_t *buf, size_t size,
+                         size_t *len)
+{
+    return _gather_str(it, buf, size, len, NANOCBOR_TYPE_BSTR);
+}
+
+int nanocbor_gather_tstr(nanocbor_value_t *it, uint8_t *buf, size_t size,
+                         size_t *len)
+{
+    return _gather_str(it, buf, size, len, NANOCBOR_TYPE_TSTR);
 }
 
 static int _skip_simple(nanocbor_value_t *it)
 {
     uint64_t tmp = 0;
-    int res = _get_uint64(it, (uint32_t*)&tmp, NANOCBOR_SIZE_LONG,
+    int res = _get_uint64(it, &tmp, NANOCBOR_SIZE_LONG,
                           nanocbor_get_type(it));
     return _advance_if(it, res);
 }
@@ -382,45 +651,253 @@ int nanocbor_skip_simple(nanocbor_value_t *it)
     return _skip_simple(it);
 }
 
-/* NOLINTNEXTLINE(misc-no-recursion): Recursion is limited by design */
-static int _skip_limited(nanocbor_value_t *it, uint8_t limit)
+/* Stop code for indefinite length containers */
+#define NANOCBOR_BREAK  (NANOCBOR_MASK_FLOAT | NANOCBOR_SIZE_INDEFINITE)
+
+/* Skip the header of a single item including any tags prefixed to it */
+static int _skip_header(nanocbor_value_t *cur, uint64_t *arg, bool *indefinite)
+{
+    int type = 0;
+
+    do {
+        if (_over_end(cur)) {
+            return NANOCBOR_ERR_END;
+        }
+        type = _get_type(cur) >> NANOCBOR_TYPE_OFFSET;
+        *indefinite = (*cur->cur & NANOCBOR_VALUE_MASK) == NANOCBOR_SIZE_INDEFINITE;
+        if (*indefinite &&
+            (type == NANOCBOR_TYPE_ARR || type == NANOCBOR_TYPE_MAP ||
+             type == NANOCBOR_TYPE_BSTR || type == NANOCBOR_TYPE_TSTR)) {
+            cur->cur++;
+            return type;
+        }
+        int res = _get_uint64(cur, arg, NANOCBOR_SIZE_LONG, type);
+        if (res < 0) {
+            return res;
+        }
+        cur->cur += res;
+    } while (type == NANOCBOR_TYPE_TAG);
+
+    return type;
+}
+
+/* Skip the payload of a string of which the header is already consumed */
+static int _skip_str(nanocbor_value_t *cur, uint64_t len, int type,
+                     bool validate)
+{
+    if (len > (uint64_t)(cur->end - cur->cur)) {
+        return NANOCBOR_ERR_END;
+    }
+#if NANOCBOR_VALIDATE_UTF8
+    if (validate && type == NANOCBOR_TYPE_TSTR &&
+        !nanocbor_utf8_valid(cur->cur, (size_t)len)) {
+        return NANOCBOR_ERR_INVALID_UTF8;
+    }
+#else
+    (void)type;
+    (void)validate;
+#endif
+    cur->cur += len;
+    return NANOCBOR_OK;
+}
+
+/* Skip the chunks of an indefinite length string including the stop code */
+static int _skip_chunks(nanocbor_value_t *cur, int type, bool validate)
 {
-    if (limit == 0) {
-        return NANOCBOR_ERR_RECURSION;
+    while (!_over_end(cur) && *cur->cur != NANOCBOR_BREAK) {
+        uint64_t len = 0;
+        int res = _get_uint64(cur, &len, NANOCBOR_SIZE_LONG, type);
+
+        if (res < 0) {
+            return res;
+        }
+        cur->cur += res;
+        if ((res = _skip_str(cur, len, type, validate)) < 0) {
+            return res;
+        }
+    }
+    if (_over_end(cur)) {
+        return NANOCBOR_ERR_END;
     }
-    int type = nanocbor_get_type(it);
-    int res = type;
+    cur->cur++;
+    return NANOCBOR_OK;
+}
+
+/* Clearing this bit maps the single byte negative integers (0x20-0x37) on
+ * the single byte positive integers (0x00-0x17) */
+#define NANOCBOR_NINT_BIT   (NANOCBOR_MASK_NINT)
+#define NANOCBOR_SIMD_WIDTH (16U)
+
+#if defined(NANOCBOR_SKIP_SIMD_SSE2) || defined(NANOCBOR_SKIP_SIMD_NEON)
+/* Check whether the next 16 bytes are all single byte integers */
+static inline bool _simd_small_ints(const uint8_t *pos)
+{
+#if defined(NANOCBOR_SKIP_SIMD_SSE2)
+    __m128i bytes = _mm_loadu_si128((const __m128i *)(const void *)pos);
+    bytes = _mm_andnot_si128(_mm_set1_epi8((char)NANOCBOR_NINT_BIT), bytes);
+    /* bytes <= 0x17 when the unsigned minimum equals the bytes */
+    __m128i small = _mm_cmpeq_epi8(
+        _mm_min_epu8(bytes, _mm_set1_epi8(NANOCBOR_SIZE_BYTE - 1)), bytes);
+    return _mm_movemask_epi8(small) == 0xFFFF;
+#else
+    uint8x16_t bytes = vld1q_u8(pos);
+    bytes = vbicq_u8(bytes, vdupq_n_u8(NANOCBOR_NINT_BIT));
+    uint8x16_t small = vcleq_u8(bytes, vdupq_n_u8(NANOCBOR_SIZE_BYTE - 1));
+    return vminvq_u8(small) == UINT8_MAX;
+#endif
+}
+#endif
 
-    if (type == NANOCBOR_TYPE_BSTR || type == NANOCBOR_TYPE_TSTR) {
-        const uint8_t *tmp = NULL;
-        size_t len = 0;
-        res = _get_str(it, &tmp, &len, (uint8_t)type);
+/* Skip a run of integers and simple values inside a definite length
+ * container directly from the header bytes. Stops at the first other item
+ * or at a truncated item, these are left to the generic path */
+static void _skip_scalar_run(nanocbor_value_t *cur, uint32_t *remaining)
+{
+    const uint8_t *pos = cur->cur;
+    uint32_t left = *remaining;
+
+#if defined(NANOCBOR_SKIP_SIMD_SSE2) || defined(NANOCBOR_SKIP_SIMD_NEON)
+    while (left >= NANOCBOR_SIMD_WIDTH &&
+           (size_t)(cur->end - pos) >= NANOCBOR_SIMD_WIDTH &&
+           _simd_small_ints(pos)) {
+        pos += NANOCBOR_SIMD_WIDTH;
+        left -= NANOCBOR_SIMD_WIDTH;
+    }
+#endif
+    while (left > 0 && pos < cur->end) {
+        uint8_t type = *pos & NANOCBOR_TYPE_MASK;
+        uint8_t info = *pos & NANOCBOR_VALUE_MASK;
+        if ((type != NANOCBOR_MASK_UINT && type != NANOCBOR_MASK_NINT &&
+             type != NANOCBOR_MASK_FLOAT) || info > NANOCBOR_SIZE_LONG) {
+            break;
+        }
+        size_t len = info < NANOCBOR_SIZE_BYTE
+                     ? 1U : 1U + (1U << (info - NANOCBOR_SIZE_BYTE));
+        if (len > (size_t)(cur->end - pos)) {
+            break;
+        }
+        pos += len;
+        left--;
     }
-    /* map or array */
-    else if (type == NANOCBOR_TYPE_ARR || type == NANOCBOR_TYPE_MAP) {
-        nanocbor_value_t recurse;
-        res = (type == NANOCBOR_TYPE_MAP
-               ? nanocbor_enter_map(it, &recurse)
-               : nanocbor_enter_array(it, &recurse));
-        if (res == NANOCBOR_OK) {
-            while (!nanocbor_at_end(&recurse)) {
-                res = _skip_limited(&recurse, limit - 1);
-                if (res < 0) {
-                    break;
+    cur->cur = pos;
+    *remaining = left;
+}
+
+/* Skip a single item, tracking only the number of remaining items and the
+ * indefinite flag for every nesting level instead of recursing. Without
+ * @p validate, only the structure is checked and nothing is counted */
+static int _skip_iterative(nanocbor_value_t *it, bool validate)
+{
+    uint32_t remaining[NANOCBOR_RECURSION_MAX];
+    uint8_t indefinite[(NANOCBOR_RECURSION_MAX + 7U) / 8U] = { 0 };
+    unsigned depth = 0;
+    nanocbor_value_t cur = *it;
+
+    /* Out of the container context, only the buffer end limits the header
+     * decoding */
+    cur.flags = 0;
+
+    do {
+        if (depth > 0) {
+            unsigned level = depth - 1;
+            if (indefinite[level / 8U] & (1U << (level % 8U))) {
+                if (_over_end(&cur)) {
+                    return NANOCBOR_ERR_END;
+                }
+                if (*cur.cur == NANOCBOR_BREAK) {
+                    cur.cur++;
+                    depth--;
+                    continue;
                 }
             }
-            nanocbor_leave_container(it, &recurse);
+            else {
+#if NANOCBOR_STATS
+                uint32_t before = remaining[level];
+                _skip_scalar_run(&cur, &remaining[level]);
+                if (validate) {
+                    NANOCBOR_STATS_ADD(skipped, before - remaining[level]);
+                }
+#else
+                _skip_scalar_run(&cur, &remaining[level]);
+#endif
+                if (remaining[level] == 0) {
+                    depth--;
+                    continue;
+                }
+                remaining[level]--;
+            }
         }
+
+        uint64_t arg = 0;
+        bool indef = false;
+        int type = _skip_header(&cur, &arg, &indef);
+
+        if (type < 0) {
+            return type;
+        }
+        if (validate) {
+            NANOCBOR_STATS_ADD(skipped, 1);
+        }
+        if (type == NANOCBOR_TYPE_BSTR || type == NANOCBOR_TYPE_TSTR) {
+            int res = indef ? _skip_chunks(&cur, type, validate)
+                            : _skip_str(&cur, arg, type, validate);
+            if (res < 0) {
+                return res;
+            }
+        }
+        else if (type == NANOCBOR_TYPE_ARR || type == NANOCBOR_TYPE_MAP) {
+            if (depth == NANOCBOR_RECURSION_MAX) {
+                return NANOCBOR_ERR_RECURSION;
+            }
+            if (type == NANOCBOR_TYPE_MAP && !indef) {
+                if (arg > UINT32_MAX / 2) {
+                    return NANOCBOR_ERR_OVERFLOW;
+                }
+                arg *= 2;
+            }
+            if (arg > UINT32_MAX) {
+                return NANOCBOR_ERR_OVERFLOW;
+            }
+            uint8_t bit = (uint8_t)(1U << (depth % 8U));
+            if (indef) {
+                indefinite[depth / 8U] |= bit;
+            }
+            else {
+                indefinite[depth / 8U] &= (uint8_t)~bit;
+            }
+            remaining[depth++] = (uint32_t)arg;
+            if (validate) {
+                NANOCBOR_STATS_MAX(skip_depth, depth);
+            }
+        }
+    } while (depth > 0);
+
+    if (validate) {
+        NANOCBOR_STATS_ADD(skipped_bytes, cur.cur - it->cur);
     }
-    else if (type >= 0) {
-        res = _skip_simple(it);
-    }
-    return res < 0 ? res : NANOCBOR_OK;
+    _advance(it, (unsigned int)(cur.cur - it->cur));
+    return NANOCBOR_OK;
 }
 
 int nanocbor_skip(nanocbor_value_t *it)
 {
-    return _skip_limited(it, NANOCBOR_RECURSION_MAX);
+    int res = NANOCBOR_ERR_END;
+
+    if (!nanocbor_at_end(it)) {
+        res = _skip_iterative(it, true);
+    }
+    if (res < 0) {
+        NANOCBOR_TRACE(NANOCBOR_TRACE_SKIP_ERROR, it->cur, res);
+    }
+    return res;
+}
+
+int nanocbor_skip_structure(nanocbor_value_t *it)
+{
+    if (nanocbor_at_end(it)) {
+        return NANOCBOR_ERR_END;
+    }
+    return _skip_iterative(it, false);
 }
 
 int nanocbor_get_key_tstr(nanocbor_value_t *start, const char *key,
@@ -437,6 +914,7 @@ int nanocbor_get_key_tstr(nanocbor_value_t *start, const char *key,
         if ((res = nanocbor_get_tstr(value, &s, &s_len)) < 0) {
             break;
         }
+        NANOCBOR_STATS_ADD(key_probes, 1);
 
         if (s_len == len && !strncmp(key, (const char *)s, len)) {
             res = NANOCBOR_OK;
@@ -450,3 +928,227 @@ int nanocbor_get_key_tstr(nanocbor_value_t *start, const char *key,
 
     return res;
 }
+
+/* Decode an integer key, returns 0 when the key is not an int32_t and was
+ * skipped */
+static int _get_key_int(nanocbor_value_t *it, int32_t *key)
+{
+    int res = nanocbor_get_int32(it, key);
+
+    if (res == NANOCBOR_ERR_INVALID_TYPE || res == NANOCBOR_ERR_OVERFLOW) {
+        res = nanocbor_skip(it);
+        return res < 0 ? res : 0;
+    }
+    return res < 0 ? res : 1;
+}
+
+int nanocbor_get_keys_int(const nanocbor_value_t *start, const int32_t *keys,
+                          nanocbor_value_t *values, size_t num)
+{
+    nanocbor_value_t it = *start;
+    size_t found = 0;
+
+    for (size_t i = 0; i < num; i++) {
+        values[i].cur = NULL;
+    }
+
+    while (found < num && !nanocbor_at_end(&it)) {
+        int32_t key = 0;
+        int res = _get_key_int(&it, &key);
+
+        if (res < 0) {
+            return res;
+        }
+        NANOCBOR_STATS_ADD(key_probes, 1);
+        for (size_t i = 0; res > 0 && i < num; i++) {
+            /* Only the first occurrence of a key is used */
+            if (keys[i] == key && values[i].cur == NULL) {
+                values[i] = it;
+                found++;
+            }
+        }
+        if (found < num && (res = nanocbor_skip(&it)) < 0) {
+            return res;
+        }
+    }
+    /* Map truncated before all keys were seen */
+    if (found < num && nanocbor_in_container(&it) && nanocbor_needs_input(&it)) {
+        return NANOCBOR_ERR_END;
+    }
+    return (int)found;
+}
+
+int nanocbor_get_key_int(const nanocbor_value_t *start, int32_t key,
+                         nanocbor_value_t *value)
+{
+    int res = nanocbor_get_keys_int(start, &key, value, 1);
+
+    if (res < 0) {
+        return res;
+    }
+    return res == 1 ? NANOCBOR_OK : NANOCBOR_NOT_FOUND;
+}
+
+/* Decode the argument of an integer header with at most 32 bits directly
+ * from the buffer, returns the length of the item */
+static inline int _read_arg32(const uint8_t *cur, const uint8_t *end,
+                              uint32_t *arg)
+{
+    uint8_t info = *cur & NANOCBOR_VALUE_MASK;
+
+    if (info < NANOCBOR_SIZE_BYTE) {
+        *arg = info;
+        return 1;
+    }
+    if (info > NANOCBOR_SIZE_WORD) {
+        return NANOCBOR_ERR_OVERFLOW;
+    }
+    unsigned bytes = 1U << (info - NANOCBOR_SIZE_BYTE);
+    if (bytes >= (size_t)(end - cur)) {
+        return NANOCBOR_ERR_END;
+    }
+    uint32_t tmp = 0;
+    for (unsigned i = 1; i <= bytes; i++) {
+        tmp = (tmp << 8U) | cur[i];
+    }
+    *arg = tmp;
+    return (int)(1 + bytes);
+}
+
+static int _read_uint32_item(const uint8_t *cur, const uint8_t *end,
+                             void *out)
+{
+    if ((*cur & NANOCBOR_TYPE_MASK) != NANOCBOR_MASK_UINT) {
+        return NANOCBOR_ERR_INVALID_TYPE;
+    }
+    return _read_arg32(cur, end, out);
+}
+
+static int _read_int32_item(const uint8_t *cur, const uint8_t *end,
+                            void *out)
+{
+    uint8_t type = *cur & NANOCBOR_TYPE_MASK;
+    uint32_t arg = 0;
+
+    if (type != NANOCBOR_MASK_UINT && type != NANOCBOR_MASK_NINT) {
+        return NANOCBOR_ERR_INVALID_TYPE;
+    }
+    int res = _read_arg32(cur, end, &arg);
+    if (res > 0) {
+        if (arg > INT32_MAX) {
+            return NANOCBOR_ERR_OVERFLOW;
+        }
+        /* Negative integers are stored as -1 - arg, the one's complement */
+        uint32_t sign = (type == NANOCBOR_MASK_NINT) ? UINT32_MAX : 0;
+        int32_t num = (int32_t)(arg ^ sign);
+        memcpy(out, &num, sizeof(num));
+    }
+    return res;
+}
+
+static int _read_float_item(const uint8_t *cur, const uint8_t *end,
+                            void *out)
+{
+    float num = 0;
+    int res = NANOCBOR_ERR_INVALID_TYPE;
+
+    if (*cur == (NANOCBOR_MASK_FLOAT | NANOCBOR_SIZE_SHORT)) {
+        res = 1 + sizeof(uint16_t);
+    }
+    else if (*cur == (NANOCBOR_MASK_FLOAT | NANOCBOR_SIZE_WORD)) {
+        res = 1 + sizeof(uint32_t);
+    }
+    else if (*cur == (NANOCBOR_MASK_FLOAT | NANOCBOR_SIZE_LONG)) {
+        return NANOCBOR_ERR_OVERFLOW;
+    }
+    if (res < 0) {
+        return res;
+    }
+    if ((size_t)res > (size_t)(end - cur)) {
+        return NANOCBOR_ERR_END;
+    }
+    if (res == 1 + sizeof(uint16_t)) {
+        num = _half_to_float((uint16_t)((cur[1] << 8U) | cur[2]));
+    }
+    else {
+        num = _bits_to_float(((uint32_t)cur[1] << 24U) |
+                             ((uint32_t)cur[2] << 16U) |
+                             ((uint32_t)cur[3] << 8U) | cur[4]);
+    }
+    memcpy(out, &num, sizeof(num));
+    return res;
+}
+
+/* Decode the elements of an array with @p read, inlined into every typed
+ * variant to allow specializing the loop */
+static inline int _get_array(nanocbor_value_t *it, uint8_t *out, size_t size,
+                             size_t max, size_t *count,
+                             int (*read)(const uint8_t *cur,
+                                         const uint8_t *end, void *out))
+{
+    nanocbor_value_t arr;
+    int res = nanocbor_enter_array(it, &arr);
+
+    *count = 0;
+    if (res < 0) {
+        return res;
+    }
+    bool indefinite = nanocbor_container_indefinite(&arr);
+    size_t limit = (indefinite || arr.remaining > max) ? max : arr.remaining;
+    const uint8_t *cur = arr.cur;
+    size_t num = 0;
+
+    for (; num < limit; num++) {
+        if (cur >= arr.end) {
+            res = NANOCBOR_ERR_END;
+            break;
+        }
+        if (indefinite && *cur == NANOCBOR_BREAK) {
+            break;
+        }
+        res = read(cur, arr.end, out + num * size);
+        if (res < 0) {
+            break;
+        }
+        cur += res;
+    }
+    *count = num;
+    if (res < 0) {
+        return res;
+    }
+    if (indefinite) {
+        if (cur >= arr.end) {
+            return NANOCBOR_ERR_END;
+        }
+        if (*cur != NANOCBOR_BREAK) {
+            return NANOCBOR_ERR_OVERFLOW;
+        }
+        cur++;
+    }
+    else if (num < arr.remaining) {
+        return NANOCBOR_ERR_OVERFLOW;
+    }
+    _advance(it, (unsigned)(cur - it->cur));
+    return NANOCBOR_OK;
+}
+
+int nanocbor_get_uint32_array(nanocbor_value_t *it, uint32_t *out, size_t max,
+                              size_t *count)
+{
+    return _get_array(it, (uint8_t *)out, sizeof(*out), max, count,
+                      _read_uint32_item);
+}
+
+int nanocbor_get_int32_array(nanocbor_value_t *it, int32_t *out, size_t max,
+                             size_t *count)
+{
+    return _get_array(it, (uint8_t *)out, sizeof(*out), max, count,
+                      _read_int32_item);
+}
+
+int nanocbor_get_float_array(nanocbor_value_t *it, float *out, size_t max,
+                             size_t *count)
+{
+    return _get_array(it, (uint8_t *)out, sizeof(*out), max, count,
+                      _read_float_item);
+}
@@ -0,0 +1,399 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @ingroup nanocbor_dom
+ * @{
+ * @file
+ * @brief   Document tree implementation
+ * @}
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nanocbor/config.h"
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/dom.h"
+
+/* Container or tag of which the children are being decoded */
+typedef struct {
+    nanocbor_value_t it;    /* Decoder positioned at the next child */
+    nanocbor_dom_node_t *node;  /* Node of the container itself */
+    uint32_t next;          /* Node of the next child */
+    uint32_t end;           /* Node after the last child */
+    bool container;         /* Entered with nanocbor_enter_array/map */
+    bool indefinite;        /* Children are collected on the stack */
+} _frame_t;
+
+/*
+ * Nodes are allocated from the start of the array. The number of children
+ * of an indefinite length container is only known at the break; until
+ * then its children are collected on a stack growing down from the end of
+ * the array and moved in place when the container is complete. Nested
+ * indefinite containers are completed first, so their children are always
+ * on top of the stack.
+ */
+
+void nanocbor_dom_init(nanocbor_dom_t *dom, nanocbor_dom_node_t *nodes,
+                       size_t size)
+{
+    dom->nodes = nodes;
+    dom->size = size > UINT32_MAX ? UINT32_MAX : size;
+    dom->used = 0;
+}
+
+/* Allocate @p num nodes below the stack starting at @p top */
+static int _alloc(nanocbor_dom_t *dom, size_t num, size_t top,
+                  uint32_t *first)
+{
+    if (num > top - dom->used) {
+        return NANOCBOR_ERR_OVERFLOW;
+    }
+    *first = (uint32_t)dom->used;
+    dom->used += num;
+    return NANOCBOR_OK;
+}
+
+/* Argument of the header at the current position */
+static uint64_t _arg(const nanocbor_value_t *it)
+{
+    uint8_t info = *it->cur & NANOCBOR_VALUE_MASK;
+    uint64_t num = info;
+
+    if (info >= NANOCBOR_SIZE_BYTE) {
+        num = 0;
+        for (unsigned i = 1; i <= 1U << (info - NANOCBOR_SIZE_BYTE); i++) {
+            num = (num << 8U) | it->cur[i];
+        }
+    }
+    return num;
+}
+
+/* Decode a scalar item into a node */
+static int _scalar(nanocbor_value_t *it, nanocbor_dom_node_t *node, int type)
+{
+    nanocbor_value_t start = *it;
+    uint8_t info = *it->cur & NANOCBOR_VALUE_MASK;
+    int res = NANOCBOR_ERR_INVALID_TYPE;
+
+    node->len = 0;
+    node->child = 0;
+    switch (type) {
+        case NANOCBOR_TYPE_UINT:
+            res = nanocbor_get_uint64(it, &node->v.num);
+            break;
+        case NANOCBOR_TYPE_BSTR:
+            res = nanocbor_get_bstr(it, &node->v.str, &node->len);
+            break;
+        case NANOCBOR_TYPE_TSTR:
+            res = nanocbor_get_tstr(it, &node->v.str, &node->len);
+            break;
+        default:
+            if (type == NANOCBOR_TYPE_FLOAT && info >= NANOCBOR_SIZE_SHORT &&
+                info <= NANOCBOR_SIZE_LONG) {
+                res = nanocbor_get_double(it, &node->v.fp);
+                break;
+            }
+            /* Negative integer or simple value, the skip checks that the
+             * complete argument is in the buffer */
+            res = nanocbor_skip_simple(it);
+            if (res >= 0) {
+                node->v.num = _arg(&start);
+            }
+            if (type == NANOCBOR_TYPE_FLOAT) {
+                type = NANOCBOR_DOM_SIMPLE;
+            }
+            break;
+    }
+    node->type = (uint8_t)type;
+    return res < 0 ? res : NANOCBOR_OK;
+}
+
+/* Enter a container or tag, filling in the node and the child frame */
+static int _enter(nanocbor_dom_t *dom, nanocbor_value_t *it,
+                  nanocbor_dom_node_t *node, int type, _frame_t *frame,
+                  size_t top)
+{
+    size_t num = 1;
+    int res = NANOCBOR_OK;
+
+    frame->node = node;
+    frame->indefinite = false;
+    if (type == NANOCBOR_TYPE_TAG) {
+        uint8_t info = *it->cur & NANOCBOR_VALUE_MASK;
+        size_t hdr = 1;
+        if (info > NANOCBOR_SIZE_LONG) {
+            return NANOCBOR_ERR_INVALID_TYPE;
+        }
+        if (info >= NANOCBOR_SIZE_BYTE) {
+            hdr += 1U << (info - NANOCBOR_SIZE_BYTE);
+        }
+        if (hdr > nanocbor_decoder_pending(it)) {
+            return NANOCBOR_ERR_END;
+        }
+        node->v.num = _arg(it);
+        it->cur += hdr;
+        frame->it = *it;
+        frame->container = false;
+    }
+    else {
+        res = (type == NANOCBOR_TYPE_ARR) ? nanocbor_enter_array(it, &frame->it)
+                                          : nanocbor_enter_map(it, &frame->it);
+        if (res < 0) {
+            return res;
+        }
+        frame->container = true;
+        if (nanocbor_container_indefinite(&frame->it)) {
+            /* Children are counted and placed at the break */
+            frame->indefinite = true;
+            frame->end = (uint32_t)top;
+            node->type = (uint8_t)type;
+            return NANOCBOR_OK;
+        }
+        num = nanocbor_container_remaining(&frame->it);
+        /* Every item takes at least a byte */
+        if (num > nanocbor_decoder_pending(&frame->it)) {
+            return NANOCBOR_ERR_END;
+        }
+    }
+    if (res < 0) {
+        return res;
+    }
+    res = _alloc(dom, num, top, &frame->next);
+    if (res < 0) {
+        return res;
+    }
+    frame->end = frame->next + (uint32_t)num;
+    node->type = (uint8_t)type;
+    node->len = num;
+    node->child = frame->next;
+    return NANOCBOR_OK;
+}
+
+/* Move the children of a complete indefinite length container from the
+ * stack in place, the stack holds them in reverse order */
+static int _close(nanocbor_dom_t *dom, _frame_t *frame, size_t *top)
+{
+    nanocbor_dom_node_t *nodes = dom->nodes;
+    size_t num = frame->end - *top;
+
+    if (nanocbor_needs_input(&frame->it)) {
+        return NANOCBOR_ERR_END;
+    }
+    /* A break in place of a value */
+    if (frame->node->type == NANOCBOR_TYPE_MAP && (num & 1U)) {
+        return NANOCBOR_ERR_INVALID_TYPE;
+    }
+    for (size_t i = *top, j = frame->end; i + 1 < j; i++, j--) {
+        nanocbor_dom_node_t tmp = nodes[i];
+        nodes[i] = nodes[j - 1];
+        nodes[j - 1] = tmp;
+    }
+    /* Fits, the stack is above the nodes in use */
+    memmove(&nodes[dom->used], &nodes[*top], num * sizeof(nodes[0]));
+    frame->node->len = num;
+    frame->node->child = (uint32_t)dom->used;
+    dom->used += num;
+    *top = frame->end;
+    return NANOCBOR_OK;
+}
+
+int nanocbor_dom_build(nanocbor_dom_t *dom, nanocbor_value_t *it,
+                       size_t *root)
+{
+    _frame_t frames[NANOCBOR_RECURSION_MAX + 1];
+    size_t depth = 0;
+    size_t used = dom->used;
+    size_t top = dom->size;
+
+    frames[0].it = *it;
+    frames[0].container = false;
+    frames[0].indefinite = false;
+    int res = _alloc(dom, 1, top, &frames[0].next);
+    if (res < 0) {
+        return res;
+    }
+    frames[0].end = frames[0].next + 1;
+    *root = frames[0].next;
+
+    while (true) {
+        _frame_t *frame = &frames[depth];
+        nanocbor_dom_node_t *node = NULL;
+
+        if (frame->indefinite ? nanocbor_at_end(&frame->it)
+                              : frame->next == frame->end) {
+            if (depth == 0) {
+                break;
+            }
+            if (frame->indefinite && (res = _close(dom, frame, &top)) < 0) {
+                break;
+            }
+            _frame_t *parent = &frames[--depth];
+            if (frame->container) {
+                nanocbor_leave_container(&parent->it, &frame->it);
+            }
+            else {
+                parent->it = frame->it;
+            }
+            continue;
+        }
+
+        if (!frame->indefinite) {
+            node = &dom->nodes[frame->next++];
+        }
+        else if (top > dom->used) {
+            node = &dom->nodes[--top];
+        }
+        else {
+            res = NANOCBOR_ERR_OVERFLOW;
+            break;
+        }
+        int type = nanocbor_get_type(&frame->it);
+        if (type < 0) {
+            res = type;
+        }
+        else if (type == NANOCBOR_TYPE_ARR || type == NANOCBOR_TYPE_MAP ||
+                 type == NANOCBOR_TYPE_TAG) {
+            if (depth == NANOCBOR_RECURSION_MAX) {
+                res = NANOCBOR_ERR_RECURSION;
+            }
+            else {
+                res = _enter(dom, &frame->it, node, type, &frames[depth + 1],
+                             top);
+                depth += (res == NANOCBOR_OK);
+            }
+        }
+        else {
+            res = _scalar(&frame->it, node, type);
+        }
+        if (res < 0) {
+            break;
+        }
+    }
+    if (res < 0) {
+        /* Release the nodes of the partially decoded item */
+        dom->used = used;
+        return res;
+    }
+    *it = frames[0].it;
+    return NANOCBOR_OK;
+}
+
+static const nanocbor_dom_node_t *_map_get(const nanocbor_dom_t *dom,
+                                           const nanocbor_dom_node_t *map,
+                                           const nanocbor_dom_node_t *key)
+{
+    if (map->type != NANOCBOR_TYPE_MAP) {
+        return NULL;
+    }
+    for (size_t i = 0; i + 1 < map->len; i += 2) {
+        const nanocbor_dom_node_t *cur = &dom->nodes[map->child + i];
+        if (cur->type != key->type) {
+            continue;
+        }
+        if (key->type == NANOCBOR_TYPE_TSTR ?
+                (cur->len == key->len &&
+                 memcmp(cur->v.str, key->v.str, cur->len) == 0) :
+                cur->v.num == key->v.num) {
+            return cur + 1;
+        }
+    }
+    return NULL;
+}
+
+const nanocbor_dom_node_t *nanocbor_dom_map_get_tstr(const nanocbor_dom_t *dom,
+                                                     const nanocbor_dom_node_t *map,
+                                                     const char *key)
+{
+    nanocbor_dom_node_t node;
+
+    node.type = NANOCBOR_TYPE_TSTR;
+    node.v.str = (const uint8_t *)key;
+    node.len = strlen(key);
+    return _map_get(dom, map, &node);
+}
+
+const nanocbor_dom_node_t *nanocbor_dom_map_get_int(const nanocbor_dom_t *dom,
+                                                    const nanocbor_dom_node_t *map,
+                                                    int64_t key)
+{
+    nanocbor_dom_node_t node;
+
+    /* Negative keys as their argument, -1 - key */
+    uint64_t sign = 0U - ((uint64_t)key >> 63U);
+    node.type = sign ? NANOCBOR_TYPE_NINT : NANOCBOR_TYPE_UINT;
+    node.v.num = (uint64_t)key ^ sign;
+    return _map_get(dom, map, &node);
+}
+
+/* Write the node itself, without its children */
+static int _encode_node(const nanocbor_dom_node_t *node,
+                        nanocbor_encoder_t *enc)
+{
+    switch (node->type) {
+        case NANOCBOR_TYPE_UINT:
+            return nanocbor_fmt_uint(enc, node->v.num);
+        case NANOCBOR_TYPE_NINT:
+            if (node->v.num > INT64_MAX) {
+                return NANOCBOR_ERR_OVERFLOW;
+            }
+            return nanocbor_fmt_int(enc, -1 - (int64_t)node->v.num);
+        case NANOCBOR_TYPE_BSTR:
+            return nanocbor_put_bstr(enc, node->v.str, node->len);
+        case NANOCBOR_TYPE_TSTR:
+            return nanocbor_put_tstrn(enc, (const char *)node->v.str,
+                                      node->len);
+        case NANOCBOR_TYPE_ARR:
+            return nanocbor_fmt_array(enc, node->len);
+        case NANOCBOR_TYPE_MAP:
+            return nanocbor_fmt_map(enc, node->len / 2);
+        case NANOCBOR_TYPE_TAG:
+            return nanocbor_fmt_tag(enc, node->v.num);
+        case NANOCBOR_TYPE_FLOAT:
+            return nanocbor_fmt_double(enc, node->v.fp);
+        default:
+            break;
+    }
+    return nanocbor_fmt_simple(enc, (uint8_t)node->v.num);
+}
+
+int nanocbor_dom_encode(const nanocbor_dom_t *dom, size_t node,
+                        nanocbor_encoder_t *enc)
+{
+    struct {
+        size_t next;
+        size_t end;
+    } frames[NANOCBOR_RECURSION_MAX + 1];
+    size_t depth = 0;
+
+    frames[0].next = node;
+    frames[0].end = node + 1;
+    while (true) {
+        if (frames[depth].next == frames[depth].end) {
+            if (depth == 0) {
+                break;
+            }
+            depth--;
+            continue;
+        }
+        const nanocbor_dom_node_t *cur = &dom->nodes[frames[depth].next++];
+        int res = _encode_node(cur, enc);
+        if (res < 0) {
+            return res;
+        }
+        if (nanocbor_dom_child(dom, cur, 0)) {
+            if (depth == NANOCBOR_RECURSION_MAX) {
+                return NANOCBOR_ERR_RECURSION;
+            }
+            depth++;
+            frames[depth].next = cur->child;
+            frames[depth].end = cur->child + cur->len;
+        }
+    }
+    return NANOCBOR_OK;
+}
@@ -12,6 +12,7 @@
  * @}
  */
 
+#include <limits.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -19,14 +20,25 @@
 
 #include "nanocbor/config.h"
 #include "nanocbor/nanocbor.h"
+#include "nanocbor/stats.h"
 
 #include NANOCBOR_BYTEORDER_HEADER
 
 void nanocbor_encoder_init(nanocbor_encoder_t *enc, uint8_t *buf, size_t len)
+{
+    nanocbor_encoder_sink_init(enc, buf, len, NULL, NULL);
+}
+
+void nanocbor_encoder_sink_init(nanocbor_encoder_t *enc,
+                                uint8_t *buf, size_t len,
+                                nanocbor_encoder_sink_t sink, void *ctx)
 {
     enc->len = 0;
     enc->cur = buf;
     enc->end = buf + len;
+    enc->sink = sink;
+    enc->ctx = ctx;
+    enc->deferred = NULL;
 }
 
 size_t nanocbor_encoded_len(nanocbor_encoder_t *enc)
@@ -34,11 +46,65 @@ size_t nanocbor_encoded_len(nanocbor_encoder_t *enc)
     return enc->len;
 }
 
+size_t nanocbor_encoder_remaining(const nanocbor_encoder_t *enc)
+{
+    return (size_t)(enc->end - enc->cur);
+}
+
+void nanocbor_encoder_save(const nanocbor_encoder_t *enc,
+                           nanocbor_encoder_checkpoint_t *cp)
+{
+    cp->cur = enc->cur;
+    cp->len = enc->len;
+}
+
+void nanocbor_encoder_restore(nanocbor_encoder_t *enc,
+                              const nanocbor_encoder_checkpoint_t *cp)
+{
+    enc->cur = cp->cur;
+    enc->len = cp->len;
+
+    /* Drop the deferred containers started after the checkpoint */
+    nanocbor_deferred_t *deferred = enc->deferred;
+    while (deferred && deferred->hdr >= enc->cur) {
+        deferred->hdr = NULL;
+        deferred = deferred->parent;
+    }
+    enc->deferred = deferred;
+    /* Count the rolled back container again from the start */
+    if (deferred && deferred->scan > enc->cur) {
+        deferred->scan = deferred->hdr + NANOCBOR_DEFERRED_HDR_LEN;
+        deferred->need = 0;
+        deferred->payload = 0;
+        deferred->indefinite = 0;
+        deferred->items = 0;
+    }
+}
+
+static inline bool _space(const nanocbor_encoder_t *enc, size_t len)
+{
+    return (size_t)(enc->end - enc->cur) >= len;
+}
+
 static int _fits(nanocbor_encoder_t *enc, size_t len)
 {
     enc->len += len;
-    return ((size_t)(enc->end - enc->cur) >= len) ? (int)len :
-        NANOCBOR_ERR_END;
+    if (_space(enc, len)) {
+        return (int)len;
+    }
+    /* Slow path, ask the sink for more space */
+    if (enc->sink) {
+        NANOCBOR_STATS_ADD(sink_calls, 1);
+        if (enc->sink(enc, enc->ctx, len) == NANOCBOR_OK && _space(enc, len)) {
+            return (int)len;
+        }
+    }
+    /* A NULL buffer only determines the encoded size and is never full */
+    if (enc->end) {
+        NANOCBOR_STATS_ADD(encode_full, 1);
+        NANOCBOR_TRACE(NANOCBOR_TRACE_ENCODE_FULL, enc->cur, NANOCBOR_ERR_END);
+    }
+    return NANOCBOR_ERR_END;
 }
 
 static int _fmt_single(nanocbor_encoder_t *enc, uint8_t single)
@@ -59,47 +125,140 @@ int nanocbor_fmt_bool(nanocbor_encoder_t *enc, bool content)
     return _fmt_single(enc, single);
 }
 
-static int _fmt_uint64(nanocbor_encoder_t *enc, uint64_t num, uint8_t type)
+/*
+ * Header emission
+ *
+ * The argument of a header falls in one of five width classes: immediate,
+ * or followed by 1, 2, 4 or 8 bytes. The class is found from the number of
+ * significant bits and each class is written with fixed size stores.
+ */
+#define WIDTH_IMMEDIATE     (0U)
+#define WIDTH_LONG          (4U)
+
+/* Extra bytes following the initial byte for a width class */
+#define WIDTH_EXTRA(width)  ((1U << (width)) >> 1U)
+
+#ifdef NANOCBOR_CLZ64_FUNC
+/* Width class by the number of significant bits */
+static const uint8_t _width_class[65] = {
+    1, 1, 1, 1, 1, 1, 1, 1, 1,
+    2, 2, 2, 2, 2, 2, 2, 2,
+    3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3, 3,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+};
+#endif
+
+static inline unsigned _width64(uint64_t num)
 {
-    unsigned extrabytes = 0;
+#ifdef NANOCBOR_CLZ64_FUNC
+    /* NOLINTNEXTLINE: user supplied function */
+    unsigned width = _width_class[64U - (unsigned)NANOCBOR_CLZ64_FUNC(num | 1U)];
+#else
+    unsigned width = 1U + (num > UINT8_MAX) + (num > UINT16_MAX) +
+                     (num > UINT32_MAX);
+#endif
+    return num < NANOCBOR_SIZE_BYTE ? WIDTH_IMMEDIATE : width;
+}
 
-    if (num < NANOCBOR_SIZE_BYTE) {
-        type |= num;
-    }
-    else {
-        if (num > UINT32_MAX) {
-            /* Requires long size */
-            type |= NANOCBOR_SIZE_LONG;
-            extrabytes = sizeof(uint64_t);
-        }
-        else if (num > UINT16_MAX) {
-            /* At least word size */
-            type |= NANOCBOR_SIZE_WORD;
-            extrabytes = sizeof(uint32_t);
-        }
-        else if (num > UINT8_MAX) {
-            type |= NANOCBOR_SIZE_SHORT;
-            extrabytes = sizeof(uint16_t);
-        }
-        else {
-            type |= NANOCBOR_SIZE_BYTE;
-            extrabytes = sizeof(uint8_t);
+static inline unsigned _width32(uint32_t num)
+{
+    return _width64(num);
+}
+
+/* Write a header with a 32 bit argument, returns the bytes written */
+static inline size_t _put_arg32(uint8_t *dst, uint32_t num, uint8_t type,
+                                unsigned width)
+{
+    switch (width) {
+        case WIDTH_IMMEDIATE:
+            dst[0] = type | (uint8_t)num;
+            return 1;
+        case 1:
+            dst[0] = type | NANOCBOR_SIZE_BYTE;
+            dst[1] = (uint8_t)num;
+            return 2;
+        case 2:
+            dst[0] = type | NANOCBOR_SIZE_SHORT;
+            dst[1] = (uint8_t)(num >> 8U);
+            dst[2] = (uint8_t)num;
+            return 3;
+        default: {
+            /* NOLINTNEXTLINE: user supplied function */
+            uint32_t be = NANOCBOR_HTOBE32_FUNC(num);
+            dst[0] = type | NANOCBOR_SIZE_WORD;
+            memcpy(dst + 1, &be, sizeof(be));
+            return 1 + sizeof(be);
         }
     }
-    int res = _fits(enc, extrabytes + 1);
-    if (res > 0) {
-        *enc->cur++ = type;
+}
 
+/* Write a header with a 64 bit argument, returns the bytes written */
+static inline size_t _put_arg64(uint8_t *dst, uint64_t num, uint8_t type,
+                                unsigned width)
+{
+    if (width == WIDTH_LONG) {
         /* NOLINTNEXTLINE: user supplied function */
-        uint64_t benum = NANOCBOR_HTOBE64_FUNC(num);
+        uint64_t be = NANOCBOR_HTOBE64_FUNC(num);
+        dst[0] = type | NANOCBOR_SIZE_LONG;
+        memcpy(dst + 1, &be, sizeof(be));
+        return 1 + sizeof(be);
+    }
+    return _put_arg32(dst, (uint32_t)num, type, width);
+}
 
-        memcpy(enc->cur, (uint8_t *)&benum + sizeof(benum) - extrabytes,
-               extrabytes);
-        enc->cur += extrabytes;
+static inline size_t _uint32_size(uint32_t num)
+{
+    return 1U + WIDTH_EXTRA(_width32(num));
+}
+
+static inline size_t _put_uint32(uint8_t *dst, uint32_t num, uint8_t type)
+{
+    return _put_arg32(dst, num, type, _width32(num));
+}
+
+static int _fmt_uint64(nanocbor_encoder_t *enc, uint64_t num, uint8_t type)
+{
+    unsigned width = _width64(num);
+    int res = _fits(enc, 1U + WIDTH_EXTRA(width));
+
+    if (res > 0) {
+        enc->cur += _put_arg64(enc->cur, num, type, width);
+    }
+    return res;
+}
+
+static inline int _fmt_uint32(nanocbor_encoder_t *enc, uint32_t num, uint8_t type)
+{
+    unsigned width = _width32(num);
+    int res = _fits(enc, 1U + WIDTH_EXTRA(width));
+
+    if (res > 0) {
+        enc->cur += _put_arg32(enc->cur, num, type, width);
     }
     return res;
 }
 
+/* Length headers only need the 64 bit variant with a 64 bit size_t */
+static inline int _fmt_size(nanocbor_encoder_t *enc, size_t len, uint8_t type)
+{
+#if NANOCBOR_SIZE_SIZET == NANOCBOR_SIZE_LONG
+    return _fmt_uint64(enc, (uint64_t)len, type);
+#else
+    return _fmt_uint32(enc, (uint32_t)len, type);
+#endif
+}
+
+/* Split a signed integer in the CBOR argument and major type without
+ * branching on the sign */
+static inline uint32_t _int32_arg(int32_t num, uint8_t *type)
+{
+    uint32_t sign = 0U - ((uint32_t)num >> 31);
+
+    *type = (uint8_t)(sign & NANOCBOR_MASK_NINT);
+    return (uint32_t)num ^ sign;
+}
+
 int nanocbor_fmt_uint(nanocbor_encoder_t *enc, uint64_t num)
 {
     return _fmt_uint64(enc, num, NANOCBOR_MASK_UINT);
@@ -112,22 +271,31 @@ int nanocbor_fmt_tag(nanocbor_encoder_t *enc, uint64_t num)
 
 int nanocbor_fmt_int(nanocbor_encoder_t *enc, int64_t num)
 {
-    if (num < 0) {
-        /* Always negative at this point */
-        num = -(num + 1);
-        return _fmt_uint64(enc, (uint64_t)num, NANOCBOR_MASK_NINT);
-    }
-    return nanocbor_fmt_uint(enc, (uint64_t)num);
+    /* -1 - num for negative numbers, without branching on the sign */
+    uint64_t sign = 0U - ((uint64_t)num >> 63U);
+
+    return _fmt_uint64(enc, (uint64_t)num ^ sign,
+                       (uint8_t)(sign & NANOCBOR_MASK_NINT));
 }
 
 int nanocbor_fmt_bstr(nanocbor_encoder_t *enc, size_t len)
 {
-    return _fmt_uint64(enc, (uint64_t)len, NANOCBOR_MASK_BSTR);
+    return _fmt_size(enc, len, NANOCBOR_MASK_BSTR);
 }
 
 int nanocbor_fmt_tstr(nanocbor_encoder_t *enc, size_t len)
 {
-    return _fmt_uint64(enc, (uint64_t)len, NANOCBOR_MASK_TSTR);
+    return _fmt_size(enc, len, NANOCBOR_MASK_TSTR);
+}
+
+int nanocbor_fmt_bstr_indefinite(nanocbor_encoder_t *enc)
+{
+    return _fmt_single(enc, NANOCBOR_MASK_BSTR | NANOCBOR_SIZE_INDEFINITE);
+}
+
+int nanocbor_fmt_tstr_indefinite(nanocbor_encoder_t *enc)
+{
+    return _fmt_single(enc, NANOCBOR_MASK_TSTR | NANOCBOR_SIZE_INDEFINITE);
 }
 
 static int _put_bytes(nanocbor_encoder_t *enc, const uint8_t *str, size_t len)
@@ -162,14 +330,19 @@ int nanocbor_put_bstr(nanocbor_encoder_t *enc, const uint8_t *str, size_t len)
     return _put_bytes(enc, str, len);
 }
 
+int nanocbor_put_raw(nanocbor_encoder_t *enc, const uint8_t *buf, size_t len)
+{
+    return _put_bytes(enc, buf, len);
+}
+
 int nanocbor_fmt_array(nanocbor_encoder_t *enc, size_t len)
 {
-    return _fmt_uint64(enc, (uint64_t)len, NANOCBOR_MASK_ARR);
+    return _fmt_size(enc, len, NANOCBOR_MASK_ARR);
 }
 
 int nanocbor_fmt_map(nanocbor_encoder_t *enc, size_t len)
 {
-    return _fmt_uint64(enc, (uint64_t)len, NANOCBOR_MASK_MAP);
+    return _fmt_size(enc, len, NANOCBOR_MASK_MAP);
 }
 
 int nanocbor_fmt_array_indefinite(nanocbor_encoder_t *enc)
@@ -188,6 +361,15 @@ int nanocbor_fmt_end_indefinite(nanocbor_encoder_t *enc)
     return _fmt_single(enc, NANOCBOR_MASK_FLOAT | NANOCBOR_SIZE_INDEFINITE);
 }
 
+int nanocbor_fmt_simple(nanocbor_encoder_t *enc, uint8_t value)
+{
+    /* Values 24 to 31 are reserved */
+    if (value >= NANOCBOR_SIZE_BYTE && value < 32U) {
+        return NANOCBOR_ERR_INVALID_TYPE;
+    }
+    return _fmt_uint32(enc, value, NANOCBOR_MASK_FLOAT);
+}
+
 int nanocbor_fmt_null(nanocbor_encoder_t *enc)
 {
     return _fmt_single(enc, NANOCBOR_MASK_FLOAT | NANOCBOR_SIMPLE_NULL);
@@ -285,25 +467,35 @@ static bool _double_in_range(uint16_t exp, uint64_t num)
     return false;
 }
 
-int nanocbor_fmt_float(nanocbor_encoder_t *enc, float num)
+/* Convert a single to a half precision float if that is lossless */
+static bool _single_to_half(uint32_t unum, uint16_t *half)
 {
-    /* Allow bitwise access to float */
-    uint32_t *unum = (uint32_t *)&num;
-
     /* Retrieve exponent */
-    uint8_t exp = (*unum >> FLOAT_EXP_POS) & FLOAT_EXP_MASK;
+    uint8_t exp = (unum >> FLOAT_EXP_POS) & FLOAT_EXP_MASK;
     if (_single_is_inf_nan(exp) ||
-            _single_is_zero(*unum) ||
-            _single_in_range(exp, *unum)) {
+            _single_is_zero(unum) ||
+            _single_in_range(exp, unum)) {
         /* Copy sign bit */
-        uint16_t half = ((*unum >> (FLOAT_SIZE - HALF_SIZE)) & HALF_SIGN_MASK);
+        *half = ((unum >> (FLOAT_SIZE - HALF_SIZE)) & HALF_SIGN_MASK);
         /* Shift exponent */
         if (exp != FLOAT_EXP_IS_NAN && exp != 0) {
             exp = exp + (uint8_t)(HALF_EXP_OFFSET - FLOAT_EXP_OFFSET);
         }
         /* Add exponent */
-        half |= ((exp & HALF_EXP_MASK) << HALF_EXP_POS) |
-                ((*unum >> (FLOAT_EXP_POS - HALF_EXP_POS)) & HALF_FRAC_MASK);
+        *half |= ((exp & HALF_EXP_MASK) << HALF_EXP_POS) |
+                 ((unum >> (FLOAT_EXP_POS - HALF_EXP_POS)) & HALF_FRAC_MASK);
+        return true;
+    }
+    return false;
+}
+
+int nanocbor_fmt_float(nanocbor_encoder_t *enc, float num)
+{
+    /* Allow bitwise access to float */
+    uint32_t *unum = (uint32_t *)&num;
+    uint16_t half;
+
+    if (_single_to_half(*unum, &half)) {
         return _fmt_halffloat(enc, half);
     }
     /* normal float */
@@ -355,3 +547,303 @@ int nanocbor_fmt_decimal_frac(nanocbor_encoder_t *enc, int32_t e, int32_t m)
     res += nanocbor_fmt_int(enc, m);
     return res;
 }
+
+/* Largest item in a batch array, a 32 bit integer or a single float */
+#define ARRAY_ITEM_MAX      (1U + sizeof(uint32_t))
+/* Maximum number of items, keeps the encoded length within an int */
+#define ARRAY_LEN_MAX       ((INT_MAX - ARRAY_ITEM_MAX) / ARRAY_ITEM_MAX)
+
+/* Reserve space for an array of @p num items of @p body bytes in total and
+ * write the array header */
+static int _reserve_array(nanocbor_encoder_t *enc, size_t num, size_t body)
+{
+    size_t hdr = _uint32_size((uint32_t)num);
+    int res = _fits(enc, hdr + body);
+
+    if (res > 0) {
+        enc->cur += _put_uint32(enc->cur, (uint32_t)num, NANOCBOR_MASK_ARR);
+    }
+    return res;
+}
+
+int nanocbor_fmt_uint_array(nanocbor_encoder_t *enc, const uint32_t *nums,
+                            size_t num)
+{
+    size_t body = 0;
+
+    if (num > ARRAY_LEN_MAX) {
+        return NANOCBOR_ERR_OVERFLOW;
+    }
+    for (size_t i = 0; i < num; i++) {
+        body += _uint32_size(nums[i]);
+    }
+    int res = _reserve_array(enc, num, body);
+    if (res > 0) {
+        uint8_t *cur = enc->cur;
+        for (size_t i = 0; i < num; i++) {
+            cur += _put_uint32(cur, nums[i], NANOCBOR_MASK_UINT);
+        }
+        enc->cur = cur;
+    }
+    return res;
+}
+
+int nanocbor_fmt_int_array(nanocbor_encoder_t *enc, const int32_t *nums,
+                           size_t num)
+{
+    size_t body = 0;
+    uint8_t type;
+
+    if (num > ARRAY_LEN_MAX) {
+        return NANOCBOR_ERR_OVERFLOW;
+    }
+    for (size_t i = 0; i < num; i++) {
+        body += _uint32_size(_int32_arg(nums[i], &type));
+    }
+    int res = _reserve_array(enc, num, body);
+    if (res > 0) {
+        uint8_t *cur = enc->cur;
+        for (size_t i = 0; i < num; i++) {
+            uint32_t arg = _int32_arg(nums[i], &type);
+            cur += _put_uint32(cur, arg, type);
+        }
+        enc->cur = cur;
+    }
+    return res;
+}
+
+int nanocbor_fmt_float_array(nanocbor_encoder_t *enc, const float *nums,
+                             size_t num)
+{
+    size_t body = 0;
+    uint16_t half;
+
+    if (num > ARRAY_LEN_MAX) {
+        return NANOCBOR_ERR_OVERFLOW;
+    }
+    for (size_t i = 0; i < num; i++) {
+        uint32_t unum;
+        memcpy(&unum, &nums[i], sizeof(unum));
+        body += _single_to_half(unum, &half) ? 1U + sizeof(uint16_t)
+                                             : 1U + sizeof(uint32_t);
+    }
+    int res = _reserve_array(enc, num, body);
+    if (res > 0) {
+        uint8_t *cur = enc->cur;
+        for (size_t i = 0; i < num; i++) {
+            uint32_t unum;
+            memcpy(&unum, &nums[i], sizeof(unum));
+            if (_single_to_half(unum, &half)) {
+                *cur++ = NANOCBOR_MASK_FLOAT | NANOCBOR_SIZE_SHORT;
+                *cur++ = (uint8_t)(half >> HALF_SIZE/2);
+                *cur++ = (uint8_t)(half & HALF_MASK_HALF);
+            }
+            else {
+                *cur++ = NANOCBOR_MASK_FLOAT | NANOCBOR_SIZE_WORD;
+                *cur++ = (uint8_t)(unum >> 24);
+                *cur++ = (uint8_t)(unum >> 16);
+                *cur++ = (uint8_t)(unum >> 8);
+                *cur++ = (uint8_t)unum;
+            }
+        }
+        enc->cur = cur;
+    }
+    return res;
+}
+
+/*
+ * Deferred length containers
+ *
+ * The items of a container are counted from the headers written into it.
+ * Counting happens when a nested container is started or closed and when
+ * the container itself is closed, every byte is passed once by the
+ * innermost container it is in. A nested container counts as a single item
+ * once it is closed.
+ */
+
+/* Count an item directly inside the container, or a part of the last one.
+ * @p children is the number of items the item consists of. */
+static int _deferred_item(nanocbor_deferred_t *deferred, uint64_t children)
+{
+    if (deferred->indefinite) {
+        return NANOCBOR_OK;
+    }
+    if (deferred->need) {
+        deferred->need--;
+    }
+    else if (deferred->items == UINT32_MAX) {
+        return NANOCBOR_ERR_OVERFLOW;
+    }
+    else {
+        deferred->items++;
+    }
+    /* Saturates, a container that large can't be completed anyway */
+    deferred->need = (children > UINT64_MAX - deferred->need)
+                     ? UINT64_MAX : deferred->need + children;
+    return NANOCBOR_OK;
+}
+
+static int _deferred_scan(nanocbor_deferred_t *deferred, const uint8_t *end)
+{
+    const uint8_t *cur = deferred->scan;
+
+    while (cur < end) {
+        if (deferred->payload) {
+            size_t left = (size_t)(end - cur);
+            size_t pass = (deferred->payload < left) ? (size_t)deferred->payload
+                                                     : left;
+            cur += pass;
+            deferred->payload -= pass;
+            continue;
+        }
+        uint8_t type = (*cur & NANOCBOR_TYPE_MASK) >> NANOCBOR_TYPE_OFFSET;
+        uint8_t info = *cur & NANOCBOR_VALUE_MASK;
+        uint64_t arg = info;
+        int res = NANOCBOR_OK;
+        cur++;
+
+        if (info == NANOCBOR_SIZE_INDEFINITE) {
+            if (type == NANOCBOR_TYPE_FLOAT) {
+                /* Break */
+                if (!deferred->indefinite) {
+                    return NANOCBOR_ERR_INVALID_TYPE;
+                }
+                deferred->indefinite--;
+                continue;
+            }
+            if (type < NANOCBOR_TYPE_BSTR || type == NANOCBOR_TYPE_TAG) {
+                return NANOCBOR_ERR_INVALID_TYPE;
+            }
+            res = _deferred_item(deferred, 0);
+            deferred->indefinite++;
+            if (res < 0) {
+                return res;
+            }
+            continue;
+        }
+        if (info > NANOCBOR_SIZE_LONG) {
+            return NANOCBOR_ERR_INVALID_TYPE;
+        }
+        if (info >= NANOCBOR_SIZE_BYTE) {
+            size_t extra = (size_t)1U << (info - NANOCBOR_SIZE_BYTE);
+            if ((size_t)(end - cur) < extra) {
+                return NANOCBOR_ERR_END;
+            }
+            arg = 0;
+            for (size_t i = 0; i < extra; i++) {
+                arg = (arg << 8U) | *cur++;
+            }
+        }
+        switch (type) {
+        case NANOCBOR_TYPE_BSTR:
+        case NANOCBOR_TYPE_TSTR:
+            deferred->payload = arg;
+            res = _deferred_item(deferred, 0);
+            break;
+        case NANOCBOR_TYPE_ARR:
+            res = _deferred_item(deferred, arg);
+            break;
+        case NANOCBOR_TYPE_MAP:
+            res = _deferred_item(deferred, (arg > UINT64_MAX / 2U)
+                                           ? UINT64_MAX : arg * 2U);
+            break;
+        case NANOCBOR_TYPE_TAG:
+            res = _deferred_item(deferred, 1);
+            break;
+        default:
+            res = _deferred_item(deferred, 0);
+            break;
+        }
+        if (res < 0) {
+            return res;
+        }
+    }
+    deferred->scan = cur;
+    return NANOCBOR_OK;
+}
+
+static int _fmt_begin(nanocbor_encoder_t *enc, nanocbor_deferred_t *deferred,
+                      uint8_t type)
+{
+    deferred->len = enc->len;
+    deferred->type = type;
+    deferred->hdr = NULL;
+
+    if (enc->deferred) {
+        int res = _deferred_scan(enc->deferred, enc->cur);
+        if (res < 0) {
+            return res;
+        }
+    }
+    int res = _fits(enc, NANOCBOR_DEFERRED_HDR_LEN);
+    if (res < 0) {
+        return res;
+    }
+    deferred->hdr = enc->cur;
+    enc->cur += NANOCBOR_DEFERRED_HDR_LEN;
+    deferred->parent = enc->deferred;
+    deferred->scan = enc->cur;
+    deferred->need = 0;
+    deferred->payload = 0;
+    deferred->indefinite = 0;
+    deferred->items = 0;
+    enc->deferred = deferred;
+    return NANOCBOR_OK;
+}
+
+int nanocbor_fmt_array_begin(nanocbor_encoder_t *enc,
+                             nanocbor_deferred_t *deferred)
+{
+    return _fmt_begin(enc, deferred, NANOCBOR_MASK_ARR);
+}
+
+int nanocbor_fmt_map_begin(nanocbor_encoder_t *enc,
+                           nanocbor_deferred_t *deferred)
+{
+    return _fmt_begin(enc, deferred, NANOCBOR_MASK_MAP);
+}
+
+int nanocbor_fmt_container_end(nanocbor_encoder_t *enc,
+                               nanocbor_deferred_t *deferred)
+{
+    size_t written = enc->len - deferred->len;
+
+    /* Everything written since the start must still be in the buffer */
+    if (!deferred->hdr || written < NANOCBOR_DEFERRED_HDR_LEN ||
+        (size_t)(enc->cur - deferred->hdr) != written) {
+        return NANOCBOR_ERR_END;
+    }
+    if (enc->deferred != deferred) {
+        return NANOCBOR_ERR_INVALID_TYPE;
+    }
+    int res = _deferred_scan(deferred, enc->cur);
+    if (res < 0) {
+        return res;
+    }
+    if (deferred->need || deferred->payload || deferred->indefinite) {
+        return NANOCBOR_ERR_END;
+    }
+    uint32_t items = deferred->items;
+    if (deferred->type == NANOCBOR_MASK_MAP) {
+        if (items % 2) {
+            return NANOCBOR_ERR_INVALID_TYPE;
+        }
+        items /= 2;
+    }
+    uint8_t *body = deferred->hdr + NANOCBOR_DEFERRED_HDR_LEN;
+    size_t body_len = written - NANOCBOR_DEFERRED_HDR_LEN;
+    size_t hdr = _put_uint32(deferred->hdr, items, deferred->type);
+    if (hdr < NANOCBOR_DEFERRED_HDR_LEN) {
+        memmove(deferred->hdr + hdr, body, body_len);
+        enc->cur -= NANOCBOR_DEFERRED_HDR_LEN - hdr;
+        enc->len -= NANOCBOR_DEFERRED_HDR_LEN - hdr;
+    }
+    deferred->hdr = NULL;
+    enc->deferred = deferred->parent;
+    /* The closed container is a single item of the enclosing one */
+    if (enc->deferred) {
+        enc->deferred->scan = enc->cur;
+        return _deferred_item(enc->deferred, 0);
+    }
+    return NANOCBOR_OK;
+}
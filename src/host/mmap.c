@@ -0,0 +1,69 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @ingroup nanocbor_mmap
+ * @{
+ * @file
+ * @brief   Memory mapped file loader, host only
+ * @}
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/host/mmap.h"
+
+int nanocbor_mmap_open(nanocbor_mmap_t *map, const char *path)
+{
+    struct stat st;
+    int res = NANOCBOR_OK;
+    int fd = open(path, O_RDONLY);
+
+    map->buf = NULL;
+    map->len = 0;
+    map->error = 0;
+    if (fd < 0) {
+        map->error = errno;
+        return NANOCBOR_ERR_SYSTEM;
+    }
+    if (fstat(fd, &st) < 0) {
+        map->error = errno;
+        res = NANOCBOR_ERR_SYSTEM;
+    }
+    else if (st.st_size > 0) {
+        void *buf = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE,
+                         fd, 0);
+        if (buf == MAP_FAILED) {
+            map->error = errno;
+            res = NANOCBOR_ERR_SYSTEM;
+        }
+        else {
+            /* Only a hint, failure doesn't matter */
+            posix_madvise(buf, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+            map->buf = buf;
+            map->len = (size_t)st.st_size;
+        }
+    }
+    /* The mapping stays valid after closing the file */
+    close(fd);
+    return res;
+}
+
+void nanocbor_mmap_close(nanocbor_mmap_t *map)
+{
+    if (map->buf) {
+        munmap((void *)map->buf, map->len);
+    }
+    map->buf = NULL;
+    map->len = 0;
+}
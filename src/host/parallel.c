@@ -0,0 +1,186 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @ingroup nanocbor_parallel
+ * @{
+ * @file
+ * @brief   Parallel CBOR sequence processing, host only
+ * @}
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "nanocbor/config.h"
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/sequence.h"
+#include "nanocbor/host/parallel.h"
+
+typedef struct {
+    size_t records;     /* Records processed before the failure */
+    size_t offset;      /* Offset of the failing record */
+    int res;
+} _slice_result_t;
+
+typedef struct {
+    const uint8_t *buf;
+    size_t len;
+    const size_t *offsets;
+    _slice_result_t *results;
+    size_t slices;
+    nanocbor_parallel_cb_t cb;
+    void *ctx;
+    pthread_mutex_t lock;
+    size_t next;        /* Next slice to process */
+    size_t failed;      /* First slice with a failure, slices if none */
+} _pool_t;
+
+static void _process_slice(const _pool_t *pool, size_t slice,
+                           _slice_result_t *result)
+{
+    size_t start = pool->offsets[slice];
+    size_t end = (slice + 1 < pool->slices) ? pool->offsets[slice + 1]
+                                            : pool->len;
+    nanocbor_value_t seq;
+    const uint8_t *item = NULL;
+    size_t len = 0;
+
+    result->records = 0;
+    result->res = NANOCBOR_OK;
+    nanocbor_decoder_init(&seq, pool->buf + start, end - start);
+    while (1) {
+        result->offset = (size_t)(seq.cur - pool->buf);
+        int res = nanocbor_sequence_next(&seq, &item, &len);
+        if (res == NANOCBOR_NOT_FOUND) {
+            return;
+        }
+        if (res == NANOCBOR_OK && pool->cb) {
+            nanocbor_value_t record;
+            nanocbor_decoder_init(&record, item, len);
+            res = pool->cb(pool->ctx, &record, result->offset);
+        }
+        if (res < 0) {
+            result->res = res;
+            return;
+        }
+        result->records++;
+    }
+}
+
+static void *_worker(void *arg)
+{
+    _pool_t *pool = arg;
+
+    while (1) {
+        pthread_mutex_lock(&pool->lock);
+        size_t slice = pool->next++;
+        /* Slices after a failure don't change the result */
+        size_t failed = pool->failed;
+        pthread_mutex_unlock(&pool->lock);
+
+        if (slice >= pool->slices || slice > failed) {
+            return NULL;
+        }
+        _process_slice(pool, slice, &pool->results[slice]);
+        if (pool->results[slice].res < 0) {
+            pthread_mutex_lock(&pool->lock);
+            if (slice < pool->failed) {
+                pool->failed = slice;
+            }
+            pthread_mutex_unlock(&pool->lock);
+        }
+    }
+}
+
+static unsigned _num_threads(unsigned threads)
+{
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (cpus > 0) ? (unsigned)cpus : 1U;
+    }
+    return threads;
+}
+
+static int _finish(const _pool_t *pool, nanocbor_parallel_result_t *result)
+{
+    result->records = 0;
+    result->offset = pool->len;
+    result->res = NANOCBOR_OK;
+
+    /* Combine in sequence order, up to the first failing slice */
+    for (size_t i = 0; i < pool->slices && i <= pool->failed; i++) {
+        result->records += pool->results[i].records;
+        if (pool->results[i].res < 0) {
+            result->offset = pool->results[i].offset;
+            result->res = pool->results[i].res;
+            break;
+        }
+    }
+    return result->res;
+}
+
+int nanocbor_parallel_process(const uint8_t *buf, size_t len, unsigned threads,
+                              nanocbor_parallel_cb_t cb, void *ctx,
+                              nanocbor_parallel_result_t *result)
+{
+    size_t *offsets = NULL;
+    _slice_result_t *results = NULL;
+    pthread_t *tids = NULL;
+    size_t single_offset = 0;
+    _slice_result_t single_result;
+    int slices = NANOCBOR_ERR_END;
+
+    /* Splitting walks the structure of the sequence, without a callback
+     * or text strings to validate that is all the work */
+    if (cb || NANOCBOR_VALIDATE_UTF8) {
+        threads = _num_threads(threads);
+        size_t max = (size_t)threads * NANOCBOR_PARALLEL_SLICES_PER_THREAD;
+        offsets = malloc(max * sizeof(*offsets));
+        results = malloc(max * sizeof(*results));
+        tids = malloc(threads * sizeof(*tids));
+        if (offsets && results && tids) {
+            slices = nanocbor_sequence_split(buf, len, offsets, max);
+        }
+    }
+    _pool_t pool = {
+        .buf = buf, .len = len, .offsets = offsets, .results = results,
+        .cb = cb, .ctx = ctx, .next = 0,
+    };
+    if (slices < 0) {
+        /* Structure only validation, out of memory or malformed before the
+         * last slice, a single slice locates the failure the same way a
+         * serial pass does */
+        pool.offsets = &single_offset;
+        pool.results = &single_result;
+        slices = 1;
+        threads = 1;
+    }
+    pool.slices = (size_t)slices;
+    pool.failed = pool.slices;
+    pthread_mutex_init(&pool.lock, NULL);
+
+    unsigned started = 0;
+    for (; started + 1 < threads && started + 1 < pool.slices; started++) {
+        if (pthread_create(&tids[started], NULL, _worker, &pool) != 0) {
+            break;
+        }
+    }
+    _worker(&pool);
+    for (unsigned i = 0; i < started; i++) {
+        pthread_join(tids[i], NULL);
+    }
+    pthread_mutex_destroy(&pool.lock);
+
+    int res = _finish(&pool, result);
+    free(offsets);
+    free(results);
+    free(tids);
+    return res;
+}
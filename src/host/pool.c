@@ -0,0 +1,340 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @ingroup nanocbor_pool
+ * @{
+ * @file
+ * @brief   Lock-free encoder buffer pool, host only
+ * @}
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/host/pool.h"
+
+/* Class of the buffers larger than the largest size class */
+#define OVERSIZED       NANOCBOR_POOL_CLASSES
+
+/* A free list head holds the slot index + 1 of the first buffer in the
+ * lower half and a counter in the upper half. The counter changes on every
+ * update, a compare and swap against a head that was popped and pushed
+ * again in the meantime fails. */
+#define HEAD_IDX_MASK   ((uint64_t)UINT32_MAX)
+#define HEAD_TAG_ONE    (UINT64_C(1) << 32)
+
+#define CACHE_LINE      (64U)
+
+typedef struct {
+    size_t size;        /* Usable size */
+    uint32_t slot;      /* Slot index + 1, 0 when not owned by the pool */
+    uint32_t next;      /* Next buffer in a free list, slot index + 1 */
+    uint32_t cls;       /* Size class */
+} _hdr_t;
+
+/* Keeps the data behind the header aligned for any type */
+#define HDR_SIZE        ((sizeof(_hdr_t) + 15U) & ~(size_t)15U)
+
+typedef struct {
+    uint64_t head;
+    uint8_t pad[CACHE_LINE - sizeof(uint64_t)]; /* Against false sharing
+                                                 * between classes */
+} _head_t;
+
+typedef struct {
+    nanocbor_pool_t *pool;
+    uint32_t top[NANOCBOR_POOL_CLASSES];    /* Slot index + 1 */
+    unsigned count[NANOCBOR_POOL_CLASSES];
+} _cache_t;
+
+struct nanocbor_pool {
+    _head_t heads[NANOCBOR_POOL_CLASSES];
+    _hdr_t **slots;     /* Every buffer owned by the pool, by slot index */
+    uint32_t num_slots;
+    uint32_t used;      /* Slots handed out, can overshoot num_slots */
+    pthread_key_t cache;
+};
+
+static inline _hdr_t *_hdr(uint8_t *buf)
+{
+    return (_hdr_t *)(void *)(buf - HDR_SIZE);
+}
+
+static inline uint8_t *_data(_hdr_t *hdr)
+{
+    return (uint8_t *)hdr + HDR_SIZE;
+}
+
+/* The link of a buffer can be read by a thread holding an outdated free
+ * list head, even while the buffer is in use elsewhere */
+static inline uint32_t _next(const _hdr_t *hdr)
+{
+    return __atomic_load_n(&hdr->next, __ATOMIC_RELAXED);
+}
+
+static inline void _set_next(_hdr_t *hdr, uint32_t next)
+{
+    __atomic_store_n(&hdr->next, next, __ATOMIC_RELAXED);
+}
+
+static unsigned _class(size_t size)
+{
+    size_t cap = NANOCBOR_POOL_MIN_SIZE;
+    unsigned cls = 0;
+
+    while (cap < size && cls < OVERSIZED) {
+        cap <<= 1U;
+        cls++;
+    }
+    return cls;
+}
+
+static void _push(nanocbor_pool_t *pool, _hdr_t *hdr)
+{
+    uint64_t *head = &pool->heads[hdr->cls].head;
+    uint64_t old = __atomic_load_n(head, __ATOMIC_RELAXED);
+    uint64_t next = 0;
+
+    do {
+        _set_next(hdr, (uint32_t)(old & HEAD_IDX_MASK));
+        next = ((old & ~HEAD_IDX_MASK) + HEAD_TAG_ONE) | hdr->slot;
+    } while (!__atomic_compare_exchange_n(head, &old, next, true,
+                                          __ATOMIC_RELEASE,
+                                          __ATOMIC_RELAXED));
+}
+
+static _hdr_t *_pop(nanocbor_pool_t *pool, unsigned cls)
+{
+    uint64_t *head = &pool->heads[cls].head;
+    uint64_t old = __atomic_load_n(head, __ATOMIC_ACQUIRE);
+    uint64_t next = 0;
+    _hdr_t *hdr = NULL;
+
+    do {
+        uint32_t idx = (uint32_t)(old & HEAD_IDX_MASK);
+        if (idx == 0) {
+            return NULL;
+        }
+        /* Buffers are only freed with the pool, the slot is always valid */
+        hdr = pool->slots[idx - 1];
+        next = ((old & ~HEAD_IDX_MASK) + HEAD_TAG_ONE) | _next(hdr);
+    } while (!__atomic_compare_exchange_n(head, &old, next, true,
+                                          __ATOMIC_ACQUIRE,
+                                          __ATOMIC_ACQUIRE));
+    return hdr;
+}
+
+static _hdr_t *_alloc(nanocbor_pool_t *pool, unsigned cls, size_t size)
+{
+    size_t cap = (cls < OVERSIZED) ? (size_t)NANOCBOR_POOL_MIN_SIZE << cls
+                                   : size;
+    uint32_t slot = 0;
+
+    if (cap > SIZE_MAX - HDR_SIZE) {
+        return NULL;
+    }
+    if (cls < OVERSIZED &&
+        __atomic_load_n(&pool->used, __ATOMIC_RELAXED) < pool->num_slots) {
+        uint32_t idx = __atomic_fetch_add(&pool->used, 1, __ATOMIC_RELAXED);
+        if (idx < pool->num_slots) {
+            slot = idx + 1;
+        }
+    }
+    _hdr_t *hdr = malloc(HDR_SIZE + cap);
+    if (hdr == NULL) {
+        /* A claimed slot stays empty */
+        return NULL;
+    }
+    hdr->size = cap;
+    hdr->slot = slot;
+    hdr->next = 0;
+    hdr->cls = cls;
+    if (slot) {
+        pool->slots[slot - 1] = hdr;
+    }
+    return hdr;
+}
+
+static void _flush_cache(_cache_t *cache)
+{
+    for (unsigned cls = 0; cls < NANOCBOR_POOL_CLASSES; cls++) {
+        while (cache->top[cls]) {
+            _hdr_t *hdr = cache->pool->slots[cache->top[cls] - 1];
+            cache->top[cls] = _next(hdr);
+            _push(cache->pool, hdr);
+        }
+        cache->count[cls] = 0;
+    }
+}
+
+/* Thread exit destructor of the cache key */
+static void _cache_exit(void *arg)
+{
+    _cache_t *cache = arg;
+
+    _flush_cache(cache);
+    free(cache);
+}
+
+static _cache_t *_cache(nanocbor_pool_t *pool, bool create)
+{
+    _cache_t *cache = pthread_getspecific(pool->cache);
+
+    if (cache == NULL && create) {
+        cache = calloc(1, sizeof(*cache));
+        if (cache == NULL) {
+            return NULL;
+        }
+        cache->pool = pool;
+        if (pthread_setspecific(pool->cache, cache) != 0) {
+            free(cache);
+            return NULL;
+        }
+    }
+    return cache;
+}
+
+nanocbor_pool_t *nanocbor_pool_create(size_t buffers)
+{
+    nanocbor_pool_t *pool = calloc(1, sizeof(*pool));
+
+    if (pool == NULL) {
+        return NULL;
+    }
+    /* Slot index + 1 must fit the free list head */
+    if (buffers > UINT32_MAX - 1U) {
+        buffers = UINT32_MAX - 1U;
+    }
+    pool->num_slots = (uint32_t)buffers;
+    pool->slots = calloc(buffers ? buffers : 1, sizeof(*pool->slots));
+    if (pool->slots == NULL ||
+        pthread_key_create(&pool->cache, _cache_exit) != 0) {
+        free(pool->slots);
+        free(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+void nanocbor_pool_destroy(nanocbor_pool_t *pool)
+{
+    uint32_t used = pool->used < pool->num_slots ? pool->used
+                                                 : pool->num_slots;
+
+    free(pthread_getspecific(pool->cache));
+    pthread_key_delete(pool->cache);
+    for (uint32_t i = 0; i < used; i++) {
+        free(pool->slots[i]);
+    }
+    free(pool->slots);
+    free(pool);
+}
+
+uint8_t *nanocbor_pool_get(nanocbor_pool_t *pool, size_t size)
+{
+    unsigned cls = _class(size);
+    _hdr_t *hdr = NULL;
+
+    if (cls < OVERSIZED) {
+        _cache_t *cache = _cache(pool, false);
+        if (cache && cache->count[cls]) {
+            hdr = pool->slots[cache->top[cls] - 1];
+            cache->top[cls] = _next(hdr);
+            cache->count[cls]--;
+        }
+        else {
+            hdr = _pop(pool, cls);
+        }
+    }
+    if (hdr == NULL) {
+        hdr = _alloc(pool, cls, size);
+    }
+    return hdr ? _data(hdr) : NULL;
+}
+
+void nanocbor_pool_put(nanocbor_pool_t *pool, uint8_t *buf)
+{
+    if (buf == NULL) {
+        return;
+    }
+    _hdr_t *hdr = _hdr(buf);
+    if (hdr->slot == 0) {
+        free(hdr);
+        return;
+    }
+    _cache_t *cache = _cache(pool, true);
+    if (cache && cache->count[hdr->cls] < NANOCBOR_POOL_CACHE_SIZE) {
+        _set_next(hdr, cache->top[hdr->cls]);
+        cache->top[hdr->cls] = hdr->slot;
+        cache->count[hdr->cls]++;
+        return;
+    }
+    _push(pool, hdr);
+}
+
+size_t nanocbor_pool_capacity(const uint8_t *buf)
+{
+    const _hdr_t *hdr = (const _hdr_t *)(const void *)(buf - HDR_SIZE);
+
+    return hdr->size;
+}
+
+void nanocbor_pool_flush(nanocbor_pool_t *pool)
+{
+    _cache_t *cache = _cache(pool, false);
+
+    if (cache) {
+        pthread_setspecific(pool->cache, NULL);
+        _cache_exit(cache);
+    }
+}
+
+/* Encoder sink, moves the encoded data to a larger buffer */
+static int _grow(nanocbor_encoder_t *enc, void *ctx, size_t len)
+{
+    nanocbor_pool_buf_t *out = ctx;
+    size_t used = (size_t)(enc->cur - out->buf);
+    size_t size = out->size * 2U;
+
+    if (len > SIZE_MAX / 2U - used || size < out->size) {
+        return NANOCBOR_ERR_END;
+    }
+    if (size < used + len) {
+        size = used + len;
+    }
+    uint8_t *buf = nanocbor_pool_get(out->pool, size);
+    if (buf == NULL) {
+        return NANOCBOR_ERR_END;
+    }
+    memcpy(buf, out->buf, used);
+    nanocbor_pool_put(out->pool, out->buf);
+    out->buf = buf;
+    out->size = nanocbor_pool_capacity(buf);
+    enc->cur = buf + used;
+    enc->end = buf + out->size;
+    return NANOCBOR_OK;
+}
+
+int nanocbor_pool_encoder_init(nanocbor_encoder_t *enc,
+                               nanocbor_pool_buf_t *out,
+                               nanocbor_pool_t *pool, size_t hint)
+{
+    out->pool = pool;
+    out->size = 0;
+    out->buf = nanocbor_pool_get(pool, hint);
+    if (out->buf == NULL) {
+        return NANOCBOR_ERR_END;
+    }
+    out->size = nanocbor_pool_capacity(out->buf);
+    nanocbor_encoder_sink_init(enc, out->buf, out->size, _grow, out);
+    return NANOCBOR_OK;
+}
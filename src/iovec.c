@@ -0,0 +1,91 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @ingroup nanocbor_iovec
+ * @{
+ * @file
+ * @brief   Scatter-gather encoder implementation
+ * @}
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/iovec.h"
+
+void nanocbor_iovec_encoder_init(nanocbor_iovec_encoder_t *ienc,
+                                 uint8_t *buf, size_t len,
+                                 nanocbor_iovec_t *iov, size_t iov_max,
+                                 size_t threshold)
+{
+    nanocbor_encoder_init(&ienc->enc, buf, len);
+    ienc->iov = iov;
+    ienc->iov_max = iov_max;
+    ienc->iov_num = 0;
+    ienc->seg = buf;
+    ienc->threshold = threshold;
+}
+
+/* Record the part of the buffer written since the last reference */
+static int _close_segment(nanocbor_iovec_encoder_t *ienc)
+{
+    if (ienc->enc.cur == ienc->seg) {
+        return NANOCBOR_OK;
+    }
+    if (ienc->iov_num == ienc->iov_max) {
+        return NANOCBOR_ERR_END;
+    }
+    nanocbor_iovec_t *iov = &ienc->iov[ienc->iov_num++];
+    iov->base = ienc->seg;
+    iov->len = (size_t)(ienc->enc.cur - ienc->seg);
+    ienc->seg = ienc->enc.cur;
+    return NANOCBOR_OK;
+}
+
+static int _put_ref(nanocbor_iovec_encoder_t *ienc, const void *str,
+                    size_t len, int (*fmt)(nanocbor_encoder_t *, size_t))
+{
+    /* Header segment and the reference */
+    if (ienc->iov_max - ienc->iov_num < 2) {
+        return NANOCBOR_ERR_END;
+    }
+    int res = fmt(&ienc->enc, len);
+    if (res < 0) {
+        return res;
+    }
+    _close_segment(ienc);
+    nanocbor_iovec_t *iov = &ienc->iov[ienc->iov_num++];
+    iov->base = str;
+    iov->len = len;
+    ienc->enc.len += len;
+    return NANOCBOR_OK;
+}
+
+int nanocbor_iovec_put_bstr(nanocbor_iovec_encoder_t *ienc,
+                            const uint8_t *str, size_t len)
+{
+    if (len < ienc->threshold) {
+        return nanocbor_put_bstr(&ienc->enc, str, len);
+    }
+    return _put_ref(ienc, str, len, nanocbor_fmt_bstr);
+}
+
+int nanocbor_iovec_put_tstr(nanocbor_iovec_encoder_t *ienc,
+                            const char *str, size_t len)
+{
+    if (len < ienc->threshold) {
+        return nanocbor_put_tstrn(&ienc->enc, str, len);
+    }
+    return _put_ref(ienc, str, len, nanocbor_fmt_tstr);
+}
+
+int nanocbor_iovec_finish(nanocbor_iovec_encoder_t *ienc)
+{
+    int res = _close_segment(ienc);
+
+    return res < 0 ? res : (int)ienc->iov_num;
+}
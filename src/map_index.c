@@ -0,0 +1,188 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @ingroup nanocbor_map_index
+ * @{
+ * @file
+ * @brief   Map key index implementation
+ * @}
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nanocbor/config.h"
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/map_index.h"
+
+/* FNV-1a parameters */
+#define FNV_OFFSET_BASIS    (2166136261U)
+#define FNV_PRIME           (16777619U)
+/* Multiplicative hashing constant for integer keys */
+#define INT_HASH_MULTIPLIER (2654435769U)
+#define INT_HASH_SHIFT      (32U)
+
+static uint32_t _hash_str(const uint8_t *str, size_t len)
+{
+    uint32_t hash = FNV_OFFSET_BASIS;
+
+    for (size_t i = 0; i < len; i++) {
+        hash ^= str[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static uint32_t _hash_int(int64_t num)
+{
+    uint64_t unum = (uint64_t)num;
+
+    return (uint32_t)(unum ^ (unum >> INT_HASH_SHIFT)) * INT_HASH_MULTIPLIER;
+}
+
+static bool _entry_match(const nanocbor_map_index_entry_t *entry,
+                         const nanocbor_map_index_entry_t *key)
+{
+    if (entry->hash != key->hash || (entry->str == NULL) != (key->str == NULL)) {
+        return false;
+    }
+    if (key->str) {
+        return entry->str_len == key->str_len &&
+               memcmp(entry->str, key->str, key->str_len) == 0;
+    }
+    return entry->num == key->num;
+}
+
+/* Find the entry matching the key, or the empty entry where it belongs */
+static nanocbor_map_index_entry_t *_find(const nanocbor_map_index_t *index,
+                                         const nanocbor_map_index_entry_t *key)
+{
+    if (index->size == 0) {
+        return NULL;
+    }
+    size_t pos = key->hash % index->size;
+
+    for (size_t probes = 0; probes < index->size; probes++) {
+        nanocbor_map_index_entry_t *entry = &index->entries[pos];
+        if (!entry->used || _entry_match(entry, key)) {
+            return entry;
+        }
+        pos = (pos + 1 == index->size) ? 0 : pos + 1;
+    }
+    return NULL;
+}
+
+void nanocbor_map_index_init(nanocbor_map_index_t *index,
+                             nanocbor_map_index_entry_t *entries, size_t size)
+{
+    index->entries = entries;
+    index->size = size;
+    index->used = 0;
+    memset(entries, 0, sizeof(*entries) * size);
+}
+
+/* Decode a key into @p key, returns 0 when the key type can't be indexed */
+static int _get_key(nanocbor_value_t *it, nanocbor_map_index_entry_t *key)
+{
+    int type = nanocbor_get_type(it);
+    int res = 0;
+
+    key->str = NULL;
+    if (type == NANOCBOR_TYPE_TSTR) {
+        res = nanocbor_get_tstr(it, &key->str, &key->str_len);
+        if (res < 0) {
+            return res;
+        }
+        key->hash = _hash_str(key->str, key->str_len);
+        return 1;
+    }
+    if (type == NANOCBOR_TYPE_UINT || type == NANOCBOR_TYPE_NINT) {
+        res = nanocbor_get_int64(it, &key->num);
+        if (res >= 0) {
+            key->hash = _hash_int(key->num);
+            return 1;
+        }
+        if (res != NANOCBOR_ERR_OVERFLOW) {
+            return res;
+        }
+    }
+    /* Not an indexable key */
+    res = nanocbor_skip(it);
+    return res < 0 ? res : 0;
+}
+
+int nanocbor_map_index_build(nanocbor_map_index_t *index,
+                             const nanocbor_value_t *map)
+{
+    nanocbor_value_t it = *map;
+
+    while (!nanocbor_at_end(&it)) {
+        nanocbor_map_index_entry_t key;
+        memset(&key, 0, sizeof(key));
+        int res = _get_key(&it, &key);
+
+        if (res < 0) {
+            return res;
+        }
+        if (res > 0) {
+            nanocbor_map_index_entry_t *entry = _find(index, &key);
+            if (!entry) {
+                return NANOCBOR_ERR_OVERFLOW;
+            }
+            /* Keep the first occurrence of a key */
+            if (!entry->used) {
+                *entry = key;
+                entry->value = it;
+                entry->used = true;
+                index->used++;
+            }
+        }
+        res = nanocbor_skip(&it);
+        if (res < 0) {
+            return res;
+        }
+    }
+    /* Truncated at an item boundary */
+    if (nanocbor_in_container(&it) && nanocbor_needs_input(&it)) {
+        return NANOCBOR_ERR_END;
+    }
+    return NANOCBOR_OK;
+}
+
+static int _get(const nanocbor_map_index_t *index,
+                const nanocbor_map_index_entry_t *key, nanocbor_value_t *value)
+{
+    const nanocbor_map_index_entry_t *entry = _find(index, key);
+
+    if (entry && entry->used) {
+        *value = entry->value;
+        return NANOCBOR_OK;
+    }
+    return NANOCBOR_NOT_FOUND;
+}
+
+int nanocbor_map_index_get_tstr(const nanocbor_map_index_t *index,
+                                const char *key, nanocbor_value_t *value)
+{
+    nanocbor_map_index_entry_t tmp;
+
+    tmp.str = (const uint8_t *)key;
+    tmp.str_len = strlen(key);
+    tmp.hash = _hash_str(tmp.str, tmp.str_len);
+    return _get(index, &tmp, value);
+}
+
+int nanocbor_map_index_get_int(const nanocbor_map_index_t *index,
+                               int64_t key, nanocbor_value_t *value)
+{
+    nanocbor_map_index_entry_t tmp;
+
+    tmp.str = NULL;
+    tmp.num = key;
+    tmp.hash = _hash_int(key);
+    return _get(index, &tmp, value);
+}
@@ -0,0 +1,264 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @ingroup nanocbor_query
+ * @{
+ * @file
+ * @brief   Path query implementation
+ * @}
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nanocbor/config.h"
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/query.h"
+
+#define QUERY_NODES_MAX     (UINT16_MAX)
+
+void nanocbor_query_init(nanocbor_query_t *query, nanocbor_query_node_t *nodes,
+                         size_t size)
+{
+    query->nodes = nodes;
+    query->size = size > QUERY_NODES_MAX ? QUERY_NODES_MAX : size;
+    query->used = 1;
+    query->paths = 0;
+    memset(&nodes[0], 0, sizeof(nodes[0]));
+    nodes[0].result = -1;
+}
+
+/* Parse a single segment after the '/', returns the remainder of the path
+ * or NULL when malformed */
+static const char *_parse_segment(const char *path,
+                                  nanocbor_query_node_t *seg)
+{
+    seg->str = NULL;
+    seg->str_len = 0;
+    seg->num = 0;
+
+    if (*path == '"') {
+        const char *end = strchr(path + 1, '"');
+        if (!end) {
+            return NULL;
+        }
+        seg->str = path + 1;
+        seg->str_len = (size_t)(end - seg->str);
+        path = end + 1;
+    }
+    else {
+        bool negative = (*path == '-');
+        uint64_t num = 0;
+
+        path += negative;
+        if (*path < '0' || *path > '9') {
+            return NULL;
+        }
+        for (; *path >= '0' && *path <= '9'; path++) {
+            num = num * 10U + (uint64_t)(*path - '0');
+            if (num > (uint64_t)INT64_MAX) {
+                return NULL;
+            }
+        }
+        seg->num = negative ? -(int64_t)num : (int64_t)num;
+    }
+    return (*path == '/' || *path == '\0') ? path : NULL;
+}
+
+static bool _segment_match(const nanocbor_query_node_t *node,
+                           const nanocbor_query_node_t *seg)
+{
+    if (node->str || seg->str) {
+        return node->str && seg->str && node->str_len == seg->str_len &&
+               memcmp(node->str, seg->str, seg->str_len) == 0;
+    }
+    return node->num == seg->num;
+}
+
+/* Find or add the child of @p parent matching @p seg */
+static int _child(nanocbor_query_t *query, size_t parent,
+                  const nanocbor_query_node_t *seg)
+{
+    nanocbor_query_node_t *nodes = query->nodes;
+    size_t last = 0;
+
+    for (size_t i = nodes[parent].child; i; i = nodes[i].sibling) {
+        if (_segment_match(&nodes[i], seg)) {
+            return (int)i;
+        }
+        last = i;
+    }
+    if (query->used == query->size ||
+        nodes[parent].children == NANOCBOR_QUERY_CHILDREN_MAX) {
+        return NANOCBOR_ERR_OVERFLOW;
+    }
+    size_t idx = query->used++;
+    nodes[idx] = *seg;
+    nodes[idx].child = 0;
+    nodes[idx].sibling = 0;
+    nodes[idx].children = 0;
+    nodes[idx].result = -1;
+    if (last) {
+        nodes[last].sibling = (uint16_t)idx;
+    }
+    else {
+        nodes[parent].child = (uint16_t)idx;
+    }
+    nodes[parent].children++;
+    return (int)idx;
+}
+
+int nanocbor_query_add(nanocbor_query_t *query, const char *path)
+{
+    size_t node = 0;
+    size_t depth = 0;
+
+    if (*path != '/') {
+        return NANOCBOR_ERR_INVALID_TYPE;
+    }
+    /* The root path has no segments */
+    if (path[1] == '\0') {
+        path++;
+    }
+    while (*path == '/') {
+        nanocbor_query_node_t seg;
+        path = _parse_segment(path + 1, &seg);
+        if (!path) {
+            return NANOCBOR_ERR_INVALID_TYPE;
+        }
+        if (++depth > NANOCBOR_RECURSION_MAX) {
+            return NANOCBOR_ERR_RECURSION;
+        }
+        int res = _child(query, node, &seg);
+        if (res < 0) {
+            return res;
+        }
+        node = (size_t)res;
+    }
+    if (query->nodes[node].result < 0) {
+        if (query->paths > INT16_MAX) {
+            return NANOCBOR_ERR_OVERFLOW;
+        }
+        query->nodes[node].result = (int16_t)query->paths++;
+    }
+    return query->nodes[node].result;
+}
+
+/* Decode a map key into @p seg, returns 0 for keys that can't match */
+static int _get_key(nanocbor_value_t *it, nanocbor_query_node_t *seg)
+{
+    int type = nanocbor_get_type(it);
+    int res = 0;
+
+    seg->str = NULL;
+    if (type == NANOCBOR_TYPE_TSTR) {
+        const uint8_t *str = NULL;
+        res = nanocbor_get_tstr(it, &str, &seg->str_len);
+        seg->str = (const char *)str;
+        return res < 0 ? res : 1;
+    }
+    if (type == NANOCBOR_TYPE_UINT || type == NANOCBOR_TYPE_NINT) {
+        res = nanocbor_get_int64(it, &seg->num);
+        if (res != NANOCBOR_ERR_OVERFLOW) {
+            return res < 0 ? res : 1;
+        }
+    }
+    res = nanocbor_skip(it);
+    return res < 0 ? res : 0;
+}
+
+/* Walk the item at @p it, with @p advance set @p it is moved past the item.
+ * Children are walked where they are, so every item is passed once. */
+static int _walk(const nanocbor_query_t *query,
+                 const nanocbor_query_node_t *node,
+                 nanocbor_value_t *it, nanocbor_value_t *results, bool advance)
+{
+    const nanocbor_query_node_t *nodes = query->nodes;
+    nanocbor_value_t item = *it;
+    nanocbor_value_t cont;
+    int found = 0;
+
+    if (node->result >= 0) {
+        results[node->result] = *it;
+        found++;
+    }
+    int res = node->child ? nanocbor_skip_tags(&item) : NANOCBOR_OK;
+    if (res < 0) {
+        return res;
+    }
+    int type = nanocbor_get_type(&item);
+    if (!node->child ||
+        (type != NANOCBOR_TYPE_MAP && type != NANOCBOR_TYPE_ARR)) {
+        res = advance ? nanocbor_skip(it) : NANOCBOR_OK;
+        return res < 0 ? res : found;
+    }
+    res = (type == NANOCBOR_TYPE_MAP) ? nanocbor_enter_map(&item, &cont)
+                                      : nanocbor_enter_array(&item, &cont);
+    if (res < 0) {
+        return res;
+    }
+
+    /* Children matched so far, to keep the first occurrence of a key and
+     * to stop once every child is found */
+    uint32_t done = 0;
+    uint32_t all = (node->children == 32U) ? UINT32_MAX
+                                           : (1U << node->children) - 1U;
+    int64_t index = 0;
+
+    while (!nanocbor_at_end(&cont)) {
+        nanocbor_query_node_t seg = { 0 };
+        int match = 1;
+
+        if (done == all && !advance) {
+            return found;
+        }
+        if (type == NANOCBOR_TYPE_MAP) {
+            match = _get_key(&cont, &seg);
+            if (match < 0) {
+                return match;
+            }
+        }
+        else {
+            seg.num = index++;
+        }
+        unsigned bit = 0;
+        size_t i = match ? node->child : 0;
+        for (; i; i = nodes[i].sibling, bit++) {
+            if (!(done & (1U << bit)) && _segment_match(&nodes[i], &seg)) {
+                break;
+            }
+        }
+        if (i) {
+            done |= 1U << bit;
+            res = _walk(query, &nodes[i], &cont, results, true);
+            if (res < 0) {
+                return res;
+            }
+            found += res;
+        }
+        else if ((res = nanocbor_skip(&cont)) < 0) {
+            return res;
+        }
+    }
+    if (nanocbor_needs_input(&cont)) {
+        return NANOCBOR_ERR_END;
+    }
+    nanocbor_leave_container(&item, &cont);
+    *it = item;
+    return found;
+}
+
+int nanocbor_query_run(const nanocbor_query_t *query,
+                       const nanocbor_value_t *doc, nanocbor_value_t *results)
+{
+    nanocbor_value_t it = *doc;
+
+    for (size_t i = 0; i < query->paths; i++) {
+        results[i].cur = NULL;
+    }
+    return _walk(query, &query->nodes[0], &it, results, false);
+}
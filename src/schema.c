@@ -0,0 +1,265 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @ingroup nanocbor_schema
+ * @{
+ * @file
+ * @brief   Schema driven map decoder implementation
+ * @}
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nanocbor/config.h"
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/schema.h"
+
+/* Decode the key and look up the matching field. Returns the field index,
+ * the number of fields when the key is unknown and was skipped, or negative
+ * on error */
+static int _get_field(nanocbor_value_t *map, const nanocbor_schema_t *schema)
+{
+    int type = nanocbor_get_type(map);
+    int res = 0;
+
+    if (type == NANOCBOR_TYPE_TSTR) {
+        const uint8_t *str = NULL;
+        size_t len = 0;
+        res = nanocbor_get_tstr(map, &str, &len);
+        for (size_t i = 0; res >= 0 && i < schema->num; i++) {
+            const char *name = schema->fields[i].name;
+            if (name && strlen(name) == len && memcmp(name, str, len) == 0) {
+                return (int)i;
+            }
+        }
+    }
+    else {
+        int32_t key = 0;
+        res = nanocbor_get_int32(map, &key);
+        for (size_t i = 0; res >= 0 && i < schema->num; i++) {
+            if (!schema->fields[i].name && schema->fields[i].key == key) {
+                return (int)i;
+            }
+        }
+        if (res == NANOCBOR_ERR_INVALID_TYPE || res == NANOCBOR_ERR_OVERFLOW) {
+            /* Key of a type that can't match any field */
+            res = nanocbor_skip(map);
+        }
+    }
+    return res < 0 ? res : (int)schema->num;
+}
+
+static int _decode_uint(nanocbor_value_t *map, uint8_t *member, size_t size)
+{
+    int res = NANOCBOR_ERR_INVALID_TYPE;
+
+    if (size == sizeof(uint8_t)) {
+        uint8_t tmp = 0;
+        if ((res = nanocbor_get_uint8(map, &tmp)) >= 0) {
+            memcpy(member, &tmp, sizeof(tmp));
+        }
+    }
+    else if (size == sizeof(uint16_t)) {
+        uint16_t tmp = 0;
+        if ((res = nanocbor_get_uint16(map, &tmp)) >= 0) {
+            memcpy(member, &tmp, sizeof(tmp));
+        }
+    }
+    else if (size == sizeof(uint32_t)) {
+        uint32_t tmp = 0;
+        if ((res = nanocbor_get_uint32(map, &tmp)) >= 0) {
+            memcpy(member, &tmp, sizeof(tmp));
+        }
+    }
+    else if (size == sizeof(uint64_t)) {
+        uint64_t tmp = 0;
+        if ((res = nanocbor_get_uint64(map, &tmp)) >= 0) {
+            memcpy(member, &tmp, sizeof(tmp));
+        }
+    }
+    return res;
+}
+
+static int _decode_int(nanocbor_value_t *map, uint8_t *member, size_t size)
+{
+    int res = NANOCBOR_ERR_INVALID_TYPE;
+
+    if (size == sizeof(int8_t)) {
+        int8_t tmp = 0;
+        if ((res = nanocbor_get_int8(map, &tmp)) >= 0) {
+            memcpy(member, &tmp, sizeof(tmp));
+        }
+    }
+    else if (size == sizeof(int16_t)) {
+        int16_t tmp = 0;
+        if ((res = nanocbor_get_int16(map, &tmp)) >= 0) {
+            memcpy(member, &tmp, sizeof(tmp));
+        }
+    }
+    else if (size == sizeof(int32_t)) {
+        int32_t tmp = 0;
+        if ((res = nanocbor_get_int32(map, &tmp)) >= 0) {
+            memcpy(member, &tmp, sizeof(tmp));
+        }
+    }
+    else if (size == sizeof(int64_t)) {
+        int64_t tmp = 0;
+        if ((res = nanocbor_get_int64(map, &tmp)) >= 0) {
+            memcpy(member, &tmp, sizeof(tmp));
+        }
+    }
+    return res;
+}
+
+static int _decode_float(nanocbor_value_t *map, uint8_t *member, size_t size)
+{
+    int res = NANOCBOR_ERR_INVALID_TYPE;
+
+    if (size == sizeof(float)) {
+        float tmp = 0;
+        if ((res = nanocbor_get_float(map, &tmp)) >= 0) {
+            memcpy(member, &tmp, sizeof(tmp));
+        }
+    }
+    else if (size == sizeof(double)) {
+        double tmp = 0;
+        if ((res = nanocbor_get_double(map, &tmp)) >= 0) {
+            memcpy(member, &tmp, sizeof(tmp));
+        }
+    }
+    return res;
+}
+
+static int _decode_str(nanocbor_value_t *map, uint8_t *member, size_t size,
+                       uint8_t type)
+{
+    nanocbor_schema_str_t tmp = { NULL, 0 };
+    int res = NANOCBOR_ERR_INVALID_TYPE;
+
+    if (size == sizeof(tmp)) {
+        res = (type == NANOCBOR_SCHEMA_BSTR)
+              ? nanocbor_get_bstr(map, &tmp.buf, &tmp.len)
+              : nanocbor_get_tstr(map, &tmp.buf, &tmp.len);
+        if (res >= 0) {
+            memcpy(member, &tmp, sizeof(tmp));
+        }
+    }
+    return res;
+}
+
+static int _decode(nanocbor_value_t *it, const nanocbor_schema_t *schema,
+                   void *out, uint32_t *found, unsigned depth);
+
+static int _decode_field(nanocbor_value_t *map,
+                         const nanocbor_schema_field_t *field, uint8_t *out,
+                         unsigned depth)
+{
+    uint8_t *member = out + field->offset;
+    int res = NANOCBOR_ERR_INVALID_TYPE;
+
+    switch (field->type) {
+        case NANOCBOR_SCHEMA_UINT:
+            res = _decode_uint(map, member, field->size);
+            break;
+        case NANOCBOR_SCHEMA_INT:
+            res = _decode_int(map, member, field->size);
+            break;
+        case NANOCBOR_SCHEMA_BOOL:
+            if (field->size == sizeof(bool)) {
+                bool tmp = false;
+                if ((res = nanocbor_get_bool(map, &tmp)) >= 0) {
+                    memcpy(member, &tmp, sizeof(tmp));
+                }
+            }
+            break;
+        case NANOCBOR_SCHEMA_FLOAT:
+            res = _decode_float(map, member, field->size);
+            break;
+        case NANOCBOR_SCHEMA_BSTR:
+        case NANOCBOR_SCHEMA_TSTR:
+            res = _decode_str(map, member, field->size, field->type);
+            break;
+        case NANOCBOR_SCHEMA_VALUE:
+            if (field->size == sizeof(nanocbor_value_t)) {
+                memcpy(member, map, sizeof(nanocbor_value_t));
+                res = nanocbor_skip(map);
+            }
+            break;
+        case NANOCBOR_SCHEMA_MAP:
+            if (field->nested) {
+                /* NOLINTNEXTLINE(misc-no-recursion): Bounded by depth */
+                res = _decode(map, field->nested, member, NULL, depth + 1);
+            }
+            break;
+        default:
+            break;
+    }
+    return res;
+}
+
+/* NOLINTNEXTLINE(misc-no-recursion): Recursion is bounded by depth */
+static int _decode(nanocbor_value_t *it, const nanocbor_schema_t *schema,
+                   void *out, uint32_t *found, unsigned depth)
+{
+    nanocbor_value_t map;
+    uint32_t present = 0;
+
+    if (schema->num > NANOCBOR_SCHEMA_FIELDS_MAX) {
+        return NANOCBOR_ERR_OVERFLOW;
+    }
+    /* Nested schemas can refer back to themselves */
+    if (depth >= NANOCBOR_RECURSION_MAX) {
+        return NANOCBOR_ERR_RECURSION;
+    }
+
+    int res = nanocbor_enter_map(it, &map);
+    if (res < 0) {
+        return res;
+    }
+
+    while (!nanocbor_at_end(&map)) {
+        int idx = _get_field(&map, schema);
+        if (idx < 0) {
+            return idx;
+        }
+        /* Unknown keys return schema->num, which can be 32 */
+        if ((size_t)idx < schema->num &&
+            !(present & ((uint32_t)1U << (unsigned)idx))) {
+            res = _decode_field(&map, &schema->fields[idx], out, depth);
+            present |= (uint32_t)1U << (unsigned)idx;
+        }
+        else {
+            res = nanocbor_skip(&map);
+        }
+        if (res < 0) {
+            return res;
+        }
+    }
+    if (nanocbor_needs_input(&map)) {
+        /* Map is truncated */
+        return NANOCBOR_ERR_END;
+    }
+
+    for (size_t i = 0; i < schema->num; i++) {
+        if ((schema->fields[i].flags & NANOCBOR_SCHEMA_REQUIRED) &&
+            !(present & ((uint32_t)1U << i))) {
+            return NANOCBOR_NOT_FOUND;
+        }
+    }
+    nanocbor_leave_container(it, &map);
+    if (found) {
+        *found = present;
+    }
+    return NANOCBOR_OK;
+}
+
+int nanocbor_schema_decode(nanocbor_value_t *it, const nanocbor_schema_t *schema,
+                           void *out, uint32_t *found)
+{
+    return _decode(it, schema, out, found, 0);
+}
@@ -0,0 +1,54 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @ingroup nanocbor_sequence
+ * @{
+ * @file
+ * @brief   CBOR sequence iterator implementation
+ * @}
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/sequence.h"
+
+int nanocbor_sequence_next(nanocbor_value_t *seq, const uint8_t **item,
+                           size_t *len)
+{
+    if (nanocbor_at_end(seq)) {
+        return NANOCBOR_NOT_FOUND;
+    }
+    int res = nanocbor_get_subcbor(seq, item, len);
+    return res < 0 ? res : NANOCBOR_OK;
+}
+
+int nanocbor_sequence_split(const uint8_t *buf, size_t len, size_t *offsets,
+                            size_t num)
+{
+    nanocbor_value_t seq;
+    size_t slices = 0;
+    size_t next = 0;
+
+    nanocbor_decoder_init(&seq, buf, len);
+    while (slices < num && !nanocbor_at_end(&seq)) {
+        size_t pos = (size_t)(seq.cur - buf);
+        /* Start a new slice at the first boundary past the target */
+        if (pos >= next) {
+            offsets[slices++] = pos;
+            next = slices * (len / num);
+            if (slices == num) {
+                break;
+            }
+        }
+        int res = nanocbor_skip_structure(&seq);
+        if (res < 0) {
+            return res;
+        }
+    }
+    return (int)slices;
+}
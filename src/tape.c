@@ -0,0 +1,162 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @ingroup nanocbor_tape
+ * @{
+ * @file
+ * @brief   Structural index implementation
+ * @}
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "nanocbor/config.h"
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/tape.h"
+
+/* Open container during the build */
+typedef struct {
+    nanocbor_value_t it;    /* Decoder inside the container */
+    uint32_t entry;         /* Entry of the container */
+} _frame_t;
+
+void nanocbor_tape_init(nanocbor_tape_t *tape, nanocbor_tape_entry_t *entries,
+                        size_t size)
+{
+    tape->buf = NULL;
+    tape->entries = entries;
+    tape->size = size;
+    tape->used = 0;
+}
+
+static int _close(nanocbor_tape_t *tape, _frame_t *frame,
+                  nanocbor_value_t *parent)
+{
+    nanocbor_tape_entry_t *entry = &tape->entries[frame->entry];
+
+    /* Ran out of buffer before the end of the container */
+    if (nanocbor_needs_input(&frame->it)) {
+        return NANOCBOR_ERR_END;
+    }
+    nanocbor_leave_container(parent, &frame->it);
+    entry->next = (uint32_t)tape->used;
+    entry->end = (uint32_t)(parent->cur - tape->buf);
+    return NANOCBOR_OK;
+}
+
+/* Add an entry for the item at @p it, returns 1 when it is a container and
+ * @p child is entered. @p child is NULL at the maximum depth */
+static int _add(nanocbor_tape_t *tape, nanocbor_value_t *it, _frame_t *child)
+{
+    const uint8_t *start = it->cur;
+
+    if (tape->used == tape->size) {
+        return NANOCBOR_ERR_OVERFLOW;
+    }
+    int res = nanocbor_skip_tags(it);
+    if (res < 0) {
+        return res;
+    }
+    int type = nanocbor_get_type(it);
+    if (type < 0) {
+        return type;
+    }
+    nanocbor_tape_entry_t *entry = &tape->entries[tape->used];
+    entry->offset = (uint32_t)(start - tape->buf);
+    entry->type = (uint8_t)type;
+    entry->count = 0;
+
+    if (type == NANOCBOR_TYPE_ARR || type == NANOCBOR_TYPE_MAP) {
+        if (!child) {
+            return NANOCBOR_ERR_RECURSION;
+        }
+        res = (type == NANOCBOR_TYPE_ARR) ? nanocbor_enter_array(it, &child->it)
+                                          : nanocbor_enter_map(it, &child->it);
+        child->entry = (uint32_t)tape->used;
+        res = (res < 0) ? res : 1;
+    }
+    else {
+        res = nanocbor_skip(it);
+        entry->end = (uint32_t)(it->cur - tape->buf);
+        res = (res < 0) ? res : 0;
+    }
+    if (res >= 0) {
+        tape->used++;
+        entry->next = (uint32_t)tape->used;
+    }
+    return res;
+}
+
+int nanocbor_tape_build(nanocbor_tape_t *tape, const uint8_t *buf, size_t len)
+{
+    _frame_t frames[NANOCBOR_RECURSION_MAX];
+    nanocbor_value_t root;
+    size_t depth = 0;
+
+    if (len > UINT32_MAX) {
+        return NANOCBOR_ERR_OVERFLOW;
+    }
+    tape->buf = buf;
+    tape->used = 0;
+    nanocbor_decoder_init(&root, buf, len);
+
+    while (1) {
+        nanocbor_value_t *it = depth ? &frames[depth - 1].it : &root;
+
+        if (nanocbor_at_end(it)) {
+            if (depth == 0) {
+                return NANOCBOR_OK;
+            }
+            depth--;
+            int res = _close(tape, &frames[depth],
+                             depth ? &frames[depth - 1].it : &root);
+            if (res < 0) {
+                return res;
+            }
+            continue;
+        }
+        if (depth) {
+            tape->entries[frames[depth - 1].entry].count++;
+        }
+        int res = _add(tape, it, (depth < NANOCBOR_RECURSION_MAX) ?
+                                 &frames[depth] : NULL);
+        if (res < 0) {
+            return res;
+        }
+        depth += (size_t)res;
+    }
+}
+
+int nanocbor_tape_child(const nanocbor_tape_t *tape, size_t idx, size_t n,
+                        size_t *child)
+{
+    const nanocbor_tape_entry_t *entry = &tape->entries[idx];
+
+    if (n >= entry->count) {
+        return NANOCBOR_NOT_FOUND;
+    }
+    /* Without nested containers the children are consecutive entries */
+    if (entry->next == idx + 1 + entry->count) {
+        *child = idx + 1 + n;
+        return NANOCBOR_OK;
+    }
+    size_t pos = idx + 1;
+    while (n--) {
+        pos = tape->entries[pos].next;
+    }
+    *child = pos;
+    return NANOCBOR_OK;
+}
+
+void nanocbor_tape_value(const nanocbor_tape_t *tape, size_t idx,
+                         nanocbor_value_t *value)
+{
+    const nanocbor_tape_entry_t *entry = &tape->entries[idx];
+
+    nanocbor_decoder_init(value, tape->buf + entry->offset,
+                          entry->end - entry->offset);
+}
@@ -0,0 +1,129 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @ingroup nanocbor_typed_array
+ * @{
+ * @file
+ * @brief   RFC 8746 typed array implementation
+ * @}
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nanocbor/config.h"
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/typed_array.h"
+
+/* Typed array tags are 0b010fsell: float, signed, little endian (clamped for
+ * uint8) and the log2 of the element size */
+#define TYPED_TAG_FIRST     NANOCBOR_TAG_TYPED_UINT8
+#define TYPED_TAG_LAST      NANOCBOR_TAG_TYPED_FLOAT128_LE
+#define TYPED_TAG_RESERVED  (76U)   /* sint8 with the little endian bit */
+#define TYPED_FLAG_FLOAT    (0x10U)
+#define TYPED_FLAG_LE       (0x04U)
+#define TYPED_SIZE_MASK     (0x03U)
+
+size_t nanocbor_typed_array_elem_size(uint32_t tag)
+{
+    if (tag < TYPED_TAG_FIRST || tag > TYPED_TAG_LAST ||
+        tag == TYPED_TAG_RESERVED) {
+        return 0;
+    }
+    /* Floats start at 16 bit */
+    size_t base = (tag & TYPED_FLAG_FLOAT) ? 2U : 1U;
+    return base << (tag & TYPED_SIZE_MASK);
+}
+
+/* Tag of the same element type in the host byte order */
+static uint32_t _native_tag(uint32_t tag, size_t size)
+{
+    if (size == 1) {
+        /* Byte order doesn't apply, the flag means clamped for uint8 */
+        return tag;
+    }
+    return NANOCBOR_HOST_BIG_ENDIAN ? (tag & ~TYPED_FLAG_LE)
+                                    : (tag | TYPED_FLAG_LE);
+}
+
+int nanocbor_put_typed_array(nanocbor_encoder_t *enc, uint32_t tag,
+                             const void *data, size_t num)
+{
+    size_t size = nanocbor_typed_array_elem_size(tag);
+
+    if (size == 0) {
+        return NANOCBOR_ERR_INVALID_TYPE;
+    }
+    if (num > SIZE_MAX / size) {
+        return NANOCBOR_ERR_OVERFLOW;
+    }
+    int res = nanocbor_fmt_tag(enc, tag);
+    if (res < 0) {
+        return res;
+    }
+    return nanocbor_put_bstr(enc, data, num * size);
+}
+
+int nanocbor_get_typed_array(nanocbor_value_t *it, nanocbor_typed_array_t *arr)
+{
+    nanocbor_value_t tmp = *it;
+    uint32_t tag = 0;
+    const uint8_t *buf = NULL;
+    size_t len = 0;
+
+    int res = nanocbor_get_tag(&tmp, &tag);
+    if (res < 0) {
+        return res;
+    }
+    size_t size = nanocbor_typed_array_elem_size(tag);
+    if (size == 0) {
+        return NANOCBOR_ERR_INVALID_TYPE;
+    }
+    res = nanocbor_get_bstr(&tmp, &buf, &len);
+    if (res < 0) {
+        return res;
+    }
+    if (len % size) {
+        return NANOCBOR_ERR_INVALID_TYPE;
+    }
+    arr->buf = buf;
+    arr->num = len / size;
+    arr->tag = tag;
+    arr->type = _native_tag(tag, size);
+    arr->size = (uint8_t)size;
+    *it = tmp;
+    return NANOCBOR_OK;
+}
+
+const void *nanocbor_typed_array_view(const nanocbor_typed_array_t *arr)
+{
+    if (arr->tag == arr->type && ((uintptr_t)arr->buf % arr->size) == 0) {
+        return arr->buf;
+    }
+    return NULL;
+}
+
+size_t nanocbor_typed_array_copy(const nanocbor_typed_array_t *arr, void *out,
+                                 size_t max)
+{
+    size_t num = (arr->num < max) ? arr->num : max;
+    uint8_t *dst = out;
+
+    if (arr->tag == arr->type) {
+        memcpy(dst, arr->buf, num * arr->size);
+        return num;
+    }
+    /* Reverse the bytes of every element */
+    for (size_t i = 0; i < num; i++) {
+        const uint8_t *src = arr->buf + i * arr->size;
+        for (size_t j = 0; j < arr->size; j++) {
+            dst[j] = src[arr->size - 1 - j];
+        }
+        dst += arr->size;
+    }
+    return num;
+}
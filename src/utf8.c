@@ -0,0 +1,127 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @ingroup nanocbor
+ * @{
+ * @file
+ * @brief   UTF-8 validation for text strings
+ * @}
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "nanocbor/config.h"
+#include "nanocbor/nanocbor.h"
+
+#if NANOCBOR_UTF8_SIMD && defined(__AVX2__)
+#include <immintrin.h>
+#define NANOCBOR_UTF8_SIMD_AVX2
+#define NANOCBOR_UTF8_BLOCK (32U)
+#elif NANOCBOR_UTF8_SIMD && defined(__SSE2__)
+#include <emmintrin.h>
+#define NANOCBOR_UTF8_SIMD_SSE2
+#define NANOCBOR_UTF8_BLOCK (16U)
+#elif NANOCBOR_UTF8_SIMD && defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define NANOCBOR_UTF8_SIMD_NEON
+#define NANOCBOR_UTF8_BLOCK (16U)
+#endif
+
+#define UTF8_ASCII_MAX      (0x7FU)
+#define UTF8_CONT_MASK      (0xC0U)
+#define UTF8_CONT           (0x80U)
+#define UTF8_CONT_MAX       (0xBFU)
+
+/* Length of the valid sequence at @p buf, 0 when invalid or truncated.
+ * Overlong encodings, surrogates and code points above U+10FFFF are
+ * rejected by narrowing the range of the second byte. */
+static size_t _sequence(const uint8_t *buf, size_t len)
+{
+    uint8_t lead = buf[0];
+    uint8_t lo = UTF8_CONT;
+    uint8_t hi = UTF8_CONT_MAX;
+    size_t num = 0;
+
+    if (lead <= UTF8_ASCII_MAX) {
+        return 1;
+    }
+    if (lead < 0xC2U) {
+        return 0;
+    }
+    if (lead < 0xE0U) {
+        num = 2;
+    }
+    else if (lead < 0xF0U) {
+        num = 3;
+        lo = lead == 0xE0U ? 0xA0U : lo;
+        hi = lead == 0xEDU ? 0x9FU : hi;
+    }
+    else if (lead < 0xF5U) {
+        num = 4;
+        lo = lead == 0xF0U ? 0x90U : lo;
+        hi = lead == 0xF4U ? 0x8FU : hi;
+    }
+    else {
+        return 0;
+    }
+    if (len < num || buf[1] < lo || buf[1] > hi) {
+        return 0;
+    }
+    for (size_t i = 2; i < num; i++) {
+        if ((buf[i] & UTF8_CONT_MASK) != UTF8_CONT) {
+            return 0;
+        }
+    }
+    return num;
+}
+
+#ifdef NANOCBOR_UTF8_BLOCK
+/* Number of ASCII bytes at the start of the block at @p buf */
+static inline unsigned _ascii_prefix(const uint8_t *buf)
+{
+#if defined(NANOCBOR_UTF8_SIMD_AVX2)
+    __m256i bytes = _mm256_loadu_si256((const __m256i *)(const void *)buf);
+    unsigned mask = (unsigned)_mm256_movemask_epi8(bytes);
+    return mask ? (unsigned)__builtin_ctz(mask) : NANOCBOR_UTF8_BLOCK;
+#elif defined(NANOCBOR_UTF8_SIMD_SSE2)
+    __m128i bytes = _mm_loadu_si128((const __m128i *)(const void *)buf);
+    unsigned mask = (unsigned)_mm_movemask_epi8(bytes);
+    return mask ? (unsigned)__builtin_ctz(mask) : NANOCBOR_UTF8_BLOCK;
+#else
+    uint8x16_t high = vcgtq_u8(vld1q_u8(buf), vdupq_n_u8(UTF8_ASCII_MAX));
+    /* Narrow to four bits per byte to get a scalar mask */
+    uint8x8_t narrow = vshrn_n_u16(vreinterpretq_u16_u8(high), 4);
+    uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(narrow), 0);
+    return mask ? (unsigned)__builtin_ctzll(mask) / 4U : NANOCBOR_UTF8_BLOCK;
+#endif
+}
+#endif
+
+bool nanocbor_utf8_valid(const uint8_t *buf, size_t len)
+{
+    const uint8_t *end = buf + len;
+
+    while (buf < end) {
+#ifdef NANOCBOR_UTF8_BLOCK
+        /* Skip ASCII a block at a time, up to the first other byte */
+        if ((size_t)(end - buf) >= NANOCBOR_UTF8_BLOCK) {
+            unsigned ascii = _ascii_prefix(buf);
+            buf += ascii;
+            if (ascii == NANOCBOR_UTF8_BLOCK) {
+                continue;
+            }
+        }
+#endif
+        size_t num = _sequence(buf, (size_t)(end - buf));
+        if (num == 0) {
+            return false;
+        }
+        buf += num;
+    }
+    return true;
+}
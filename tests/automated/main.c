@@ -12,6 +12,18 @@
 
 extern const test_t tests_decoder[];
 extern const test_t tests_encoder[];
+extern const test_t tests_map_index[];
+extern const test_t tests_schema[];
+extern const test_t tests_typed_array[];
+extern const test_t tests_iovec[];
+extern const test_t tests_sequence[];
+extern const test_t tests_tape[];
+extern const test_t tests_query[];
+extern const test_t tests_canonical[];
+extern const test_t tests_inline[];
+extern const test_t tests_dom[];
+extern const test_t tests_stats[];
+extern const test_t tests_cddl[];
 
 static int add_tests(CU_pSuite pSuite, const test_t* tests)
 {
@@ -45,6 +57,90 @@ int main()
     }
     add_tests(pSuite, tests_encoder);
 
+    pSuite = CU_add_suite("Nanocbor map index", NULL, NULL);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    add_tests(pSuite, tests_map_index);
+
+    pSuite = CU_add_suite("Nanocbor schema", NULL, NULL);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    add_tests(pSuite, tests_schema);
+
+    pSuite = CU_add_suite("Nanocbor typed array", NULL, NULL);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    add_tests(pSuite, tests_typed_array);
+
+    pSuite = CU_add_suite("Nanocbor scatter-gather encoder", NULL, NULL);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    add_tests(pSuite, tests_iovec);
+
+    pSuite = CU_add_suite("Nanocbor sequence", NULL, NULL);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    add_tests(pSuite, tests_sequence);
+
+    pSuite = CU_add_suite("Nanocbor tape", NULL, NULL);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    add_tests(pSuite, tests_tape);
+
+    pSuite = CU_add_suite("Nanocbor query", NULL, NULL);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    add_tests(pSuite, tests_query);
+
+    pSuite = CU_add_suite("Nanocbor canonical", NULL, NULL);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    add_tests(pSuite, tests_canonical);
+
+    pSuite = CU_add_suite("Nanocbor inline", NULL, NULL);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    add_tests(pSuite, tests_inline);
+
+    pSuite = CU_add_suite("Nanocbor document tree", NULL, NULL);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    add_tests(pSuite, tests_dom);
+
+    pSuite = CU_add_suite("Nanocbor statistics", NULL, NULL);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    add_tests(pSuite, tests_stats);
+
+    pSuite = CU_add_suite("Nanocbor CDDL generated code", NULL, NULL);
+    if (NULL == pSuite) {
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    add_tests(pSuite, tests_cddl);
+
     CU_basic_set_mode(CU_BRM_VERBOSE);
     CU_basic_run_tests();
     printf("\n");
@@ -0,0 +1,174 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include "test.h"
+#include "nanocbor/config.h"
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/canonical.h"
+#include <CUnit/CUnit.h>
+#include <string.h>
+
+static void test_canonical_map_end(void)
+{
+    /* {1: 0, 10: {"a": 0, "b": 1}, 100: 2, -1: 3, "a": [4]} */
+    static const uint8_t expected[] = {
+        0xa5, 0x01, 0x00, 0x0a, 0xa2, 0x61, 0x61, 0x00, 0x61, 0x62, 0x01,
+        0x18, 0x64, 0x02, 0x20, 0x03, 0x61, 0x61, 0x81, 0x04,
+    };
+    nanocbor_canonical_entry_t scratch[5];
+    nanocbor_deferred_t map;
+    nanocbor_deferred_t inner;
+    nanocbor_encoder_t enc;
+    nanocbor_value_t it;
+    uint8_t buf[64];
+
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    CU_ASSERT_EQUAL(nanocbor_fmt_map_begin(&enc, &map), NANOCBOR_OK);
+    nanocbor_put_tstr(&enc, "a");
+    nanocbor_fmt_array(&enc, 1);
+    nanocbor_fmt_uint(&enc, 4);
+    nanocbor_fmt_uint(&enc, 100);
+    nanocbor_fmt_uint(&enc, 2);
+    nanocbor_fmt_uint(&enc, 10);
+    CU_ASSERT_EQUAL(nanocbor_fmt_map_begin(&enc, &inner), NANOCBOR_OK);
+    nanocbor_put_tstr(&enc, "b");
+    nanocbor_fmt_uint(&enc, 1);
+    nanocbor_put_tstr(&enc, "a");
+    nanocbor_fmt_uint(&enc, 0);
+    CU_ASSERT_EQUAL(nanocbor_canonical_map_end(&enc, &inner, scratch, 5),
+                    NANOCBOR_OK);
+    nanocbor_fmt_int(&enc, -1);
+    nanocbor_fmt_uint(&enc, 3);
+    nanocbor_fmt_uint(&enc, 1);
+    nanocbor_fmt_uint(&enc, 0);
+    CU_ASSERT_EQUAL(nanocbor_canonical_map_end(&enc, &map, scratch, 5),
+                    NANOCBOR_OK);
+
+    CU_ASSERT_EQUAL(nanocbor_encoded_len(&enc), sizeof(expected));
+    CU_ASSERT_EQUAL(memcmp(buf, expected, sizeof(expected)), 0);
+
+    nanocbor_decoder_init(&it, buf, nanocbor_encoded_len(&enc));
+    CU_ASSERT_EQUAL(nanocbor_canonical_check(&it), NANOCBOR_OK);
+    CU_ASSERT(nanocbor_at_end(&it));
+}
+
+static void test_canonical_map_errors(void)
+{
+    nanocbor_canonical_entry_t scratch[2];
+    nanocbor_deferred_t map;
+    nanocbor_encoder_t enc;
+    uint8_t buf[32];
+
+    /* Duplicate key, the buffer is left untouched */
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    nanocbor_fmt_map_begin(&enc, &map);
+    nanocbor_fmt_uint(&enc, 2);
+    nanocbor_fmt_uint(&enc, 0);
+    nanocbor_fmt_uint(&enc, 2);
+    nanocbor_fmt_uint(&enc, 1);
+    CU_ASSERT_EQUAL(nanocbor_canonical_map_end(&enc, &map, scratch, 2),
+                    NANOCBOR_ERR_INVALID_TYPE);
+
+    /* More entries than scratch */
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    nanocbor_fmt_map_begin(&enc, &map);
+    for (unsigned i = 0; i < 3; i++) {
+        nanocbor_fmt_uint(&enc, i);
+        nanocbor_fmt_uint(&enc, i);
+    }
+    CU_ASSERT_EQUAL(nanocbor_canonical_map_end(&enc, &map, scratch, 2),
+                    NANOCBOR_ERR_OVERFLOW);
+
+    /* Key without a value */
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    nanocbor_fmt_map_begin(&enc, &map);
+    nanocbor_fmt_uint(&enc, 1);
+    CU_ASSERT_EQUAL(nanocbor_canonical_map_end(&enc, &map, scratch, 2),
+                    NANOCBOR_ERR_INVALID_TYPE);
+
+    /* Not a map */
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    nanocbor_fmt_array_begin(&enc, &map);
+    CU_ASSERT_EQUAL(nanocbor_canonical_map_end(&enc, &map, scratch, 2),
+                    NANOCBOR_ERR_INVALID_TYPE);
+}
+
+static int _check(const uint8_t *buf, size_t len)
+{
+    nanocbor_value_t it;
+    nanocbor_decoder_init(&it, buf, len);
+    return nanocbor_canonical_check(&it);
+}
+
+#define CHECK(res, ...) \
+    do { \
+        static const uint8_t _buf[] = { __VA_ARGS__ }; \
+        CU_ASSERT_EQUAL(_check(_buf, sizeof(_buf)), res); \
+    } while (0)
+
+static void test_canonical_check(void)
+{
+    /* Shortest forms */
+    CHECK(NANOCBOR_OK, 0x17);
+    CHECK(NANOCBOR_OK, 0x18, 0x18);
+    CHECK(NANOCBOR_OK, 0x39, 0x01, 0x00);
+    CHECK(NANOCBOR_OK, 0x61, 0x61);
+    CHECK(NANOCBOR_OK, 0xc1, 0x1a, 0x00, 0x01, 0x00, 0x00);
+    CHECK(NANOCBOR_OK, 0xf5);
+    CHECK(NANOCBOR_OK, 0xf8, 0x20);
+    CHECK(NANOCBOR_OK, 0xf9, 0x3c, 0x00);
+    CHECK(NANOCBOR_OK, 0xfa, 0x3d, 0xcc, 0xcc, 0xcd);
+    CHECK(NANOCBOR_OK, 0xfb, 0x3f, 0xb9, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9a);
+    /* {1: 0, [1]: 0, 1("a"): 0} */
+    CHECK(NANOCBOR_OK, 0xa3, 0x01, 0x00, 0x81, 0x01, 0x00, 0xc1, 0x61, 0x61,
+          0x00);
+
+    /* Longer forms than needed */
+    CHECK(NANOCBOR_ERR_INVALID_TYPE, 0x18, 0x17);
+    CHECK(NANOCBOR_ERR_INVALID_TYPE, 0x19, 0x00, 0xff);
+    CHECK(NANOCBOR_ERR_INVALID_TYPE, 0x1a, 0x00, 0x00, 0xff, 0xff);
+    CHECK(NANOCBOR_ERR_INVALID_TYPE, 0x1b, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff,
+          0xff, 0xff);
+    CHECK(NANOCBOR_ERR_INVALID_TYPE, 0x78, 0x01, 0x61);
+    CHECK(NANOCBOR_ERR_INVALID_TYPE, 0x81, 0xd8, 0x01, 0x00);
+    CHECK(NANOCBOR_ERR_INVALID_TYPE, 0xf8, 0x14);
+    CHECK(NANOCBOR_ERR_INVALID_TYPE, 0xfa, 0x3f, 0x80, 0x00, 0x00);
+    CHECK(NANOCBOR_ERR_INVALID_TYPE, 0xfb, 0x3f, 0xf0, 0x00, 0x00, 0x00, 0x00,
+          0x00, 0x00);
+
+    /* Indefinite lengths */
+    CHECK(NANOCBOR_ERR_INVALID_TYPE, 0x9f, 0xff);
+    CHECK(NANOCBOR_ERR_INVALID_TYPE, 0x7f, 0x61, 0x61, 0xff);
+
+    /* Unsorted and duplicate keys, also in a nested map */
+    CHECK(NANOCBOR_ERR_INVALID_TYPE, 0xa2, 0x02, 0x00, 0x01, 0x00);
+    CHECK(NANOCBOR_ERR_INVALID_TYPE, 0xa2, 0x01, 0x00, 0x01, 0x00);
+    CHECK(NANOCBOR_ERR_INVALID_TYPE, 0xa2, 0x20, 0x00, 0x18, 0x64, 0x00);
+    CHECK(NANOCBOR_ERR_INVALID_TYPE, 0x81, 0xa2, 0x61, 0x62, 0x00, 0x61, 0x61,
+          0x00);
+
+    /* Truncated */
+    CHECK(NANOCBOR_ERR_END, 0x82, 0x01);
+    CHECK(NANOCBOR_ERR_END, 0x62, 0x61);
+    CHECK(NANOCBOR_ERR_END, 0x19, 0x01);
+}
+
+const test_t tests_canonical[] = {
+    {
+        .f = test_canonical_map_end,
+        .n = "Canonical map sort test",
+    },
+    {
+        .f = test_canonical_map_errors,
+        .n = "Canonical map sort error test",
+    },
+    {
+        .f = test_canonical_check,
+        .n = "Canonical encoding check test",
+    },
+    {
+        .f = NULL,
+        .n = NULL,
+    }
+};
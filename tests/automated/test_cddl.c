@@ -0,0 +1,256 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/* Tests for the code generated from test_cddl.cddl */
+
+#include "test.h"
+#include "nanocbor/nanocbor.h"
+#include "messages.h"
+#include <CUnit/CUnit.h>
+#include <string.h>
+
+#ifdef MSG_UNBOUNDED_MAX_SIZE
+#error "Unbounded strings must not have a size bound"
+#endif
+
+static size_t _encode_record(uint8_t *buf, size_t len, const msg_record_t *rec)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, buf, len);
+    if (msg_record_encode(&enc, rec) < 0) {
+        return 0;
+    }
+    return nanocbor_encoded_len(&enc);
+}
+
+static void test_cddl_record(void)
+{
+    uint8_t expected[64];
+    uint8_t buf[MSG_RECORD_MAX_SIZE];
+    msg_record_t rec = {
+        .k1 = 1000,
+        .value_key = -5,
+        .has_k3 = true,
+        .k3 = { (const uint8_t *)"abc", 3 },
+        .n = { (const uint8_t *)"name", 4 },
+        .ok = true,
+    };
+    msg_record_t out;
+    nanocbor_encoder_t enc;
+    nanocbor_value_t it;
+
+    /* Same as the hand written encoding */
+    nanocbor_encoder_init(&enc, expected, sizeof(expected));
+    nanocbor_fmt_map(&enc, 5);
+    nanocbor_fmt_uint(&enc, 1);
+    nanocbor_fmt_uint(&enc, 1000);
+    nanocbor_fmt_uint(&enc, 2);
+    nanocbor_fmt_int(&enc, -5);
+    nanocbor_fmt_uint(&enc, 3);
+    nanocbor_put_tstr(&enc, "abc");
+    nanocbor_put_tstr(&enc, "n");
+    nanocbor_put_tstr(&enc, "name");
+    nanocbor_put_tstr(&enc, "ok");
+    nanocbor_fmt_bool(&enc, true);
+    size_t len = _encode_record(buf, sizeof(buf), &rec);
+    CU_ASSERT_EQUAL(len, nanocbor_encoded_len(&enc));
+    CU_ASSERT_EQUAL(memcmp(buf, expected, len), 0);
+
+    memset(&out, 0, sizeof(out));
+    nanocbor_decoder_init(&it, buf, len);
+    CU_ASSERT_EQUAL(msg_record_decode(&it, &out), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(out.k1, 1000);
+    CU_ASSERT_EQUAL(out.value_key, -5);
+    CU_ASSERT_TRUE(out.has_k3);
+    CU_ASSERT_EQUAL(out.k3.len, 3);
+    CU_ASSERT_EQUAL(memcmp(out.k3.buf, "abc", 3), 0);
+    CU_ASSERT_EQUAL(out.n.len, 4);
+    CU_ASSERT_FALSE(out.has_unit);
+    CU_ASSERT_TRUE(out.ok);
+    CU_ASSERT_TRUE(nanocbor_at_end(&it));
+
+    /* The largest record fits in the size bound */
+    rec.k1 = UINT64_MAX;
+    rec.value_key = INT32_MIN;
+    rec.k3.buf = (const uint8_t *)"0123456789abcdef";
+    rec.k3.len = 16;
+    rec.n.buf = (const uint8_t *)"01234567";
+    rec.n.len = 8;
+    rec.has_unit = true;
+    CU_ASSERT_EQUAL(_encode_record(buf, sizeof(buf), &rec), sizeof(buf));
+
+    /* Strings over the size limit */
+    rec.n.len = 9;
+    CU_ASSERT_EQUAL(_encode_record(buf, sizeof(buf), &rec), 0);
+}
+
+static void test_cddl_record_decode(void)
+{
+    /* {"ok": false, 99: [1, 2], 2: 7, "n": "x", 1: 0, 1: 5} */
+    static const uint8_t unordered[] = {
+        0xa6, 0x62, 0x6f, 0x6b, 0xf4, 0x18, 0x63, 0x82, 0x01, 0x02, 0x02,
+        0x07, 0x61, 0x6e, 0x61, 0x78, 0x01, 0x00, 0x01, 0x05,
+    };
+    /* {1: 0, 2: 0, "ok": true} */
+    static const uint8_t missing[] = {
+        0xa3, 0x01, 0x00, 0x02, 0x00, 0x62, 0x6f, 0x6b, 0xf5,
+    };
+    /* {1: 0, 2: 0, "n": "012345678", "ok": true} */
+    static const uint8_t long_name[] = {
+        0xa4, 0x01, 0x00, 0x02, 0x00, 0x61, 0x6e, 0x69, 0x30, 0x31, 0x32,
+        0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x62, 0x6f, 0x6b, 0xf5,
+    };
+    /* {1: "a", ...} */
+    static const uint8_t wrong_type[] = { 0xa1, 0x01, 0x61, 0x61 };
+    msg_record_t out;
+    nanocbor_value_t it;
+
+    memset(&out, 0, sizeof(out));
+    nanocbor_decoder_init(&it, unordered, sizeof(unordered));
+    CU_ASSERT_EQUAL(msg_record_decode(&it, &out), NANOCBOR_OK);
+    CU_ASSERT_FALSE(out.ok);
+    CU_ASSERT_EQUAL(out.value_key, 7);
+    /* The first occurrence is used */
+    CU_ASSERT_EQUAL(out.k1, 0);
+    CU_ASSERT_EQUAL(out.n.len, 1);
+    CU_ASSERT_PTR_EQUAL(out.n.buf, unordered + 15);
+    CU_ASSERT_FALSE(out.has_k3);
+    CU_ASSERT_PTR_EQUAL(it.cur, unordered + sizeof(unordered));
+
+    nanocbor_decoder_init(&it, missing, sizeof(missing));
+    CU_ASSERT_EQUAL(msg_record_decode(&it, &out), NANOCBOR_NOT_FOUND);
+    nanocbor_decoder_init(&it, long_name, sizeof(long_name));
+    CU_ASSERT_EQUAL(msg_record_decode(&it, &out), NANOCBOR_ERR_OVERFLOW);
+    nanocbor_decoder_init(&it, wrong_type, sizeof(wrong_type));
+    CU_ASSERT_EQUAL(msg_record_decode(&it, &out), NANOCBOR_ERR_INVALID_TYPE);
+    nanocbor_decoder_init(&it, unordered, sizeof(unordered) - 1);
+    CU_ASSERT(msg_record_decode(&it, &out) < 0);
+}
+
+static void test_cddl_array(void)
+{
+    /* [1, -51, 0.0] and [1, 0, 0.0, 0] */
+    static const uint8_t below[] = { 0x83, 0x01, 0x38, 0x32, 0xf9, 0x00, 0x00 };
+    static const uint8_t extra[] = {
+        0x84, 0x01, 0x00, 0xf9, 0x00, 0x00, 0x00,
+    };
+    uint8_t buf[MSG_READINGS_MAX_SIZE];
+    msg_readings_t readings = { .count = 2 };
+    msg_readings_t out;
+    msg_reading_t reading;
+    nanocbor_encoder_t enc;
+    nanocbor_value_t it;
+
+    readings.items[0].id = 1;
+    readings.items[0].temp = -50;
+    readings.items[0].humidity = 0.5f;
+    readings.items[1].id = 65535;
+    readings.items[1].temp = 150;
+    readings.items[1].humidity = 1.1f;
+
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    CU_ASSERT_EQUAL(msg_readings_encode(&enc, &readings), NANOCBOR_OK);
+    nanocbor_decoder_init(&it, buf, nanocbor_encoded_len(&enc));
+    CU_ASSERT_EQUAL(msg_readings_decode(&it, &out), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(out.count, 2);
+    CU_ASSERT_EQUAL(out.items[0].temp, -50);
+    CU_ASSERT_EQUAL(out.items[1].id, 65535);
+    CU_ASSERT_EQUAL(out.items[1].temp, 150);
+    CU_ASSERT_EQUAL(out.items[1].humidity, 1.1f);
+
+    /* Full array of the largest readings fits the bound */
+    readings.count = 4;
+    for (unsigned i = 0; i < 4; i++) {
+        readings.items[i] = readings.items[1];
+    }
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    CU_ASSERT_EQUAL(msg_readings_encode(&enc, &readings), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_encoded_len(&enc), sizeof(buf));
+
+    /* Too many items in the encoded array */
+    uint8_t big[64];
+    nanocbor_encoder_init(&enc, big, sizeof(big));
+    nanocbor_fmt_array(&enc, 5);
+    for (unsigned i = 0; i < 5; i++) {
+        msg_reading_encode(&enc, &readings.items[0]);
+    }
+    nanocbor_decoder_init(&it, big, nanocbor_encoded_len(&enc));
+    CU_ASSERT_EQUAL(msg_readings_decode(&it, &out), NANOCBOR_ERR_OVERFLOW);
+
+    /* Too few */
+    readings.count = 0;
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    CU_ASSERT_EQUAL(msg_readings_encode(&enc, &readings), NANOCBOR_ERR_OVERFLOW);
+    nanocbor_decoder_init(&it, (const uint8_t *)"\x80", 1);
+    CU_ASSERT_EQUAL(msg_readings_decode(&it, &out), NANOCBOR_ERR_INVALID_TYPE);
+
+    /* Out of range */
+    reading.id = 1;
+    reading.temp = 151;
+    reading.humidity = 0;
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    CU_ASSERT_EQUAL(msg_reading_encode(&enc, &reading), NANOCBOR_ERR_OVERFLOW);
+    nanocbor_decoder_init(&it, below, sizeof(below));
+    CU_ASSERT_EQUAL(msg_reading_decode(&it, &reading), NANOCBOR_ERR_OVERFLOW);
+    nanocbor_decoder_init(&it, extra, sizeof(extra));
+    CU_ASSERT_EQUAL(msg_reading_decode(&it, &reading),
+                    NANOCBOR_ERR_INVALID_TYPE);
+}
+
+static void test_cddl_nested(void)
+{
+    static const uint8_t data[32] = { 0xaa };
+    uint8_t buf[MSG_BATCH_MAX_SIZE];
+    msg_batch_t batch = {
+        .k1 = { .count = 4 },
+        .km1 = { data, sizeof(data) },
+    };
+    msg_batch_t out;
+    nanocbor_encoder_t enc;
+    nanocbor_value_t it;
+
+    for (unsigned i = 0; i < 4; i++) {
+        batch.k1.items[i].id = (uint16_t)(60000 + i);
+        batch.k1.items[i].temp = -40;
+        batch.k1.items[i].humidity = 0.1f;
+    }
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    CU_ASSERT_EQUAL(msg_batch_encode(&enc, &batch), NANOCBOR_OK);
+    CU_ASSERT(nanocbor_encoded_len(&enc) <= MSG_BATCH_MAX_SIZE);
+
+    nanocbor_decoder_init(&it, buf, nanocbor_encoded_len(&enc));
+    CU_ASSERT_EQUAL(msg_batch_decode(&it, &out), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(out.k1.count, 4);
+    CU_ASSERT_EQUAL(out.k1.items[3].id, 60003);
+    CU_ASSERT_EQUAL(out.km1.len, sizeof(data));
+    CU_ASSERT_EQUAL(memcmp(out.km1.buf, data, sizeof(data)), 0);
+
+    /* Doesn't fit a smaller buffer */
+    nanocbor_encoder_init(&enc, buf, 16);
+    CU_ASSERT_EQUAL(msg_batch_encode(&enc, &batch), NANOCBOR_ERR_END);
+}
+
+const test_t tests_cddl[] = {
+    {
+        .f = test_cddl_record,
+        .n = "Generated map encoder test",
+    },
+    {
+        .f = test_cddl_record_decode,
+        .n = "Generated map decoder test",
+    },
+    {
+        .f = test_cddl_array,
+        .n = "Generated array encoder and decoder test",
+    },
+    {
+        .f = test_cddl_nested,
+        .n = "Generated nested type test",
+    },
+    {
+        .f = NULL,
+        .n = NULL,
+    }
+};
@@ -3,8 +3,11 @@
  */
 
 #include "test.h"
+#include "nanocbor/config.h"
 #include "nanocbor/nanocbor.h"
+#include <math.h>
 #include <CUnit/CUnit.h>
+#include <string.h>
 
 static void test_decode_indefinite(void)
 {
@@ -189,6 +192,575 @@ static void test_decode_basic(void)
     CU_ASSERT_EQUAL(m, 27315);
 }
 
+static void test_decode_int64(void)
+{
+    static const uint8_t ints[] = {
+        0x1b, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x01, /* 2^32 + 1 */
+        0x3b, 0x7f, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, /* INT64_MIN */
+        0x1b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, /* UINT64_MAX */
+        0x17,
+    };
+    nanocbor_value_t val;
+    uint64_t utmp = 0;
+    int64_t itmp = 0;
+    uint32_t tmp = 0;
+
+    nanocbor_decoder_init(&val, ints, sizeof(ints));
+    CU_ASSERT_EQUAL(nanocbor_get_uint32(&val, &tmp), NANOCBOR_ERR_OVERFLOW);
+    CU_ASSERT_EQUAL(nanocbor_get_int64(&val, &itmp), 9);
+    CU_ASSERT_EQUAL(itmp, 0x100000001LL);
+
+    CU_ASSERT_EQUAL(nanocbor_get_uint64(&val, &utmp), NANOCBOR_ERR_INVALID_TYPE);
+    CU_ASSERT_EQUAL(nanocbor_get_int64(&val, &itmp), 9);
+    CU_ASSERT_EQUAL(itmp, INT64_MIN);
+
+    CU_ASSERT_EQUAL(nanocbor_get_int64(&val, &itmp), NANOCBOR_ERR_OVERFLOW);
+    CU_ASSERT_EQUAL(nanocbor_get_uint64(&val, &utmp), 9);
+    CU_ASSERT_EQUAL(utmp, UINT64_MAX);
+
+    CU_ASSERT_EQUAL(nanocbor_get_uint64(&val, &utmp), 1);
+    CU_ASSERT_EQUAL(utmp, 23);
+    CU_ASSERT_EQUAL(nanocbor_at_end(&val), true);
+
+    /* Truncated value */
+    nanocbor_decoder_init(&val, ints, 8);
+    CU_ASSERT_EQUAL(nanocbor_get_uint64(&val, &utmp), NANOCBOR_ERR_END);
+}
+
+static void test_decode_float(void)
+{
+    static const uint8_t floats[] = {
+        0xf9, 0x00, 0x01,                         /* 5.960464477539063e-8 */
+        0xf9, 0x7b, 0xff,                         /* 65504.0 */
+        0xf9, 0xc4, 0x00,                         /* -4.0 */
+        0xf9, 0x80, 0x00,                         /* -0.0 */
+        0xf9, 0x7c, 0x00,                         /* Infinity */
+        0xf9, 0x7e, 0x00,                         /* NaN */
+        0xfa, 0x47, 0xc3, 0x50, 0x00,             /* 100000.0 */
+        0xfb, 0x3f, 0xf1, 0x99, 0x99, 0x99, 0x99, 0x99, 0x9a, /* 1.1 */
+        0xf5,                                     /* true */
+    };
+    nanocbor_value_t val;
+    float ftmp = 0;
+    double dtmp = 0;
+
+    nanocbor_decoder_init(&val, floats, sizeof(floats));
+    CU_ASSERT_EQUAL(nanocbor_get_float(&val, &ftmp), 3);
+    CU_ASSERT_EQUAL(ftmp, 5.960464477539063e-8f);
+    CU_ASSERT_EQUAL(nanocbor_get_float(&val, &ftmp), 3);
+    CU_ASSERT_EQUAL(ftmp, 65504.0f);
+    CU_ASSERT_EQUAL(nanocbor_get_double(&val, &dtmp), 3);
+    CU_ASSERT_EQUAL(dtmp, -4.0);
+    CU_ASSERT_EQUAL(nanocbor_get_float(&val, &ftmp), 3);
+    CU_ASSERT_EQUAL(ftmp, 0.0f);
+    CU_ASSERT(signbit(ftmp));
+    CU_ASSERT_EQUAL(nanocbor_get_float(&val, &ftmp), 3);
+    CU_ASSERT(isinf(ftmp) && ftmp > 0);
+    CU_ASSERT_EQUAL(nanocbor_get_double(&val, &dtmp), 3);
+    CU_ASSERT(isnan(dtmp));
+    CU_ASSERT_EQUAL(nanocbor_get_float(&val, &ftmp), 5);
+    CU_ASSERT_EQUAL(ftmp, 100000.0f);
+    CU_ASSERT_EQUAL(nanocbor_get_float(&val, &ftmp), NANOCBOR_ERR_OVERFLOW);
+    CU_ASSERT_EQUAL(nanocbor_get_double(&val, &dtmp), 9);
+    CU_ASSERT_EQUAL(dtmp, 1.1);
+    CU_ASSERT_EQUAL(nanocbor_get_float(&val, &ftmp), NANOCBOR_ERR_INVALID_TYPE);
+    CU_ASSERT_EQUAL(nanocbor_get_double(&val, &dtmp), NANOCBOR_ERR_INVALID_TYPE);
+
+    /* Round trip through the encoder, including float reduction */
+    static const double values[] = { 1.75, -2.0009765625, 0.34, 1e39, -1e-40 };
+    uint8_t buf[64];
+    nanocbor_encoder_t enc;
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        nanocbor_fmt_double(&enc, values[i]);
+    }
+    nanocbor_decoder_init(&val, buf, nanocbor_encoded_len(&enc));
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        CU_ASSERT(nanocbor_get_double(&val, &dtmp) > 0);
+        CU_ASSERT_EQUAL(dtmp, values[i]);
+    }
+    CU_ASSERT_EQUAL(nanocbor_at_end(&val), true);
+}
+
+static void test_decode_skip(void)
+{
+    /* [{1: [tag(1) 2, "ab"], 3: [_ h'01', {_ 4: 5}]}, 6] */
+    static const uint8_t nested[] = {
+        0x82, 0xa2, 0x01, 0x82, 0xc1, 0x02, 0x62, 0x61, 0x62, 0x03, 0x9f, 0x41,
+        0x01, 0xbf, 0x04, 0x05, 0xff, 0xff, 0x06
+    };
+    nanocbor_value_t val;
+    nanocbor_value_t arr;
+    uint32_t tmp = 0;
+
+    nanocbor_decoder_init(&val, nested, sizeof(nested));
+    CU_ASSERT_EQUAL(nanocbor_skip(&val), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_at_end(&val), true);
+
+    nanocbor_decoder_init(&val, nested, sizeof(nested));
+    CU_ASSERT_EQUAL(nanocbor_enter_array(&val, &arr), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_skip(&arr), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_container_remaining(&arr), 1);
+    CU_ASSERT(nanocbor_get_uint32(&arr, &tmp) > 0);
+    CU_ASSERT_EQUAL(tmp, 6);
+    CU_ASSERT_EQUAL(nanocbor_at_end(&arr), true);
+
+    /* Truncated input is not consumed */
+    for (size_t len = 0; len < sizeof(nested); len++) {
+        nanocbor_decoder_init(&val, nested, len);
+        CU_ASSERT_EQUAL(nanocbor_skip(&val), NANOCBOR_ERR_END);
+        CU_ASSERT_EQUAL(val.cur, nested);
+    }
+
+    /* Nesting up to the limit, beyond it the skip fails */
+    uint8_t deep[NANOCBOR_RECURSION_MAX + 1];
+    memset(deep, 0x81, sizeof(deep));
+    deep[NANOCBOR_RECURSION_MAX - 1] = 0x80;
+    nanocbor_decoder_init(&val, deep, NANOCBOR_RECURSION_MAX);
+    CU_ASSERT_EQUAL(nanocbor_skip(&val), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_at_end(&val), true);
+
+    deep[NANOCBOR_RECURSION_MAX - 1] = 0x81;
+    deep[NANOCBOR_RECURSION_MAX] = 0x80;
+    nanocbor_decoder_init(&val, deep, sizeof(deep));
+    CU_ASSERT_EQUAL(nanocbor_skip(&val), NANOCBOR_ERR_RECURSION);
+    CU_ASSERT_EQUAL(val.cur, deep);
+}
+
+static void test_decode_skip_scalars(void)
+{
+    uint8_t buf[128];
+    nanocbor_encoder_t enc;
+    nanocbor_value_t val;
+    nanocbor_value_t arr;
+    uint32_t tmp = 0;
+
+    /* [0..39 alternating sign, 1000, -70000, true, 1.5, "x", 3, 2^40], 7 */
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    nanocbor_fmt_array(&enc, 47);
+    for (int i = 0; i < 40; i++) {
+        nanocbor_fmt_int(&enc, (i % 2) ? -(i % 24) : (i % 24));
+    }
+    nanocbor_fmt_int(&enc, 1000);
+    nanocbor_fmt_int(&enc, -70000);
+    nanocbor_fmt_bool(&enc, true);
+    nanocbor_fmt_float(&enc, 1.5);
+    nanocbor_put_tstr(&enc, "x");
+    nanocbor_fmt_uint(&enc, 3);
+    nanocbor_fmt_uint(&enc, 1ULL << 40);
+    nanocbor_fmt_uint(&enc, 7);
+    size_t len = nanocbor_encoded_len(&enc);
+    CU_ASSERT(len <= sizeof(buf));
+
+    nanocbor_decoder_init(&val, buf, len);
+    CU_ASSERT_EQUAL(nanocbor_skip(&val), NANOCBOR_OK);
+    CU_ASSERT(nanocbor_get_uint32(&val, &tmp) > 0);
+    CU_ASSERT_EQUAL(tmp, 7);
+    CU_ASSERT_EQUAL(nanocbor_at_end(&val), true);
+
+    /* Truncated in the middle of a run */
+    for (size_t trunc = 0; trunc < len - 1; trunc++) {
+        nanocbor_decoder_init(&val, buf, trunc);
+        CU_ASSERT_EQUAL(nanocbor_skip(&val), NANOCBOR_ERR_END);
+    }
+
+    /* Map with integer keys and values, followed by a sibling */
+    static const uint8_t map[] = {
+        0x82, 0xa3, 0x01, 0x02, 0x03, 0x18, 0x64, 0x20, 0xf6, 0x05
+    };
+    nanocbor_decoder_init(&val, map, sizeof(map));
+    CU_ASSERT_EQUAL(nanocbor_enter_array(&val, &arr), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_skip(&arr), NANOCBOR_OK);
+    CU_ASSERT(nanocbor_get_uint32(&arr, &tmp) > 0);
+    CU_ASSERT_EQUAL(tmp, 5);
+    CU_ASSERT_EQUAL(nanocbor_at_end(&arr), true);
+}
+
+static void test_decode_key_int(void)
+{
+    /* {1: -7, "x": 0, 4: h'aa', -2: 5, 4: 6, 70000: 1} */
+    static const uint8_t map[] = {
+        0xa6, 0x01, 0x26, 0x61, 0x78, 0x00, 0x04, 0x41, 0xaa, 0x21, 0x05,
+        0x04, 0x06, 0x1a, 0x00, 0x01, 0x11, 0x70, 0x01
+    };
+    static const int32_t keys[] = { 4, -2, 8, 1 };
+    nanocbor_value_t val;
+    nanocbor_value_t cont;
+    nanocbor_value_t found;
+    nanocbor_value_t values[4];
+    int32_t tmp = 0;
+    const uint8_t *buf = NULL;
+    size_t len = 0;
+
+    nanocbor_decoder_init(&val, map, sizeof(map));
+    CU_ASSERT_EQUAL(nanocbor_enter_map(&val, &cont), NANOCBOR_OK);
+
+    CU_ASSERT_EQUAL(nanocbor_get_key_int(&cont, 1, &found), NANOCBOR_OK);
+    CU_ASSERT(nanocbor_get_int32(&found, &tmp) > 0);
+    CU_ASSERT_EQUAL(tmp, -7);
+    CU_ASSERT_EQUAL(nanocbor_get_key_int(&cont, 70000, &found), NANOCBOR_OK);
+    CU_ASSERT(nanocbor_get_int32(&found, &tmp) > 0);
+    CU_ASSERT_EQUAL(tmp, 1);
+    CU_ASSERT_EQUAL(nanocbor_get_key_int(&cont, 3, &found), NANOCBOR_NOT_FOUND);
+
+    CU_ASSERT_EQUAL(nanocbor_get_keys_int(&cont, keys, values, 4), 3);
+    CU_ASSERT_EQUAL(nanocbor_get_bstr(&values[0], &buf, &len), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(len, 1);
+    CU_ASSERT(nanocbor_get_int32(&values[1], &tmp) > 0);
+    CU_ASSERT_EQUAL(tmp, 5);
+    CU_ASSERT_PTR_NULL(values[2].cur);
+    CU_ASSERT(nanocbor_get_int32(&values[3], &tmp) > 0);
+    CU_ASSERT_EQUAL(tmp, -7);
+
+    /* Stops before the truncated part once all keys are found */
+    nanocbor_decoder_init(&val, map, 11);
+    CU_ASSERT_EQUAL(nanocbor_enter_map(&val, &cont), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_get_keys_int(&cont, keys, values, 2), 2);
+    CU_ASSERT_EQUAL(nanocbor_get_keys_int(&cont, keys, values, 3), NANOCBOR_ERR_END);
+}
+
+typedef struct {
+    const uint8_t *input;   /* Full input, delivered in chunks */
+    size_t input_len;
+    size_t input_pos;
+    uint8_t window[8];      /* Bounded decode buffer */
+} _chunked_t;
+
+/* Keep the unconsumed bytes and append the next chunk of 3 bytes */
+static bool _refill(_chunked_t *chunked, nanocbor_value_t *it)
+{
+    size_t pending = nanocbor_decoder_pending(it);
+    size_t chunk = chunked->input_len - chunked->input_pos;
+
+    if (chunk == 0) {
+        return false;
+    }
+    if (chunk > 3) {
+        chunk = 3;
+    }
+    CU_ASSERT(pending + chunk <= sizeof(chunked->window));
+    if (pending) {
+        memmove(chunked->window, it->cur, pending);
+    }
+    memcpy(chunked->window + pending, chunked->input + chunked->input_pos,
+           chunk);
+    chunked->input_pos += chunk;
+    nanocbor_decoder_resume(it, chunked->window, pending + chunk);
+    return true;
+}
+
+static void test_decode_resume(void)
+{
+    /* [1, 1000, "hello", [2, 3], 100000] */
+    static const uint8_t input[] = {
+        0x85, 0x01, 0x19, 0x03, 0xe8, 0x65, 0x68, 0x65, 0x6c, 0x6c, 0x6f,
+        0x82, 0x02, 0x03, 0x1a, 0x00, 0x01, 0x86, 0xa0
+    };
+    _chunked_t chunked = { input, sizeof(input), 0, { 0 } };
+
+    nanocbor_value_t val;
+    nanocbor_value_t arr;
+    nanocbor_value_t inner;
+    uint32_t tmp = 0;
+    const uint8_t *str = NULL;
+    size_t len = 0;
+    int res;
+
+    nanocbor_decoder_init(&val, NULL, 0);
+    while ((res = nanocbor_enter_array(&val, &arr)) == NANOCBOR_ERR_END &&
+           nanocbor_needs_input(&val) && _refill(&chunked, &val)) {}
+    CU_ASSERT_EQUAL(res, NANOCBOR_OK);
+
+    while ((res = nanocbor_get_uint32(&arr, &tmp)) == NANOCBOR_ERR_END &&
+           nanocbor_needs_input(&arr) && _refill(&chunked, &arr)) {}
+    CU_ASSERT_EQUAL(tmp, 1);
+
+    while ((res = nanocbor_get_uint32(&arr, &tmp)) == NANOCBOR_ERR_END &&
+           nanocbor_needs_input(&arr) && _refill(&chunked, &arr)) {}
+    CU_ASSERT_EQUAL(tmp, 1000);
+
+    while ((res = nanocbor_get_tstr(&arr, &str, &len)) == NANOCBOR_ERR_END &&
+           nanocbor_needs_input(&arr) && _refill(&chunked, &arr)) {}
+    CU_ASSERT_EQUAL(res, NANOCBOR_OK);
+    CU_ASSERT_EQUAL(len, 5);
+    CU_ASSERT_EQUAL(memcmp(str, "hello", 5), 0);
+
+    while ((res = nanocbor_enter_array(&arr, &inner)) == NANOCBOR_ERR_END &&
+           nanocbor_needs_input(&arr) && _refill(&chunked, &arr)) {}
+    CU_ASSERT_EQUAL(res, NANOCBOR_OK);
+    while (!nanocbor_at_end(&inner) || nanocbor_needs_input(&inner)) {
+        while ((res = nanocbor_get_uint32(&inner, &tmp)) == NANOCBOR_ERR_END &&
+               nanocbor_needs_input(&inner) && _refill(&chunked, &inner)) {}
+        CU_ASSERT(res > 0);
+        if (res < 0) {
+            break;
+        }
+    }
+    CU_ASSERT_EQUAL(tmp, 3);
+    nanocbor_leave_container(&arr, &inner);
+
+    while ((res = nanocbor_get_uint32(&arr, &tmp)) == NANOCBOR_ERR_END &&
+           nanocbor_needs_input(&arr) && _refill(&chunked, &arr)) {}
+    CU_ASSERT_EQUAL(tmp, 100000);
+    CU_ASSERT_EQUAL(nanocbor_at_end(&arr), true);
+    CU_ASSERT_EQUAL(nanocbor_needs_input(&arr), false);
+    nanocbor_leave_container(&val, &arr);
+    CU_ASSERT_EQUAL(chunked.input_pos, sizeof(input));
+    CU_ASSERT_EQUAL(nanocbor_decoder_pending(&val), 0);
+
+    /* A truncated string is not consumed */
+    nanocbor_decoder_init(&val, input + 5, 5);
+    CU_ASSERT_EQUAL(nanocbor_get_tstr(&val, &str, &len), NANOCBOR_ERR_END);
+    CU_ASSERT_EQUAL(val.cur, input + 5);
+}
+
+static void test_decode_utf8(void)
+{
+    static const struct {
+        const char *str;
+        bool valid;
+    } cases[] = {
+        { "", true },
+        { "ascii", true },
+        { "\xc2\xa9 \xe2\x82\xac \xf0\x9f\x98\x80", true },
+        { "\xed\x9f\xbf \xee\x80\x80 \xf4\x8f\xbf\xbf", true },
+        { "\x80", false },              /* Lone continuation */
+        { "\xc0\xaf", false },          /* Overlong */
+        { "\xe0\x9f\xbf", false },      /* Overlong */
+        { "\xf0\x8f\xbf\xbf", false },  /* Overlong */
+        { "\xed\xa0\x80", false },      /* Surrogate */
+        { "\xf4\x90\x80\x80", false },  /* Above U+10FFFF */
+        { "\xf5\x80\x80\x80", false },
+        { "\xe2\x82", false },          /* Truncated */
+        { "\xe2\x28\xac", false },
+    };
+    uint8_t buf[80];
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        size_t len = strlen(cases[i].str);
+        CU_ASSERT_EQUAL(nanocbor_utf8_valid((const uint8_t *)cases[i].str,
+                                            len), cases[i].valid);
+        /* At every position of a longer ASCII string, to cover the
+         * vectorized path and sequences crossing its blocks */
+        for (size_t pos = 0; pos + len <= sizeof(buf); pos += 3) {
+            memset(buf, 'a', sizeof(buf));
+            memcpy(buf + pos, cases[i].str, len);
+            CU_ASSERT_EQUAL(nanocbor_utf8_valid(buf, sizeof(buf)),
+                            cases[i].valid);
+            CU_ASSERT_EQUAL(nanocbor_utf8_valid(buf, pos + len),
+                            cases[i].valid);
+        }
+    }
+
+    /* ["a", "\xff"] */
+    static const uint8_t invalid[] = { 0x82, 0x61, 0x61, 0x61, 0xff };
+    nanocbor_value_t it;
+    nanocbor_value_t arr;
+    const uint8_t *str = NULL;
+    size_t len = 0;
+#if NANOCBOR_VALIDATE_UTF8
+    int expected = NANOCBOR_ERR_INVALID_UTF8;
+#else
+    int expected = NANOCBOR_OK;
+#endif
+
+    nanocbor_decoder_init(&it, invalid, sizeof(invalid));
+    CU_ASSERT_EQUAL(nanocbor_skip(&it), expected);
+    /* Only the structure is checked */
+    nanocbor_decoder_init(&it, invalid, sizeof(invalid));
+    CU_ASSERT_EQUAL(nanocbor_skip_structure(&it), NANOCBOR_OK);
+    CU_ASSERT(nanocbor_at_end(&it));
+    nanocbor_decoder_init(&it, invalid, sizeof(invalid) - 1);
+    CU_ASSERT_EQUAL(nanocbor_skip_structure(&it), NANOCBOR_ERR_END);
+    nanocbor_decoder_init(&it, invalid, sizeof(invalid));
+    CU_ASSERT_EQUAL(nanocbor_enter_array(&it, &arr), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_get_tstr(&arr, &str, &len), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_get_tstr(&arr, &str, &len), expected);
+}
+
+static void test_decode_arrays(void)
+{
+    /* [0, 23, 24, 255, 256, 65535, 65536, -1, -25, -65537, 2147483647,
+     *  -2147483648] followed by 1 */
+    static const uint8_t ints[] = {
+        0x8c, 0x00, 0x17, 0x18, 0x18, 0x18, 0xff, 0x19, 0x01, 0x00, 0x19,
+        0xff, 0xff, 0x1a, 0x00, 0x01, 0x00, 0x00, 0x20, 0x38, 0x18, 0x3a,
+        0x00, 0x01, 0x00, 0x00, 0x1a, 0x7f, 0xff, 0xff, 0xff, 0x3a, 0x7f,
+        0xff, 0xff, 0xff, 0x01,
+    };
+    static const int32_t expected[] = {
+        0, 23, 24, 255, 256, 65535, 65536, -1, -25, -65537, INT32_MAX,
+        INT32_MIN,
+    };
+    /* [_ 1.0 (half), 1.5 (single), -2.0 (half)] */
+    static const uint8_t floats[] = {
+        0x9f, 0xf9, 0x3c, 0x00, 0xfa, 0x3f, 0xc0, 0x00, 0x00, 0xf9, 0xc0,
+        0x00, 0xff,
+    };
+    /* [1, 2, -3] */
+    static const uint8_t mixed[] = { 0x83, 0x01, 0x02, 0x22 };
+    /* [2.0 (double)] */
+    static const uint8_t doubles[] = {
+        0x81, 0xfb, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    };
+
+    int32_t out[16];
+    uint32_t uout[16];
+    float fout[4];
+    size_t count = 0;
+    nanocbor_value_t val;
+
+    nanocbor_decoder_init(&val, ints, sizeof(ints));
+    CU_ASSERT_EQUAL(nanocbor_get_int32_array(&val, out, 16, &count),
+                    NANOCBOR_OK);
+    CU_ASSERT_EQUAL(count, sizeof(expected) / sizeof(expected[0]));
+    CU_ASSERT_EQUAL(memcmp(out, expected, sizeof(expected)), 0);
+    /* Advanced past the array */
+    uint32_t tmp = 0;
+    CU_ASSERT(nanocbor_get_uint32(&val, &tmp) > 0);
+    CU_ASSERT_EQUAL(tmp, 1);
+
+    /* Too many elements, partial result and not advanced */
+    nanocbor_decoder_init(&val, ints, sizeof(ints));
+    CU_ASSERT_EQUAL(nanocbor_get_int32_array(&val, out, 4, &count),
+                    NANOCBOR_ERR_OVERFLOW);
+    CU_ASSERT_EQUAL(count, 4);
+    CU_ASSERT_EQUAL(memcmp(out, expected, 4 * sizeof(expected[0])), 0);
+    CU_ASSERT_EQUAL(val.cur, ints);
+
+    /* Negative integers are not unsigned */
+    nanocbor_decoder_init(&val, mixed, sizeof(mixed));
+    CU_ASSERT_EQUAL(nanocbor_get_uint32_array(&val, uout, 16, &count),
+                    NANOCBOR_ERR_INVALID_TYPE);
+    CU_ASSERT_EQUAL(count, 2);
+    CU_ASSERT_EQUAL(uout[1], 2);
+
+    /* Truncated input */
+    nanocbor_decoder_init(&val, ints, 10);
+    CU_ASSERT_EQUAL(nanocbor_get_int32_array(&val, out, 16, &count),
+                    NANOCBOR_ERR_END);
+    CU_ASSERT_EQUAL(count, 5);
+
+    nanocbor_decoder_init(&val, floats, sizeof(floats));
+    CU_ASSERT_EQUAL(nanocbor_get_float_array(&val, fout, 4, &count),
+                    NANOCBOR_OK);
+    CU_ASSERT_EQUAL(count, 3);
+    CU_ASSERT_EQUAL(fout[0], 1.0f);
+    CU_ASSERT_EQUAL(fout[1], 1.5f);
+    CU_ASSERT_EQUAL(fout[2], -2.0f);
+    CU_ASSERT_EQUAL(val.cur, floats + sizeof(floats));
+
+    /* Indefinite array with more elements than the buffer */
+    nanocbor_decoder_init(&val, floats, sizeof(floats));
+    CU_ASSERT_EQUAL(nanocbor_get_float_array(&val, fout, 2, &count),
+                    NANOCBOR_ERR_OVERFLOW);
+    CU_ASSERT_EQUAL(count, 2);
+
+    /* Doubles don't fit in a float */
+    nanocbor_decoder_init(&val, doubles, sizeof(doubles));
+    CU_ASSERT_EQUAL(nanocbor_get_float_array(&val, fout, 4, &count),
+                    NANOCBOR_ERR_OVERFLOW);
+    CU_ASSERT_EQUAL(count, 0);
+    nanocbor_decoder_init(&val, mixed, sizeof(mixed));
+    CU_ASSERT_EQUAL(nanocbor_get_float_array(&val, fout, 4, &count),
+                    NANOCBOR_ERR_INVALID_TYPE);
+}
+
+static void test_decode_indefinite_str(void)
+{
+    /* [(_ h'0102', h'', h'03'), "x"] */
+    static const uint8_t doc[] = {
+        0x82, 0x5f, 0x42, 0x01, 0x02, 0x40, 0x41, 0x03, 0xff, 0x61, 0x78,
+    };
+    /* (_ "ab", "c") */
+    static const uint8_t text[] = { 0x7f, 0x62, 0x61, 0x62, 0x61, 0x63, 0xff };
+    /* (_ "a") as a byte string */
+    static const uint8_t mixed[] = { 0x5f, 0x61, 0x61, 0xff };
+    /* (_ (_)) */
+    static const uint8_t nested[] = { 0x5f, 0x5f, 0xff, 0xff };
+    /* (_ h'01' without stop code */
+    static const uint8_t truncated[] = { 0x5f, 0x41, 0x01 };
+    static const size_t chunk_lens[] = { 2, 0, 1 };
+
+    nanocbor_value_t val;
+    nanocbor_value_t arr;
+    nanocbor_value_t chunks;
+    const uint8_t *buf = NULL;
+    size_t len = 0;
+    uint8_t out[8];
+
+    nanocbor_decoder_init(&val, doc, sizeof(doc));
+    CU_ASSERT_EQUAL(nanocbor_enter_array(&val, &arr), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_get_bstr(&arr, &buf, &len), NANOCBOR_ERR_OVERFLOW);
+    CU_ASSERT_EQUAL(nanocbor_enter_tstr(&arr, &chunks),
+                    NANOCBOR_ERR_INVALID_TYPE);
+    CU_ASSERT_EQUAL(nanocbor_enter_bstr(&arr, &chunks), NANOCBOR_OK);
+    for (unsigned i = 0; i < 3; i++) {
+        CU_ASSERT_FALSE(nanocbor_at_end(&chunks));
+        CU_ASSERT_EQUAL(nanocbor_get_bstr(&chunks, &buf, &len), NANOCBOR_OK);
+        CU_ASSERT_EQUAL(len, chunk_lens[i]);
+    }
+    /* Chunks point into the input */
+    CU_ASSERT_PTR_EQUAL(buf, doc + 7);
+    CU_ASSERT_TRUE(nanocbor_at_end(&chunks));
+    nanocbor_leave_container(&arr, &chunks);
+    CU_ASSERT_EQUAL(nanocbor_get_tstr(&arr, &buf, &len), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(len, 1);
+    CU_ASSERT_TRUE(nanocbor_at_end(&arr));
+
+    /* A definite length string is a single chunk */
+    nanocbor_decoder_init(&val, doc + 9, 2);
+    CU_ASSERT_EQUAL(nanocbor_enter_tstr(&val, &chunks), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_get_tstr(&chunks, &buf, &len), NANOCBOR_OK);
+    CU_ASSERT_TRUE(nanocbor_at_end(&chunks));
+    nanocbor_leave_container(&val, &chunks);
+    CU_ASSERT_PTR_EQUAL(val.cur, doc + sizeof(doc));
+
+    nanocbor_decoder_init(&val, doc, sizeof(doc));
+    CU_ASSERT_EQUAL(nanocbor_skip(&val), NANOCBOR_OK);
+    CU_ASSERT_PTR_EQUAL(val.cur, doc + sizeof(doc));
+
+    nanocbor_decoder_init(&val, doc + 1, sizeof(doc) - 1);
+    CU_ASSERT_EQUAL(nanocbor_gather_bstr(&val, out, sizeof(out), &len),
+                    NANOCBOR_OK);
+    CU_ASSERT_EQUAL(len, 3);
+    CU_ASSERT_EQUAL(memcmp(out, "\x01\x02\x03", 3), 0);
+    CU_ASSERT_PTR_EQUAL(val.cur, doc + 9);
+    CU_ASSERT_EQUAL(nanocbor_gather_tstr(&val, out, sizeof(out), &len),
+                    NANOCBOR_OK);
+    CU_ASSERT_EQUAL(len, 1);
+    CU_ASSERT_EQUAL(out[0], 'x');
+
+    /* Doesn't fit, not advanced */
+    nanocbor_decoder_init(&val, doc + 1, sizeof(doc) - 1);
+    CU_ASSERT_EQUAL(nanocbor_gather_bstr(&val, out, 2, &len),
+                    NANOCBOR_ERR_OVERFLOW);
+    CU_ASSERT_PTR_EQUAL(val.cur, doc + 1);
+
+    nanocbor_decoder_init(&val, text, sizeof(text));
+    CU_ASSERT_EQUAL(nanocbor_gather_tstr(&val, out, sizeof(out), &len),
+                    NANOCBOR_OK);
+    CU_ASSERT_EQUAL(len, 3);
+    CU_ASSERT_EQUAL(memcmp(out, "abc", 3), 0);
+    nanocbor_decoder_init(&val, text, sizeof(text));
+    CU_ASSERT_EQUAL(nanocbor_skip(&val), NANOCBOR_OK);
+    CU_ASSERT_PTR_EQUAL(val.cur, text + sizeof(text));
+
+    /* Chunks must be definite length strings of the same type */
+    nanocbor_decoder_init(&val, mixed, sizeof(mixed));
+    CU_ASSERT_EQUAL(nanocbor_gather_bstr(&val, out, sizeof(out), &len),
+                    NANOCBOR_ERR_INVALID_TYPE);
+    CU_ASSERT_EQUAL(nanocbor_skip(&val), NANOCBOR_ERR_INVALID_TYPE);
+    nanocbor_decoder_init(&val, nested, sizeof(nested));
+    CU_ASSERT(nanocbor_gather_bstr(&val, out, sizeof(out), &len) < 0);
+    CU_ASSERT(nanocbor_skip(&val) < 0);
+
+    nanocbor_decoder_init(&val, truncated, sizeof(truncated));
+    CU_ASSERT_EQUAL(nanocbor_gather_bstr(&val, out, sizeof(out), &len),
+                    NANOCBOR_ERR_END);
+    CU_ASSERT_EQUAL(nanocbor_skip(&val), NANOCBOR_ERR_END);
+}
+
 const test_t tests_decoder[] = {
     {
         .f = test_decode_none,
@@ -198,6 +770,14 @@ const test_t tests_decoder[] = {
         .f = test_decode_basic,
         .n = "Simple CBOR integer tests",
     },
+    {
+        .f = test_decode_int64,
+        .n = "CBOR 64 bit integer tests",
+    },
+    {
+        .f = test_decode_float,
+        .n = "CBOR float decode tests",
+    },
     {
         .f = test_decode_indefinite,
         .n = "CBOR indefinite array decode tests",
@@ -210,6 +790,34 @@ const test_t tests_decoder[] = {
         .f = test_tag,
         .n = "CBOR tag decode test",
     },
+    {
+        .f = test_decode_key_int,
+        .n = "CBOR integer key lookup tests",
+    },
+    {
+        .f = test_decode_skip,
+        .n = "CBOR skip tests",
+    },
+    {
+        .f = test_decode_skip_scalars,
+        .n = "CBOR skip integer runs tests",
+    },
+    {
+        .f = test_decode_resume,
+        .n = "CBOR chunked input resume test",
+    },
+    {
+        .f = test_decode_arrays,
+        .n = "CBOR batch array decode tests",
+    },
+    {
+        .f = test_decode_utf8,
+        .n = "CBOR UTF-8 validation tests",
+    },
+    {
+        .f = test_decode_indefinite_str,
+        .n = "CBOR indefinite length string tests",
+    },
     {
         .f = NULL,
         .n = NULL,
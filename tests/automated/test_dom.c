@@ -0,0 +1,267 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include "test.h"
+#include "nanocbor/config.h"
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/dom.h"
+#include <CUnit/CUnit.h>
+#include <string.h>
+
+/* {"temp": 21.5, 1: [-1, -500, h'0102', true, null, simple(99)],
+ *  "n": 1([_ 2, 3])}, 7 */
+static const uint8_t doc[] = {
+    0xa3, 0x64, 0x74, 0x65, 0x6d, 0x70, 0xf9, 0x4d, 0x60, 0x01, 0x86, 0x20,
+    0x39, 0x01, 0xf3, 0x42, 0x01, 0x02, 0xf5, 0xf6, 0xf8, 0x63, 0x61, 0x6e,
+    0xc1, 0x9f, 0x02, 0x03, 0xff, 0x07,
+};
+
+static void test_dom_build(void)
+{
+    nanocbor_dom_node_t nodes[20];
+    nanocbor_dom_t dom;
+    nanocbor_value_t it;
+    size_t root = 0;
+
+    nanocbor_dom_init(&dom, nodes, 20);
+    nanocbor_decoder_init(&it, doc, sizeof(doc));
+    CU_ASSERT_EQUAL(nanocbor_dom_build(&dom, &it, &root), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(root, 0);
+    CU_ASSERT_EQUAL(dom.used, 16);
+    CU_ASSERT_PTR_EQUAL(it.cur, doc + sizeof(doc) - 1);
+
+    /* Children of a container are contiguous */
+    CU_ASSERT_EQUAL(nodes[0].type, NANOCBOR_TYPE_MAP);
+    CU_ASSERT_EQUAL(nodes[0].len, 6);
+    CU_ASSERT_EQUAL(nodes[0].child, 1);
+    CU_ASSERT_EQUAL(nodes[4].type, NANOCBOR_TYPE_ARR);
+    CU_ASSERT_EQUAL(nodes[4].child, 7);
+
+    const nanocbor_dom_node_t *node =
+        nanocbor_dom_map_get_tstr(&dom, &nodes[0], "temp");
+    CU_ASSERT(node != NULL);
+    if (!node) {
+        return;
+    }
+    CU_ASSERT_EQUAL(node->type, NANOCBOR_TYPE_FLOAT);
+    CU_ASSERT_EQUAL(node->v.fp, 21.5);
+    CU_ASSERT_PTR_NULL(nanocbor_dom_map_get_tstr(&dom, &nodes[0], "tem"));
+    CU_ASSERT_PTR_NULL(nanocbor_dom_map_get_int(&dom, &nodes[0], -2));
+
+    const nanocbor_dom_node_t *arr =
+        nanocbor_dom_map_get_int(&dom, &nodes[0], 1);
+    CU_ASSERT_PTR_EQUAL(arr, &nodes[4]);
+    node = nanocbor_dom_child(&dom, arr, 1);
+    CU_ASSERT_EQUAL(node->type, NANOCBOR_TYPE_NINT);
+    CU_ASSERT_EQUAL(node->v.num, 499);
+    node = nanocbor_dom_child(&dom, arr, 2);
+    CU_ASSERT_EQUAL(node->type, NANOCBOR_TYPE_BSTR);
+    CU_ASSERT_EQUAL(node->len, 2);
+    CU_ASSERT_PTR_EQUAL(node->v.str, doc + 16);
+    node = nanocbor_dom_child(&dom, arr, 3);
+    CU_ASSERT_EQUAL(node->type, NANOCBOR_DOM_SIMPLE);
+    CU_ASSERT_EQUAL(node->v.num, NANOCBOR_SIMPLE_TRUE);
+    node = nanocbor_dom_child(&dom, arr, 5);
+    CU_ASSERT_EQUAL(node->type, NANOCBOR_DOM_SIMPLE);
+    CU_ASSERT_EQUAL(node->v.num, 99);
+    CU_ASSERT_PTR_NULL(nanocbor_dom_child(&dom, arr, 6));
+    CU_ASSERT_PTR_NULL(nanocbor_dom_child(&dom, node, 0));
+
+    /* Tagged indefinite array */
+    node = nanocbor_dom_map_get_tstr(&dom, &nodes[0], "n");
+    CU_ASSERT_EQUAL(node->type, NANOCBOR_TYPE_TAG);
+    CU_ASSERT_EQUAL(node->v.num, 1);
+    node = nanocbor_dom_child(&dom, node, 0);
+    CU_ASSERT_EQUAL(node->type, NANOCBOR_TYPE_ARR);
+    CU_ASSERT_EQUAL(node->len, 2);
+    CU_ASSERT_EQUAL(nanocbor_dom_child(&dom, node, 1)->v.num, 3);
+
+    /* Second item in the same tree */
+    CU_ASSERT_EQUAL(nanocbor_dom_build(&dom, &it, &root), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(root, 16);
+    CU_ASSERT_EQUAL(nodes[16].v.num, 7);
+    CU_ASSERT(nanocbor_at_end(&it));
+}
+
+static void test_dom_encode(void)
+{
+    /* Containers are written with a definite length */
+    static const uint8_t expected[] = {
+        0xa3, 0x64, 0x74, 0x65, 0x6d, 0x70, 0xf9, 0x4d, 0x60, 0x01, 0x86,
+        0x20, 0x39, 0x01, 0xf3, 0x42, 0x01, 0x02, 0xf5, 0xf6, 0xf8, 0x63,
+        0x61, 0x6e, 0xc1, 0x82, 0x02, 0x03,
+    };
+    nanocbor_dom_node_t nodes[16];
+    nanocbor_dom_t dom;
+    nanocbor_value_t it;
+    nanocbor_encoder_t enc;
+    uint8_t buf[sizeof(expected)];
+    size_t root = 0;
+
+    nanocbor_dom_init(&dom, nodes, 16);
+    nanocbor_decoder_init(&it, doc, sizeof(doc));
+    CU_ASSERT_EQUAL(nanocbor_dom_build(&dom, &it, &root), NANOCBOR_OK);
+
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    CU_ASSERT_EQUAL(nanocbor_dom_encode(&dom, root, &enc), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_encoded_len(&enc), sizeof(expected));
+    CU_ASSERT_EQUAL(memcmp(buf, expected, sizeof(expected)), 0);
+
+    nanocbor_encoder_init(&enc, buf, sizeof(buf) - 1);
+    CU_ASSERT(nanocbor_dom_encode(&dom, root, &enc) < 0);
+}
+
+static void test_dom_indefinite(void)
+{
+    /* [_ 1, [_ 2, [3, [_ ]], 4], {_ 5: 6}, 7] */
+    static const uint8_t nested[] = {
+        0x9f, 0x01, 0x9f, 0x02, 0x82, 0x03, 0x9f, 0xff, 0x04, 0xff, 0xbf,
+        0x05, 0x06, 0xff, 0x07, 0xff,
+    };
+    static const uint8_t expected[] = {
+        0x84, 0x01, 0x83, 0x02, 0x82, 0x03, 0x80, 0x04, 0xa1, 0x05, 0x06,
+        0x07,
+    };
+    static nanocbor_dom_node_t nodes[4010];
+    static uint8_t wide[9 + 4000 + 9];
+    nanocbor_dom_t dom;
+    nanocbor_value_t it;
+    nanocbor_encoder_t enc;
+    uint8_t buf[sizeof(expected)];
+    size_t root = 0;
+
+    nanocbor_dom_init(&dom, nodes, 12);
+    nanocbor_decoder_init(&it, nested, sizeof(nested));
+    CU_ASSERT_EQUAL(nanocbor_dom_build(&dom, &it, &root), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(dom.used, 12);
+    CU_ASSERT(nanocbor_at_end(&it));
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    CU_ASSERT_EQUAL(nanocbor_dom_encode(&dom, root, &enc), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_encoded_len(&enc), sizeof(expected));
+    CU_ASSERT_EQUAL(memcmp(buf, expected, sizeof(expected)), 0);
+
+    /* One node short */
+    nanocbor_dom_init(&dom, nodes, 11);
+    nanocbor_decoder_init(&it, nested, sizeof(nested));
+    CU_ASSERT_EQUAL(nanocbor_dom_build(&dom, &it, &root),
+                    NANOCBOR_ERR_OVERFLOW);
+    CU_ASSERT_EQUAL(dom.used, 0);
+
+    /* Wide innermost of nested indefinite arrays, every item is decoded
+     * once */
+    memset(wide, 0x9f, 9);
+    memset(wide + 9, 0x00, 4000);
+    memset(wide + 9 + 4000, 0xff, 9);
+    nanocbor_dom_init(&dom, nodes, 4009);
+    nanocbor_decoder_init(&it, wide, sizeof(wide));
+    CU_ASSERT_EQUAL(nanocbor_dom_build(&dom, &it, &root), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(dom.used, 4009);
+    const nanocbor_dom_node_t *node = &nodes[root];
+    for (unsigned i = 0; i < 8; i++) {
+        CU_ASSERT_EQUAL(node->len, 1);
+        node = nanocbor_dom_child(&dom, node, 0);
+    }
+    CU_ASSERT_EQUAL(node->type, NANOCBOR_TYPE_ARR);
+    CU_ASSERT_EQUAL(node->len, 4000);
+    CU_ASSERT_EQUAL(nanocbor_dom_child(&dom, node, 3999)->type,
+                    NANOCBOR_TYPE_UINT);
+}
+
+static int _build(const uint8_t *buf, size_t len, size_t size)
+{
+    nanocbor_dom_node_t nodes[16];
+    nanocbor_dom_t dom;
+    nanocbor_value_t it;
+    size_t root = 0;
+
+    nanocbor_dom_init(&dom, nodes, size);
+    nanocbor_decoder_init(&it, buf, len);
+    int res = nanocbor_dom_build(&dom, &it, &root);
+    if (res < 0) {
+        /* Nothing is kept of a failed item */
+        CU_ASSERT_EQUAL(dom.used, 0);
+        CU_ASSERT_PTR_EQUAL(it.cur, buf);
+    }
+    return res;
+}
+
+static void test_dom_errors(void)
+{
+    static const uint8_t deep[] = {
+        0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x81, 0x01,
+    };
+    static const uint8_t trunc[] = { 0x83, 0x01, 0x02 };
+    static const uint8_t trunc_indef[] = { 0x9f, 0x01, 0x02 };
+    static const uint8_t tag64[] = {
+        0xdb, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+    };
+    static const uint8_t nint64[] = {
+        0x3b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    };
+    static const uint8_t arr[] = { 0x82, 0x01, 0x02 };
+    static const uint8_t odd_map[] = { 0xbf, 0x01, 0xff };
+
+    CU_ASSERT_EQUAL(_build(deep, sizeof(deep), 16), NANOCBOR_ERR_RECURSION);
+    CU_ASSERT_EQUAL(_build(trunc, sizeof(trunc), 16), NANOCBOR_ERR_END);
+    CU_ASSERT_EQUAL(_build(trunc_indef, sizeof(trunc_indef), 16),
+                    NANOCBOR_ERR_END);
+    CU_ASSERT_EQUAL(_build(tag64, sizeof(tag64), 16), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(_build(tag64, sizeof(tag64) - 2, 16), NANOCBOR_ERR_END);
+    CU_ASSERT_EQUAL(_build(odd_map, sizeof(odd_map), 16),
+                    NANOCBOR_ERR_INVALID_TYPE);
+    CU_ASSERT_EQUAL(_build(arr, sizeof(arr), 2), NANOCBOR_ERR_OVERFLOW);
+    CU_ASSERT_EQUAL(_build(arr, sizeof(arr), 3), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(_build(arr, 0, 3), NANOCBOR_ERR_END);
+
+    /* Full range negative integer decodes, but can't be encoded */
+    nanocbor_dom_node_t nodes[1];
+    nanocbor_dom_t dom;
+    nanocbor_value_t it;
+    nanocbor_encoder_t enc;
+    uint8_t buf[16];
+    size_t root = 0;
+
+    nanocbor_dom_init(&dom, nodes, 1);
+    nanocbor_decoder_init(&it, nint64, sizeof(nint64));
+    CU_ASSERT_EQUAL(nanocbor_dom_build(&dom, &it, &root), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nodes[0].v.num, UINT64_MAX);
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    CU_ASSERT_EQUAL(nanocbor_dom_encode(&dom, root, &enc),
+                    NANOCBOR_ERR_OVERFLOW);
+
+    /* Tag numbers use the full 64 bits */
+    nanocbor_dom_node_t tag_nodes[2];
+    nanocbor_dom_init(&dom, tag_nodes, 2);
+    nanocbor_decoder_init(&it, tag64, sizeof(tag64));
+    CU_ASSERT_EQUAL(nanocbor_dom_build(&dom, &it, &root), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(tag_nodes[root].type, NANOCBOR_TYPE_TAG);
+    CU_ASSERT_EQUAL(tag_nodes[root].v.num, UINT64_C(0x0100000000000000));
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    CU_ASSERT_EQUAL(nanocbor_dom_encode(&dom, root, &enc), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_encoded_len(&enc), sizeof(tag64));
+    CU_ASSERT_EQUAL(memcmp(buf, tag64, sizeof(tag64)), 0);
+}
+
+const test_t tests_dom[] = {
+    {
+        .f = test_dom_build,
+        .n = "Document tree build test",
+    },
+    {
+        .f = test_dom_encode,
+        .n = "Document tree encode test",
+    },
+    {
+        .f = test_dom_indefinite,
+        .n = "Document tree indefinite length test",
+    },
+    {
+        .f = test_dom_errors,
+        .n = "Document tree error test",
+    },
+    {
+        .f = NULL,
+        .n = NULL,
+    }
+};
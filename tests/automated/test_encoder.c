@@ -4,8 +4,11 @@
 
 #include "test.h"
 #include "nanocbor/nanocbor.h"
+#include "nanocbor/host/pool.h"
 #include <math.h>
 #include <float.h>
+#include <pthread.h>
+#include <string.h>
 #include <CUnit/CUnit.h>
 
 static void print_bytestr(const uint8_t *bytes, size_t len)
@@ -88,6 +91,516 @@ static void test_encode_double_to_float(void)
     print_bytestr(buf, nanocbor_encoded_len(&enc));
 }
 
+typedef struct {
+    uint8_t chunk[10];
+    uint8_t out[64];
+    size_t out_len;
+} _flush_sink_t;
+
+static int _flush(nanocbor_encoder_t *enc, void *ctx, size_t len)
+{
+    _flush_sink_t *sink = ctx;
+    size_t used = (size_t)(enc->cur - sink->chunk);
+
+    if (len > sizeof(sink->chunk) ||
+        sink->out_len + used > sizeof(sink->out)) {
+        return NANOCBOR_ERR_END;
+    }
+    memcpy(sink->out + sink->out_len, sink->chunk, used);
+    sink->out_len += used;
+    enc->cur = sink->chunk;
+    return NANOCBOR_OK;
+}
+
+static void _encode_sink_payload(nanocbor_encoder_t *enc)
+{
+    nanocbor_fmt_array(enc, 5);
+    nanocbor_fmt_uint(enc, UINT32_MAX);
+    nanocbor_fmt_int(enc, -500);
+    nanocbor_put_tstr(enc, "sink");
+    nanocbor_fmt_double(enc, DBL_MAX);
+    nanocbor_fmt_null(enc);
+}
+
+static void test_encode_sink(void)
+{
+    uint8_t expected[64];
+    nanocbor_encoder_t enc;
+    _flush_sink_t sink = { 0 };
+
+    nanocbor_encoder_init(&enc, expected, sizeof(expected));
+    _encode_sink_payload(&enc);
+    size_t len = nanocbor_encoded_len(&enc);
+
+    nanocbor_encoder_sink_init(&enc, sink.chunk, sizeof(sink.chunk),
+                               _flush, &sink);
+    _encode_sink_payload(&enc);
+    CU_ASSERT_EQUAL(nanocbor_encoded_len(&enc), len);
+    /* Flush the remainder */
+    CU_ASSERT_EQUAL(_flush(&enc, &sink, 0), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(sink.out_len, len);
+    CU_ASSERT_EQUAL(memcmp(sink.out, expected, len), 0);
+
+    /* Items larger than the chunk can never fit */
+    static const uint8_t large[16] = { 0 };
+    CU_ASSERT_EQUAL(nanocbor_put_bstr(&enc, large, sizeof(large)),
+                    NANOCBOR_ERR_END);
+}
+
+static void test_encode_header_widths(void)
+{
+    static const struct {
+        uint64_t num;
+        uint8_t expected[9];
+        size_t len;
+    } cases[] = {
+        { 0, { 0x00 }, 1 },
+        { 23, { 0x17 }, 1 },
+        { 24, { 0x18, 0x18 }, 2 },
+        { UINT8_MAX, { 0x18, 0xff }, 2 },
+        { UINT8_MAX + 1U, { 0x19, 0x01, 0x00 }, 3 },
+        { UINT16_MAX, { 0x19, 0xff, 0xff }, 3 },
+        { UINT16_MAX + 1U, { 0x1a, 0x00, 0x01, 0x00, 0x00 }, 5 },
+        { UINT32_MAX, { 0x1a, 0xff, 0xff, 0xff, 0xff }, 5 },
+        { UINT32_MAX + 1ULL,
+          { 0x1b, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00 }, 9 },
+        { UINT64_MAX,
+          { 0x1b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff }, 9 },
+    };
+    uint8_t buf[9];
+    nanocbor_encoder_t enc;
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        nanocbor_encoder_init(&enc, buf, sizeof(buf));
+        CU_ASSERT_EQUAL(nanocbor_fmt_uint(&enc, cases[i].num),
+                        (int)cases[i].len);
+        CU_ASSERT_EQUAL(memcmp(buf, cases[i].expected, cases[i].len), 0);
+
+        /* Same argument for negative integers */
+        nanocbor_encoder_init(&enc, buf, sizeof(buf));
+        if (cases[i].num <= INT64_MAX) {
+            CU_ASSERT_EQUAL(nanocbor_fmt_int(&enc, -1 - (int64_t)cases[i].num),
+                            (int)cases[i].len);
+            CU_ASSERT_EQUAL(buf[0], cases[i].expected[0] | 0x20);
+            CU_ASSERT_EQUAL(memcmp(buf + 1, cases[i].expected + 1,
+                                   cases[i].len - 1), 0);
+        }
+
+        /* And for length headers */
+        if (cases[i].num <= SIZE_MAX) {
+            nanocbor_encoder_init(&enc, buf, sizeof(buf));
+            CU_ASSERT_EQUAL(nanocbor_fmt_map(&enc, (size_t)cases[i].num),
+                            (int)cases[i].len);
+            CU_ASSERT_EQUAL(buf[0], cases[i].expected[0] | 0xa0);
+        }
+    }
+    /* Header that does not fit */
+    nanocbor_encoder_init(&enc, buf, 8);
+    CU_ASSERT_EQUAL(nanocbor_fmt_tag(&enc, UINT64_MAX), NANOCBOR_ERR_END);
+}
+
+static void test_encode_arrays(void)
+{
+    static const uint32_t uints[] = {
+        0, 23, 24, 255, 256, UINT16_MAX, UINT16_MAX + 1U, UINT32_MAX,
+    };
+    static const int32_t ints[] = {
+        0, -1, -24, -25, -256, -257, -65536, -65537, INT32_MIN, INT32_MAX,
+    };
+    static const float floats[] = {
+        0.0f, -0.0f, 1.75f, -1.9990234375f, 1.99951171875f, NAN, INFINITY,
+        FLT_MAX,
+    };
+    uint8_t expected[128];
+    uint8_t buf[128];
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, expected, sizeof(expected));
+    nanocbor_fmt_array(&enc, sizeof(uints) / sizeof(uints[0]));
+    for (size_t i = 0; i < sizeof(uints) / sizeof(uints[0]); i++) {
+        nanocbor_fmt_uint(&enc, uints[i]);
+    }
+    size_t len = nanocbor_encoded_len(&enc);
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    CU_ASSERT_EQUAL(nanocbor_fmt_uint_array(&enc, uints,
+                                            sizeof(uints) / sizeof(uints[0])),
+                    (int)len);
+    CU_ASSERT_EQUAL(nanocbor_encoded_len(&enc), len);
+    CU_ASSERT_EQUAL(memcmp(buf, expected, len), 0);
+
+    nanocbor_encoder_init(&enc, expected, sizeof(expected));
+    nanocbor_fmt_array(&enc, sizeof(ints) / sizeof(ints[0]));
+    for (size_t i = 0; i < sizeof(ints) / sizeof(ints[0]); i++) {
+        nanocbor_fmt_int(&enc, ints[i]);
+    }
+    len = nanocbor_encoded_len(&enc);
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    CU_ASSERT_EQUAL(nanocbor_fmt_int_array(&enc, ints,
+                                           sizeof(ints) / sizeof(ints[0])),
+                    (int)len);
+    CU_ASSERT_EQUAL(memcmp(buf, expected, len), 0);
+
+    nanocbor_encoder_init(&enc, expected, sizeof(expected));
+    nanocbor_fmt_array(&enc, sizeof(floats) / sizeof(floats[0]));
+    for (size_t i = 0; i < sizeof(floats) / sizeof(floats[0]); i++) {
+        nanocbor_fmt_float(&enc, floats[i]);
+    }
+    len = nanocbor_encoded_len(&enc);
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    CU_ASSERT_EQUAL(nanocbor_fmt_float_array(&enc, floats,
+                                             sizeof(floats) / sizeof(floats[0])),
+                    (int)len);
+    CU_ASSERT_EQUAL(memcmp(buf, expected, len), 0);
+
+    /* Empty array */
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    CU_ASSERT_EQUAL(nanocbor_fmt_int_array(&enc, ints, 0), 1);
+    CU_ASSERT_EQUAL(buf[0], 0x80);
+
+    /* Nothing is written when the array doesn't fit, the length is still
+     * counted */
+    memset(buf, 0, sizeof(buf));
+    nanocbor_encoder_init(&enc, buf, len - 1);
+    CU_ASSERT_EQUAL(nanocbor_fmt_float_array(&enc, floats,
+                                             sizeof(floats) / sizeof(floats[0])),
+                    NANOCBOR_ERR_END);
+    CU_ASSERT_EQUAL(nanocbor_encoded_len(&enc), len);
+    CU_ASSERT_EQUAL(buf[0], 0);
+}
+
+static void test_encode_deferred(void)
+{
+    uint8_t expected[512];
+    uint8_t buf[512];
+    nanocbor_encoder_t enc;
+    nanocbor_deferred_t outer;
+    nanocbor_deferred_t inner;
+
+    /* {1: [300 times 0], "a": []} */
+    nanocbor_encoder_init(&enc, expected, sizeof(expected));
+    nanocbor_fmt_map(&enc, 2);
+    nanocbor_fmt_uint(&enc, 1);
+    nanocbor_fmt_array(&enc, 300);
+    for (unsigned i = 0; i < 300; i++) {
+        nanocbor_fmt_uint(&enc, 0);
+    }
+    nanocbor_put_tstr(&enc, "a");
+    nanocbor_fmt_array(&enc, 0);
+    size_t len = nanocbor_encoded_len(&enc);
+
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    CU_ASSERT_EQUAL(nanocbor_fmt_map_begin(&enc, &outer), NANOCBOR_OK);
+    nanocbor_fmt_uint(&enc, 1);
+    CU_ASSERT_EQUAL(nanocbor_fmt_array_begin(&enc, &inner), NANOCBOR_OK);
+    for (unsigned i = 0; i < 300; i++) {
+        nanocbor_fmt_uint(&enc, 0);
+    }
+    CU_ASSERT_EQUAL(nanocbor_fmt_container_end(&enc, &inner), NANOCBOR_OK);
+    nanocbor_put_tstr(&enc, "a");
+    CU_ASSERT_EQUAL(nanocbor_fmt_array_begin(&enc, &inner), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_fmt_container_end(&enc, &inner), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_fmt_container_end(&enc, &outer), NANOCBOR_OK);
+
+    CU_ASSERT_EQUAL(nanocbor_encoded_len(&enc), len);
+    CU_ASSERT_EQUAL(memcmp(buf, expected, len), 0);
+
+    /* Map with a key without value */
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    nanocbor_fmt_map_begin(&enc, &outer);
+    nanocbor_fmt_uint(&enc, 1);
+    CU_ASSERT_EQUAL(nanocbor_fmt_container_end(&enc, &outer),
+                    NANOCBOR_ERR_INVALID_TYPE);
+
+    /* Container doesn't fit */
+    nanocbor_encoder_init(&enc, buf, 8);
+    CU_ASSERT_EQUAL(nanocbor_fmt_array_begin(&enc, &outer), NANOCBOR_OK);
+    nanocbor_put_tstr(&enc, "too long");
+    CU_ASSERT_EQUAL(nanocbor_fmt_container_end(&enc, &outer),
+                    NANOCBOR_ERR_END);
+
+    /* Not supported without a buffer */
+    nanocbor_encoder_init(&enc, NULL, 0);
+    CU_ASSERT_EQUAL(nanocbor_fmt_array_begin(&enc, &outer), NANOCBOR_ERR_END);
+    CU_ASSERT_EQUAL(nanocbor_fmt_container_end(&enc, &outer),
+                    NANOCBOR_ERR_END);
+}
+
+static void test_encode_deferred_nested(void)
+{
+    static const uint8_t raw[] = { 0x82, 0x01, 0x63, 0x61 };
+    uint8_t expected[1024];
+    uint8_t buf[1024];
+    nanocbor_encoder_t enc;
+    nanocbor_deferred_t levels[2 * NANOCBOR_RECURSION_MAX];
+    nanocbor_deferred_t discarded;
+    nanocbor_encoder_checkpoint_t cp;
+    const unsigned depth = 2 * NANOCBOR_RECURSION_MAX;
+
+    /* Nested deeper than the decoder recursion limit, every level holds
+     * a tagged array, an indefinite array, a string split over raw writes
+     * and the next level:
+     * [1([2, "b"]), [_ [3], h''], [1, "abc"], ...] */
+    nanocbor_encoder_init(&enc, expected, sizeof(expected));
+    for (unsigned i = 0; i < depth; i++) {
+        nanocbor_fmt_array(&enc, (i + 1 < depth) ? 4 : 3);
+        nanocbor_fmt_tag(&enc, 1);
+        nanocbor_fmt_array(&enc, 2);
+        nanocbor_fmt_uint(&enc, 2);
+        nanocbor_put_tstr(&enc, "b");
+        nanocbor_fmt_array_indefinite(&enc);
+        nanocbor_fmt_array(&enc, 1);
+        nanocbor_fmt_uint(&enc, 3);
+        nanocbor_put_bstr(&enc, raw, 0);
+        nanocbor_fmt_end_indefinite(&enc);
+        nanocbor_put_raw(&enc, raw, sizeof(raw));
+        nanocbor_put_raw(&enc, (const uint8_t *)"bc", 2);
+    }
+    size_t len = nanocbor_encoded_len(&enc);
+
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    for (unsigned i = 0; i < depth; i++) {
+        CU_ASSERT_EQUAL(nanocbor_fmt_array_begin(&enc, &levels[i]),
+                        NANOCBOR_OK);
+        nanocbor_fmt_tag(&enc, 1);
+        nanocbor_fmt_array(&enc, 2);
+        nanocbor_fmt_uint(&enc, 2);
+        nanocbor_put_tstr(&enc, "b");
+        nanocbor_fmt_array_indefinite(&enc);
+        nanocbor_fmt_array(&enc, 1);
+        nanocbor_fmt_uint(&enc, 3);
+        nanocbor_put_bstr(&enc, raw, 0);
+        nanocbor_fmt_end_indefinite(&enc);
+        nanocbor_put_raw(&enc, raw, sizeof(raw));
+        nanocbor_put_raw(&enc, (const uint8_t *)"bc", 2);
+        /* Rolled back item and nested container */
+        nanocbor_encoder_save(&enc, &cp);
+        nanocbor_fmt_uint(&enc, 4);
+        nanocbor_fmt_array_begin(&enc, &discarded);
+        nanocbor_encoder_restore(&enc, &cp);
+    }
+    /* Only the innermost container can be closed */
+    CU_ASSERT_EQUAL(nanocbor_fmt_container_end(&enc, &levels[0]),
+                    NANOCBOR_ERR_INVALID_TYPE);
+    for (unsigned i = depth; i > 0; i--) {
+        CU_ASSERT_EQUAL(nanocbor_fmt_container_end(&enc, &levels[i - 1]),
+                        NANOCBOR_OK);
+    }
+    CU_ASSERT_EQUAL(nanocbor_encoded_len(&enc), len);
+    CU_ASSERT_EQUAL(memcmp(buf, expected, len), 0);
+
+    /* Incomplete last item */
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    nanocbor_fmt_array_begin(&enc, &levels[0]);
+    nanocbor_fmt_array(&enc, 2);
+    nanocbor_fmt_uint(&enc, 1);
+    CU_ASSERT_EQUAL(nanocbor_fmt_container_end(&enc, &levels[0]),
+                    NANOCBOR_ERR_END);
+    nanocbor_fmt_uint(&enc, 2);
+    CU_ASSERT_EQUAL(nanocbor_fmt_container_end(&enc, &levels[0]),
+                    NANOCBOR_OK);
+    CU_ASSERT_EQUAL(buf[0], 0x81);
+
+    /* Stray break */
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    nanocbor_fmt_array_begin(&enc, &levels[0]);
+    nanocbor_fmt_end_indefinite(&enc);
+    CU_ASSERT_EQUAL(nanocbor_fmt_container_end(&enc, &levels[0]),
+                    NANOCBOR_ERR_INVALID_TYPE);
+}
+
+static void test_encode_indefinite_str(void)
+{
+    /* (_ h'0102', h'03'), (_ "ab", "c") */
+    static const uint8_t expected[] = {
+        0x5f, 0x42, 0x01, 0x02, 0x41, 0x03, 0xff,
+        0x7f, 0x62, 0x61, 0x62, 0x61, 0x63, 0xff,
+    };
+    static const uint8_t data[] = { 0x01, 0x02, 0x03 };
+    uint8_t buf[32];
+    uint8_t out[8];
+    size_t len = 0;
+    nanocbor_encoder_t enc;
+    nanocbor_value_t val;
+
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    CU_ASSERT_EQUAL(nanocbor_fmt_bstr_indefinite(&enc), 1);
+    nanocbor_put_bstr(&enc, data, 2);
+    nanocbor_put_bstr(&enc, data + 2, 1);
+    CU_ASSERT_EQUAL(nanocbor_fmt_end_indefinite(&enc), 1);
+    CU_ASSERT_EQUAL(nanocbor_fmt_tstr_indefinite(&enc), 1);
+    nanocbor_put_tstrn(&enc, "ab", 2);
+    nanocbor_put_tstr(&enc, "c");
+    nanocbor_fmt_end_indefinite(&enc);
+    CU_ASSERT_EQUAL(nanocbor_encoded_len(&enc), sizeof(expected));
+    CU_ASSERT_EQUAL(memcmp(buf, expected, sizeof(expected)), 0);
+
+    nanocbor_decoder_init(&val, buf, nanocbor_encoded_len(&enc));
+    CU_ASSERT_EQUAL(nanocbor_gather_bstr(&val, out, sizeof(out), &len),
+                    NANOCBOR_OK);
+    CU_ASSERT_EQUAL(len, sizeof(data));
+    CU_ASSERT_EQUAL(memcmp(out, data, sizeof(data)), 0);
+}
+
+static void test_encode_checkpoint(void)
+{
+    /* [1, "abcd"] records */
+    static const uint8_t record[] = { 0x82, 0x01, 0x64, 0x61, 0x62, 0x63, 0x64 };
+    uint8_t buf[16];
+    nanocbor_encoder_t enc;
+    nanocbor_encoder_checkpoint_t cp;
+    unsigned num = 0;
+
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    CU_ASSERT_EQUAL(nanocbor_encoder_remaining(&enc), sizeof(buf));
+    for (;; num++) {
+        nanocbor_encoder_save(&enc, &cp);
+        nanocbor_fmt_array(&enc, 2);
+        nanocbor_fmt_uint(&enc, 1);
+        if (nanocbor_put_tstr(&enc, "abcd") < 0) {
+            nanocbor_encoder_restore(&enc, &cp);
+            break;
+        }
+    }
+    /* Two records fit, the partial third one is removed */
+    CU_ASSERT_EQUAL(num, 2);
+    CU_ASSERT_EQUAL(nanocbor_encoded_len(&enc), 2 * sizeof(record));
+    CU_ASSERT_EQUAL(nanocbor_encoder_remaining(&enc),
+                    sizeof(buf) - 2 * sizeof(record));
+    CU_ASSERT_EQUAL(memcmp(buf, record, sizeof(record)), 0);
+    CU_ASSERT_EQUAL(memcmp(buf + sizeof(record), record, sizeof(record)), 0);
+
+    /* A smaller item still fits after the rollback */
+    CU_ASSERT_EQUAL(nanocbor_fmt_uint(&enc, 100), 2);
+    CU_ASSERT_EQUAL(nanocbor_encoder_remaining(&enc), 0);
+
+    /* Size determination */
+    nanocbor_encoder_init(&enc, NULL, 0);
+    CU_ASSERT_EQUAL(nanocbor_encoder_remaining(&enc), 0);
+    nanocbor_encoder_save(&enc, &cp);
+    nanocbor_put_tstr(&enc, "abcd");
+    CU_ASSERT_EQUAL(nanocbor_encoded_len(&enc), 5);
+    nanocbor_encoder_restore(&enc, &cp);
+    CU_ASSERT_EQUAL(nanocbor_encoded_len(&enc), 0);
+}
+
+static void test_encode_pool(void)
+{
+    nanocbor_pool_t *pool = nanocbor_pool_create(4);
+    nanocbor_pool_buf_t out;
+    nanocbor_encoder_t enc;
+
+    CU_ASSERT_PTR_NOT_NULL(pool);
+    uint8_t *buf = nanocbor_pool_get(pool, 100);
+    CU_ASSERT_EQUAL(nanocbor_pool_capacity(buf), 128);
+    nanocbor_pool_put(pool, buf);
+    /* Served from the thread cache */
+    CU_ASSERT_PTR_EQUAL(nanocbor_pool_get(pool, 65), buf);
+    nanocbor_pool_put(pool, buf);
+    nanocbor_pool_flush(pool);
+    CU_ASSERT_PTR_EQUAL(nanocbor_pool_get(pool, 128), buf);
+    nanocbor_pool_put(pool, buf);
+
+    buf = nanocbor_pool_get(pool, 0);
+    CU_ASSERT_EQUAL(nanocbor_pool_capacity(buf), NANOCBOR_POOL_MIN_SIZE);
+    nanocbor_pool_put(pool, buf);
+    /* Larger than the largest class */
+    size_t large = ((size_t)NANOCBOR_POOL_MIN_SIZE << NANOCBOR_POOL_CLASSES) + 1;
+    buf = nanocbor_pool_get(pool, large);
+    CU_ASSERT_EQUAL(nanocbor_pool_capacity(buf), large);
+    nanocbor_pool_put(pool, buf);
+    nanocbor_pool_put(pool, NULL);
+
+    /* The encoder moves to larger buffers when full */
+    CU_ASSERT_EQUAL(nanocbor_pool_encoder_init(&enc, &out, pool, 0),
+                    NANOCBOR_OK);
+    CU_ASSERT_EQUAL(out.size, NANOCBOR_POOL_MIN_SIZE);
+    nanocbor_fmt_array(&enc, 100);
+    for (uint32_t i = 0; i < 100; i++) {
+        CU_ASSERT(nanocbor_fmt_uint(&enc, i * 10) > 0);
+    }
+    CU_ASSERT(out.size >= nanocbor_encoded_len(&enc));
+    CU_ASSERT_PTR_EQUAL(enc.end, out.buf + out.size);
+
+    nanocbor_value_t it;
+    nanocbor_value_t arr;
+    uint32_t num = 0;
+    unsigned matches = 0;
+    nanocbor_decoder_init(&it, out.buf, nanocbor_encoded_len(&enc));
+    CU_ASSERT_EQUAL(nanocbor_enter_array(&it, &arr), NANOCBOR_OK);
+    for (uint32_t i = 0; i < 100; i++) {
+        matches += nanocbor_get_uint32(&arr, &num) > 0 && num == i * 10;
+    }
+    CU_ASSERT_EQUAL(matches, 100);
+    nanocbor_pool_put(pool, out.buf);
+
+    /* No buffer of that size */
+    CU_ASSERT_EQUAL(nanocbor_pool_encoder_init(&enc, &out, pool, SIZE_MAX),
+                    NANOCBOR_ERR_END);
+    CU_ASSERT_PTR_NULL(out.buf);
+    nanocbor_pool_destroy(pool);
+}
+
+#define POOL_THREADS    (4U)
+#define POOL_ROUNDS     (2000U)
+#define POOL_HELD       (16U)   /* More than fit the thread cache */
+
+typedef struct {
+    nanocbor_pool_t *pool;
+    uint8_t tag;
+    unsigned errors;
+} pool_worker_t;
+
+static void *_pool_worker(void *arg)
+{
+    pool_worker_t *worker = arg;
+    uint8_t *held[POOL_HELD];
+
+    for (unsigned round = 0; round < POOL_ROUNDS; round++) {
+        size_t size = (size_t)16U << (round % 4U);
+        for (unsigned i = 0; i < POOL_HELD; i++) {
+            held[i] = nanocbor_pool_get(worker->pool, size);
+            if (held[i] == NULL) {
+                worker->errors++;
+                return NULL;
+            }
+            memset(held[i], worker->tag, size);
+        }
+        /* No other thread got the same buffers */
+        for (unsigned i = 0; i < POOL_HELD; i++) {
+            for (size_t j = 0; j < size; j++) {
+                worker->errors += held[i][j] != worker->tag;
+            }
+            nanocbor_pool_put(worker->pool, held[i]);
+        }
+    }
+    return NULL;
+}
+
+static void test_encode_pool_threads(void)
+{
+    nanocbor_pool_t *pool = nanocbor_pool_create(POOL_THREADS * POOL_HELD);
+    pool_worker_t workers[POOL_THREADS];
+    pthread_t threads[POOL_THREADS];
+    unsigned started = 0;
+    unsigned errors = 0;
+
+    CU_ASSERT_PTR_NOT_NULL(pool);
+    for (unsigned i = 0; i < POOL_THREADS; i++) {
+        workers[i].pool = pool;
+        workers[i].tag = (uint8_t)(i + 1);
+        workers[i].errors = 0;
+        started += pthread_create(&threads[i], NULL, _pool_worker,
+                                  &workers[i]) == 0;
+    }
+    CU_ASSERT_EQUAL(started, POOL_THREADS);
+    for (unsigned i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+        errors += workers[i].errors;
+    }
+    CU_ASSERT_EQUAL(errors, 0);
+    nanocbor_pool_destroy(pool);
+}
+
 const test_t tests_encoder[] = {
     {
         .f = test_encode_float_specials,
@@ -101,6 +614,42 @@ const test_t tests_encoder[] = {
         .f = test_encode_double_to_float,
         .n = "Double reduction encoder test",
     },
+    {
+        .f = test_encode_sink,
+        .n = "Encoder sink callback test",
+    },
+    {
+        .f = test_encode_header_widths,
+        .n = "Header width encoder test",
+    },
+    {
+        .f = test_encode_arrays,
+        .n = "Batch array encoder test",
+    },
+    {
+        .f = test_encode_deferred,
+        .n = "Deferred length container encoder test",
+    },
+    {
+        .f = test_encode_deferred_nested,
+        .n = "Nested deferred length container encoder test",
+    },
+    {
+        .f = test_encode_indefinite_str,
+        .n = "Indefinite length string encoder test",
+    },
+    {
+        .f = test_encode_checkpoint,
+        .n = "Encoder checkpoint and rollback test",
+    },
+    {
+        .f = test_encode_pool,
+        .n = "Encoder buffer pool test",
+    },
+    {
+        .f = test_encode_pool_threads,
+        .n = "Concurrent encoder buffer pool test",
+    },
     {
         .f = NULL,
         .n = NULL,
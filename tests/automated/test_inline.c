@@ -0,0 +1,93 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/* Compare the inline fast paths against the regular getters */
+#define NANOCBOR_INLINE 1
+
+#include "test.h"
+#include "nanocbor/config.h"
+#include "nanocbor/nanocbor.h"
+#include <CUnit/CUnit.h>
+#include <string.h>
+
+static const uint8_t items[][2] = {
+    { 0x00 }, { 0x17 }, { 0x18, 0x18 }, { 0x20 }, { 0x37 }, { 0x38, 0x18 },
+    { 0xf4 }, { 0xf5 }, { 0xf6 }, { 0xff }, { 0x40 }, { 0x80 },
+};
+
+/* Decoder positioned at @p item in all contexts the fast paths check:
+ * top level, definite and indefinite containers and an exhausted
+ * container */
+static void _context(nanocbor_value_t *it, unsigned ctx, const uint8_t *item,
+                     size_t len)
+{
+    nanocbor_decoder_init(it, item, len);
+    if (ctx == 1) {
+        it->flags = NANOCBOR_DECODER_FLAG_CONTAINER;
+        it->remaining = 1;
+    }
+    else if (ctx == 2) {
+        it->flags = NANOCBOR_DECODER_FLAG_CONTAINER |
+                    NANOCBOR_DECODER_FLAG_INDEFINITE;
+    }
+    else if (ctx == 3) {
+        it->flags = NANOCBOR_DECODER_FLAG_CONTAINER;
+        it->remaining = 0;
+    }
+}
+
+#define COMPARE(getter, type) \
+    do { \
+        nanocbor_value_t a, b; \
+        type va = 0, vb = 0; \
+        _context(&a, ctx, items[i], len); \
+        _context(&b, ctx, items[i], len); \
+        int ra = getter(&a, &va); \
+        int rb = (getter)(&b, &vb); \
+        CU_ASSERT_EQUAL(ra, rb); \
+        CU_ASSERT_PTR_EQUAL(a.cur, b.cur); \
+        CU_ASSERT_EQUAL(a.remaining, b.remaining); \
+        if (rb >= 0) { \
+            CU_ASSERT_EQUAL(va, vb); \
+        } \
+    } while (0)
+
+static void test_inline_getters(void)
+{
+    for (size_t i = 0; i < sizeof(items) / sizeof(items[0]); i++) {
+        /* Complete and truncated items */
+        size_t full = (items[i][0] & NANOCBOR_VALUE_MASK) ==
+                      NANOCBOR_SIZE_BYTE ? 2 : 1;
+        for (size_t len = 0; len <= full; len++) {
+            for (unsigned ctx = 0; ctx < 4; ctx++) {
+                nanocbor_value_t it;
+                _context(&it, ctx, items[i], len);
+                CU_ASSERT_EQUAL(nanocbor_at_end(&it), (nanocbor_at_end)(&it));
+                CU_ASSERT_EQUAL(nanocbor_get_type(&it),
+                                (nanocbor_get_type)(&it));
+
+                COMPARE(nanocbor_get_uint8, uint8_t);
+                COMPARE(nanocbor_get_uint16, uint16_t);
+                COMPARE(nanocbor_get_uint32, uint32_t);
+                COMPARE(nanocbor_get_uint64, uint64_t);
+                COMPARE(nanocbor_get_int8, int8_t);
+                COMPARE(nanocbor_get_int16, int16_t);
+                COMPARE(nanocbor_get_int32, int32_t);
+                COMPARE(nanocbor_get_int64, int64_t);
+                COMPARE(nanocbor_get_bool, bool);
+            }
+        }
+    }
+}
+
+const test_t tests_inline[] = {
+    {
+        .f = test_inline_getters,
+        .n = "Inline getter fast path test",
+    },
+    {
+        .f = NULL,
+        .n = NULL,
+    }
+};
@@ -0,0 +1,83 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include "test.h"
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/iovec.h"
+#include <CUnit/CUnit.h>
+#include <string.h>
+
+static const char text[] = "a text string referenced by the encoder";
+
+static void _encode(nanocbor_encoder_t *enc, const uint8_t *payload,
+                    size_t payload_len)
+{
+    nanocbor_fmt_array(enc, 4);
+    nanocbor_fmt_uint(enc, 1);
+    nanocbor_put_bstr(enc, payload, payload_len);
+    nanocbor_put_tstrn(enc, text, sizeof(text) - 1);
+    nanocbor_put_bstr(enc, payload, 4);
+}
+
+static void test_iovec_encode(void)
+{
+    uint8_t payload[300];
+    uint8_t expected[512];
+    uint8_t out[512];
+    uint8_t buf[32];
+    nanocbor_iovec_t iov[8];
+    nanocbor_iovec_encoder_t ienc;
+    nanocbor_encoder_t enc;
+
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)i;
+    }
+    nanocbor_encoder_init(&enc, expected, sizeof(expected));
+    _encode(&enc, payload, sizeof(payload));
+    size_t len = nanocbor_encoded_len(&enc);
+
+    nanocbor_iovec_encoder_init(&ienc, buf, sizeof(buf), iov, 8, 16);
+    nanocbor_fmt_array(&ienc.enc, 4);
+    nanocbor_fmt_uint(&ienc.enc, 1);
+    CU_ASSERT_EQUAL(nanocbor_iovec_put_bstr(&ienc, payload, sizeof(payload)),
+                    NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_iovec_put_tstr(&ienc, text, sizeof(text) - 1),
+                    NANOCBOR_OK);
+    /* Below the threshold, copied */
+    CU_ASSERT_EQUAL(nanocbor_iovec_put_bstr(&ienc, payload, 4), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_iovec_finish(&ienc), 5);
+    CU_ASSERT_EQUAL(nanocbor_encoded_len(&ienc.enc), len);
+
+    /* Payloads are referenced, not copied */
+    CU_ASSERT_PTR_EQUAL(iov[1].base, payload);
+    CU_ASSERT_EQUAL(iov[1].len, sizeof(payload));
+    CU_ASSERT_PTR_EQUAL(iov[3].base, text);
+
+    size_t pos = 0;
+    for (size_t i = 0; i < 5; i++) {
+        memcpy(out + pos, iov[i].base, iov[i].len);
+        pos += iov[i].len;
+    }
+    CU_ASSERT_EQUAL(pos, len);
+    CU_ASSERT_EQUAL(memcmp(out, expected, len), 0);
+
+    /* Too few vectors */
+    nanocbor_iovec_encoder_init(&ienc, buf, sizeof(buf), iov, 1, 16);
+    nanocbor_fmt_uint(&ienc.enc, 1);
+    CU_ASSERT_EQUAL(nanocbor_iovec_put_bstr(&ienc, payload, sizeof(payload)),
+                    NANOCBOR_ERR_END);
+    CU_ASSERT_EQUAL(nanocbor_iovec_finish(&ienc), 1);
+    CU_ASSERT_EQUAL(iov[0].len, 1);
+}
+
+const test_t tests_iovec[] = {
+    {
+        .f = test_iovec_encode,
+        .n = "Scatter-gather encoder test",
+    },
+    {
+        .f = NULL,
+        .n = NULL,
+    }
+};
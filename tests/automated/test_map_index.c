@@ -0,0 +1,88 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include "test.h"
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/map_index.h"
+#include <CUnit/CUnit.h>
+
+static void test_map_index(void)
+{
+    /* {"a": 1, 2: "b", -3: [4], "long key": 5, 1.5: 6, "a": 7, 2^64-1: 8} */
+    static const uint8_t map[] = {
+        0xa7, 0x61, 0x61, 0x01, 0x02, 0x61, 0x62, 0x22, 0x81, 0x04,
+        0x68, 0x6c, 0x6f, 0x6e, 0x67, 0x20, 0x6b, 0x65, 0x79, 0x05,
+        0xf9, 0x3e, 0x00, 0x06, 0x61, 0x61, 0x07,
+        0x1b, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x08,
+    };
+    nanocbor_map_index_entry_t entries[8];
+    nanocbor_map_index_t index;
+    nanocbor_value_t val;
+    nanocbor_value_t cont;
+    nanocbor_value_t found;
+    uint32_t tmp = 0;
+    const uint8_t *str = NULL;
+    size_t len = 0;
+
+    nanocbor_decoder_init(&val, map, sizeof(map));
+    CU_ASSERT_EQUAL(nanocbor_enter_map(&val, &cont), NANOCBOR_OK);
+
+    nanocbor_map_index_init(&index, entries, sizeof(entries) / sizeof(entries[0]));
+    CU_ASSERT_EQUAL(nanocbor_map_index_build(&index, &cont), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(index.used, 4);
+
+    CU_ASSERT_EQUAL(nanocbor_map_index_get_tstr(&index, "a", &found), NANOCBOR_OK);
+    CU_ASSERT(nanocbor_get_uint32(&found, &tmp) > 0);
+    CU_ASSERT_EQUAL(tmp, 1);
+
+    CU_ASSERT_EQUAL(nanocbor_map_index_get_int(&index, 2, &found), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_get_tstr(&found, &str, &len), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(len, 1);
+    CU_ASSERT_EQUAL(*str, 'b');
+
+    CU_ASSERT_EQUAL(nanocbor_map_index_get_int(&index, -3, &found), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_get_type(&found), NANOCBOR_TYPE_ARR);
+
+    CU_ASSERT_EQUAL(nanocbor_map_index_get_tstr(&index, "long key", &found), NANOCBOR_OK);
+    CU_ASSERT(nanocbor_get_uint32(&found, &tmp) > 0);
+    CU_ASSERT_EQUAL(tmp, 5);
+
+    CU_ASSERT_EQUAL(nanocbor_map_index_get_tstr(&index, "long", &found), NANOCBOR_NOT_FOUND);
+    CU_ASSERT_EQUAL(nanocbor_map_index_get_tstr(&index, "b", &found), NANOCBOR_NOT_FOUND);
+    CU_ASSERT_EQUAL(nanocbor_map_index_get_int(&index, 3, &found), NANOCBOR_NOT_FOUND);
+
+    /* Table too small */
+    nanocbor_map_index_init(&index, entries, 3);
+    CU_ASSERT_EQUAL(nanocbor_map_index_build(&index, &cont), NANOCBOR_ERR_OVERFLOW);
+
+    /* Truncated map */
+    nanocbor_decoder_init(&val, map, 9);
+    CU_ASSERT_EQUAL(nanocbor_enter_map(&val, &cont), NANOCBOR_OK);
+    nanocbor_map_index_init(&index, entries, sizeof(entries) / sizeof(entries[0]));
+    CU_ASSERT_EQUAL(nanocbor_map_index_build(&index, &cont), NANOCBOR_ERR_END);
+
+    /* Truncated after the first pair */
+    nanocbor_decoder_init(&val, map, 4);
+    CU_ASSERT_EQUAL(nanocbor_enter_map(&val, &cont), NANOCBOR_OK);
+    nanocbor_map_index_init(&index, entries, sizeof(entries) / sizeof(entries[0]));
+    CU_ASSERT_EQUAL(nanocbor_map_index_build(&index, &cont), NANOCBOR_ERR_END);
+
+    /* Key shorter than its declared length */
+    static const uint8_t short_key[] = { 0xa1, 0x78, 0xff, 0x61 };
+    nanocbor_decoder_init(&val, short_key, sizeof(short_key));
+    CU_ASSERT_EQUAL(nanocbor_enter_map(&val, &cont), NANOCBOR_OK);
+    nanocbor_map_index_init(&index, entries, sizeof(entries) / sizeof(entries[0]));
+    CU_ASSERT_EQUAL(nanocbor_map_index_build(&index, &cont), NANOCBOR_ERR_END);
+}
+
+const test_t tests_map_index[] = {
+    {
+        .f = test_map_index,
+        .n = "Map key index tests",
+    },
+    {
+        .f = NULL,
+        .n = NULL,
+    }
+};
@@ -0,0 +1,175 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include "test.h"
+#include "nanocbor/config.h"
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/query.h"
+#include <CUnit/CUnit.h>
+#include <string.h>
+
+/* {1: 0, 3: {"unit": "C", "temp": [21, 22]}, "skip": {"temp": 5},
+ *  -1: 1([7, 8, 9])} */
+static const uint8_t doc[] = {
+    0xa4, 0x01, 0x00, 0x03, 0xa2, 0x64, 0x75, 0x6e, 0x69, 0x74, 0x61, 0x43,
+    0x64, 0x74, 0x65, 0x6d, 0x70, 0x82, 0x15, 0x16, 0x64, 0x73, 0x6b, 0x69,
+    0x70, 0xa1, 0x64, 0x74, 0x65, 0x6d, 0x70, 0x05, 0x20, 0xc1, 0x83, 0x07,
+    0x08, 0x09,
+};
+
+static void test_query_compile(void)
+{
+    nanocbor_query_node_t nodes[4];
+    nanocbor_query_t query;
+
+    nanocbor_query_init(&query, nodes, 4);
+    CU_ASSERT_EQUAL(nanocbor_query_add(&query, "/3/\"temp\"/0"), 0);
+    CU_ASSERT_EQUAL(query.used, 4);
+    /* Shared prefix and duplicate paths reuse nodes */
+    CU_ASSERT_EQUAL(nanocbor_query_add(&query, "/3"), 1);
+    CU_ASSERT_EQUAL(nanocbor_query_add(&query, "/3/\"temp\"/0"), 0);
+    CU_ASSERT_EQUAL(nanocbor_query_add(&query, "/"), 2);
+    CU_ASSERT_EQUAL(query.used, 4);
+    CU_ASSERT_EQUAL(query.paths, 3);
+
+    CU_ASSERT_EQUAL(nanocbor_query_add(&query, "/4"), NANOCBOR_ERR_OVERFLOW);
+    CU_ASSERT_EQUAL(nanocbor_query_add(&query, ""), NANOCBOR_ERR_INVALID_TYPE);
+    CU_ASSERT_EQUAL(nanocbor_query_add(&query, "3"),
+                    NANOCBOR_ERR_INVALID_TYPE);
+    CU_ASSERT_EQUAL(nanocbor_query_add(&query, "/3/"),
+                    NANOCBOR_ERR_INVALID_TYPE);
+    CU_ASSERT_EQUAL(nanocbor_query_add(&query, "/3x"),
+                    NANOCBOR_ERR_INVALID_TYPE);
+    CU_ASSERT_EQUAL(nanocbor_query_add(&query, "/\"temp"),
+                    NANOCBOR_ERR_INVALID_TYPE);
+    CU_ASSERT_EQUAL(nanocbor_query_add(&query, "/99999999999999999999"),
+                    NANOCBOR_ERR_INVALID_TYPE);
+    CU_ASSERT_EQUAL(query.used, 4);
+}
+
+static void test_query_run(void)
+{
+    nanocbor_query_node_t nodes[16];
+    nanocbor_query_t query;
+    nanocbor_value_t it;
+    nanocbor_value_t results[6];
+    uint32_t num = 0;
+    int32_t snum = 0;
+    const uint8_t *str = NULL;
+    size_t len = 0;
+
+    nanocbor_query_init(&query, nodes, 16);
+    int temp = nanocbor_query_add(&query, "/3/\"temp\"/1");
+    int unit = nanocbor_query_add(&query, "/3/\"unit\"");
+    int tagged = nanocbor_query_add(&query, "/-1/2");
+    int missing = nanocbor_query_add(&query, "/3/\"temp\"/2");
+    int scalar = nanocbor_query_add(&query, "/1/0");
+    int root = nanocbor_query_add(&query, "/");
+
+    nanocbor_decoder_init(&it, doc, sizeof(doc));
+    CU_ASSERT_EQUAL(nanocbor_query_run(&query, &it, results), 4);
+    /* The document itself is not advanced */
+    CU_ASSERT_PTR_EQUAL(it.cur, doc);
+
+    CU_ASSERT(nanocbor_get_uint32(&results[temp], &num) > 0);
+    CU_ASSERT_EQUAL(num, 22);
+    CU_ASSERT_EQUAL(nanocbor_get_tstr(&results[unit], &str, &len),
+                    NANOCBOR_OK);
+    CU_ASSERT_EQUAL(len, 1);
+    CU_ASSERT_EQUAL(nanocbor_get_int32(&results[tagged], &snum), 1);
+    CU_ASSERT_EQUAL(snum, 9);
+    CU_ASSERT_PTR_NULL(results[missing].cur);
+    CU_ASSERT_PTR_NULL(results[scalar].cur);
+    CU_ASSERT_PTR_EQUAL(results[root].cur, doc);
+}
+
+static void test_query_first(void)
+{
+    /* {1: 2, 1: 3, [1]: 4} */
+    static const uint8_t dup[] = {
+        0xa3, 0x01, 0x02, 0x01, 0x03, 0x81, 0x01, 0x04,
+    };
+    nanocbor_query_node_t nodes[4];
+    nanocbor_query_t query;
+    nanocbor_value_t it;
+    nanocbor_value_t results[1];
+    uint32_t num = 0;
+
+    nanocbor_query_init(&query, nodes, 4);
+    CU_ASSERT_EQUAL(nanocbor_query_add(&query, "/1"), 0);
+    nanocbor_decoder_init(&it, dup, sizeof(dup));
+    CU_ASSERT_EQUAL(nanocbor_query_run(&query, &it, results), 1);
+    CU_ASSERT(nanocbor_get_uint32(&results[0], &num) > 0);
+    CU_ASSERT_EQUAL(num, 2);
+}
+
+static void test_query_malformed(void)
+{
+    /* {3: {"temp": [21, <truncated> */
+    static const uint8_t trunc[] = {
+        0xa1, 0x03, 0xa1, 0x64, 0x74, 0x65, 0x6d, 0x70, 0x82, 0x15,
+    };
+    nanocbor_query_node_t nodes[4];
+    nanocbor_query_t query;
+    nanocbor_value_t it;
+    nanocbor_value_t results[1];
+
+    nanocbor_query_init(&query, nodes, 4);
+    CU_ASSERT_EQUAL(nanocbor_query_add(&query, "/3/\"temp\"/1"), 0);
+    nanocbor_decoder_init(&it, trunc, sizeof(trunc));
+    CU_ASSERT(nanocbor_query_run(&query, &it, results) < 0);
+}
+
+static void test_query_tags(void)
+{
+    /* 64 bit tag on an empty map */
+    static const uint8_t tag64[] = {
+        0xdb, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0xa0,
+    };
+    /* {1: <truncated tag> */
+    static const uint8_t trunc[] = { 0xa1, 0x01, 0xd8 };
+    nanocbor_query_node_t nodes[4];
+    nanocbor_query_t query;
+    nanocbor_value_t it;
+    nanocbor_value_t results[1];
+
+    nanocbor_query_init(&query, nodes, 4);
+    CU_ASSERT_EQUAL(nanocbor_query_add(&query, "/1"), 0);
+    nanocbor_decoder_init(&it, tag64, sizeof(tag64));
+    CU_ASSERT_EQUAL(nanocbor_query_run(&query, &it, results), 0);
+    CU_ASSERT_PTR_NULL(results[0].cur);
+
+    nanocbor_query_init(&query, nodes, 4);
+    CU_ASSERT_EQUAL(nanocbor_query_add(&query, "/1/0"), 0);
+    nanocbor_decoder_init(&it, trunc, sizeof(trunc));
+    CU_ASSERT_EQUAL(nanocbor_query_run(&query, &it, results),
+                    NANOCBOR_ERR_END);
+}
+
+const test_t tests_query[] = {
+    {
+        .f = test_query_compile,
+        .n = "Query path compile test",
+    },
+    {
+        .f = test_query_run,
+        .n = "Query run test",
+    },
+    {
+        .f = test_query_first,
+        .n = "Query duplicate key test",
+    },
+    {
+        .f = test_query_malformed,
+        .n = "Query malformed document test",
+    },
+    {
+        .f = test_query_tags,
+        .n = "Query tagged document test",
+    },
+    {
+        .f = NULL,
+        .n = NULL,
+    }
+};
@@ -0,0 +1,237 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include "test.h"
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/schema.h"
+#include <string.h>
+#include <CUnit/CUnit.h>
+
+struct location {
+    double lat;
+    double lon;
+};
+
+struct record {
+    uint16_t id;
+    int32_t temp;
+    int64_t time;
+    bool valid;
+    float ratio;
+    nanocbor_schema_str_t name;
+    nanocbor_schema_str_t data;
+    nanocbor_value_t extra;
+    struct location loc;
+};
+
+static const nanocbor_schema_field_t location_fields[] = {
+    { .name = "lat", .type = NANOCBOR_SCHEMA_FLOAT,
+      NANOCBOR_SCHEMA_MEMBER(struct location, lat) },
+    { .name = "lon", .type = NANOCBOR_SCHEMA_FLOAT,
+      NANOCBOR_SCHEMA_MEMBER(struct location, lon) },
+};
+
+static const nanocbor_schema_t location_schema = { location_fields, 2 };
+
+static const nanocbor_schema_field_t record_fields[] = {
+    { .key = 1, .type = NANOCBOR_SCHEMA_UINT, .flags = NANOCBOR_SCHEMA_REQUIRED,
+      NANOCBOR_SCHEMA_MEMBER(struct record, id) },
+    { .key = -2, .type = NANOCBOR_SCHEMA_INT,
+      NANOCBOR_SCHEMA_MEMBER(struct record, temp) },
+    { .key = 3, .type = NANOCBOR_SCHEMA_INT,
+      NANOCBOR_SCHEMA_MEMBER(struct record, time) },
+    { .key = 4, .type = NANOCBOR_SCHEMA_BOOL,
+      NANOCBOR_SCHEMA_MEMBER(struct record, valid) },
+    { .key = 5, .type = NANOCBOR_SCHEMA_FLOAT,
+      NANOCBOR_SCHEMA_MEMBER(struct record, ratio) },
+    { .name = "n", .type = NANOCBOR_SCHEMA_TSTR,
+      NANOCBOR_SCHEMA_MEMBER(struct record, name) },
+    { .name = "d", .type = NANOCBOR_SCHEMA_BSTR,
+      NANOCBOR_SCHEMA_MEMBER(struct record, data) },
+    { .name = "x", .type = NANOCBOR_SCHEMA_VALUE,
+      NANOCBOR_SCHEMA_MEMBER(struct record, extra) },
+    { .name = "loc", .type = NANOCBOR_SCHEMA_MAP, .nested = &location_schema,
+      NANOCBOR_SCHEMA_MEMBER(struct record, loc) },
+};
+
+static const nanocbor_schema_t record_schema = {
+    record_fields, sizeof(record_fields) / sizeof(record_fields[0])
+};
+
+static size_t _encode_record(uint8_t *buf, size_t len, bool with_id)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, buf, len);
+    nanocbor_fmt_array(&enc, 2);
+    nanocbor_fmt_map(&enc, with_id ? 12 : 11);
+    if (with_id) {
+        nanocbor_fmt_uint(&enc, 1);
+        nanocbor_fmt_uint(&enc, 513);
+    }
+    nanocbor_fmt_int(&enc, -2);
+    nanocbor_fmt_int(&enc, -40);
+    nanocbor_fmt_uint(&enc, 3);
+    nanocbor_fmt_uint(&enc, 1600000000000000000ULL);
+    nanocbor_fmt_uint(&enc, 4);
+    nanocbor_fmt_bool(&enc, true);
+    nanocbor_fmt_uint(&enc, 5);
+    nanocbor_fmt_float(&enc, 0.5);
+    nanocbor_put_tstr(&enc, "n");
+    nanocbor_put_tstr(&enc, "sensor");
+    nanocbor_put_tstr(&enc, "d");
+    nanocbor_put_bstr(&enc, (const uint8_t *)"\x01\x02", 2);
+    /* Unknown keys */
+    nanocbor_put_tstr(&enc, "unknown");
+    nanocbor_fmt_array(&enc, 1);
+    nanocbor_fmt_null(&enc);
+    nanocbor_fmt_uint(&enc, 42);
+    nanocbor_fmt_null(&enc);
+    nanocbor_put_tstr(&enc, "x");
+    nanocbor_fmt_array(&enc, 0);
+    nanocbor_put_tstr(&enc, "loc");
+    nanocbor_fmt_map(&enc, 2);
+    nanocbor_put_tstr(&enc, "lon");
+    nanocbor_fmt_double(&enc, 5.1);
+    nanocbor_put_tstr(&enc, "lat");
+    nanocbor_fmt_double(&enc, 52.2);
+    /* Duplicate key, ignored */
+    nanocbor_fmt_int(&enc, -2);
+    nanocbor_fmt_int(&enc, 100);
+    nanocbor_fmt_uint(&enc, 7);
+    return nanocbor_encoded_len(&enc);
+}
+
+static void test_schema_decode(void)
+{
+    uint8_t buf[128];
+    size_t len = _encode_record(buf, sizeof(buf), true);
+    nanocbor_value_t val;
+    nanocbor_value_t arr;
+    struct record record;
+    uint32_t found = 0;
+    uint32_t tmp = 0;
+
+    CU_ASSERT(len <= sizeof(buf));
+    memset(&record, 0, sizeof(record));
+
+    nanocbor_decoder_init(&val, buf, len);
+    CU_ASSERT_EQUAL(nanocbor_enter_array(&val, &arr), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_schema_decode(&arr, &record_schema, &record, &found),
+                    NANOCBOR_OK);
+    CU_ASSERT_EQUAL(found, 0x1FF);
+    CU_ASSERT_EQUAL(record.id, 513);
+    CU_ASSERT_EQUAL(record.temp, -40);
+    CU_ASSERT_EQUAL(record.time, 1600000000000000000LL);
+    CU_ASSERT_EQUAL(record.valid, true);
+    CU_ASSERT_EQUAL(record.ratio, 0.5);
+    CU_ASSERT_EQUAL(record.name.len, 6);
+    CU_ASSERT_NSTRING_EQUAL(record.name.buf, "sensor", 6);
+    CU_ASSERT_EQUAL(record.data.len, 2);
+    CU_ASSERT_EQUAL(nanocbor_get_type(&record.extra), NANOCBOR_TYPE_ARR);
+    CU_ASSERT_EQUAL(record.loc.lat, 52.2);
+    CU_ASSERT_EQUAL(record.loc.lon, 5.1);
+
+    /* Decoder advanced past the map */
+    CU_ASSERT(nanocbor_get_uint32(&arr, &tmp) > 0);
+    CU_ASSERT_EQUAL(tmp, 7);
+
+    /* Missing required field */
+    len = _encode_record(buf, sizeof(buf), false);
+    nanocbor_decoder_init(&val, buf, len);
+    CU_ASSERT_EQUAL(nanocbor_enter_array(&val, &arr), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_schema_decode(&arr, &record_schema, &record, NULL),
+                    NANOCBOR_NOT_FOUND);
+
+    /* Truncated map */
+    nanocbor_decoder_init(&val, buf, len - 8);
+    CU_ASSERT_EQUAL(nanocbor_enter_array(&val, &arr), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_schema_decode(&arr, &record_schema, &record, NULL),
+                    NANOCBOR_ERR_END);
+
+    /* Type mismatch */
+    static const uint8_t wrong[] = { 0xa1, 0x01, 0x61, 0x61 };
+    nanocbor_decoder_init(&val, wrong, sizeof(wrong));
+    CU_ASSERT_EQUAL(nanocbor_schema_decode(&val, &record_schema, &record, NULL),
+                    NANOCBOR_ERR_INVALID_TYPE);
+}
+
+struct node {
+    uint32_t value;
+};
+
+static const nanocbor_schema_t node_schema;
+
+/* Refers to itself, the depth only depends on the input */
+static const nanocbor_schema_field_t node_fields[] = {
+    { .key = 0, .type = NANOCBOR_SCHEMA_UINT,
+      NANOCBOR_SCHEMA_MEMBER(struct node, value) },
+    { .key = 1, .type = NANOCBOR_SCHEMA_MAP, .nested = &node_schema,
+      .offset = 0, .size = sizeof(struct node) },
+};
+
+static const nanocbor_schema_t node_schema = { node_fields, 2 };
+
+static void test_schema_limits(void)
+{
+    nanocbor_schema_field_t fields[NANOCBOR_SCHEMA_FIELDS_MAX];
+    const nanocbor_schema_t wide = { fields, NANOCBOR_SCHEMA_FIELDS_MAX };
+    uint32_t values[NANOCBOR_SCHEMA_FIELDS_MAX];
+    uint8_t buf[64];
+    nanocbor_encoder_t enc;
+    nanocbor_value_t val;
+    struct node node;
+    uint32_t found = 0;
+
+    /* Unknown key with the maximum number of fields */
+    memset(fields, 0, sizeof(fields));
+    for (unsigned i = 0; i < NANOCBOR_SCHEMA_FIELDS_MAX; i++) {
+        fields[i].key = (int32_t)i;
+        fields[i].type = NANOCBOR_SCHEMA_UINT;
+        fields[i].offset = i * sizeof(uint32_t);
+        fields[i].size = sizeof(uint32_t);
+    }
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    nanocbor_fmt_map(&enc, 2);
+    nanocbor_fmt_uint(&enc, 100);
+    nanocbor_fmt_uint(&enc, 1);
+    nanocbor_fmt_uint(&enc, 31);
+    nanocbor_fmt_uint(&enc, 2);
+    nanocbor_decoder_init(&val, buf, nanocbor_encoded_len(&enc));
+    CU_ASSERT_EQUAL(nanocbor_schema_decode(&val, &wide, values, &found),
+                    NANOCBOR_OK);
+    CU_ASSERT_EQUAL(found, 0x80000000U);
+    CU_ASSERT_EQUAL(values[31], 2);
+
+    /* Nesting depth is bounded for a self-referential schema */
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    for (unsigned i = 0; i < NANOCBOR_RECURSION_MAX; i++) {
+        nanocbor_fmt_map(&enc, 1);
+        nanocbor_fmt_uint(&enc, 1);
+    }
+    nanocbor_fmt_map(&enc, 0);
+    nanocbor_decoder_init(&val, buf, nanocbor_encoded_len(&enc));
+    CU_ASSERT_EQUAL(nanocbor_schema_decode(&val, &node_schema, &node, NULL),
+                    NANOCBOR_ERR_RECURSION);
+
+    /* One level less fits */
+    nanocbor_decoder_init(&val, buf + 2, nanocbor_encoded_len(&enc) - 2);
+    CU_ASSERT_EQUAL(nanocbor_schema_decode(&val, &node_schema, &node, NULL),
+                    NANOCBOR_OK);
+}
+
+const test_t tests_schema[] = {
+    {
+        .f = test_schema_decode,
+        .n = "Schema driven map decode tests",
+    },
+    {
+        .f = test_schema_limits,
+        .n = "Schema field count and depth limit tests",
+    },
+    {
+        .f = NULL,
+        .n = NULL,
+    }
+};
@@ -0,0 +1,215 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include "test.h"
+#include "nanocbor/config.h"
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/sequence.h"
+#include "nanocbor/host/mmap.h"
+#include "nanocbor/host/parallel.h"
+#include <CUnit/CUnit.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+/* 1, [2, 3], "abc", {4: 5}, h'' */
+static const uint8_t sequence[] = {
+    0x01, 0x82, 0x02, 0x03, 0x63, 0x61, 0x62, 0x63, 0xa1, 0x04, 0x05, 0x40,
+};
+
+static void test_sequence_next(void)
+{
+    static const size_t lens[] = { 1, 3, 4, 3, 1 };
+    nanocbor_value_t seq;
+    const uint8_t *item = NULL;
+    size_t len = 0;
+    size_t pos = 0;
+
+    nanocbor_decoder_init(&seq, sequence, sizeof(sequence));
+    for (size_t i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+        CU_ASSERT_EQUAL(nanocbor_sequence_next(&seq, &item, &len),
+                        NANOCBOR_OK);
+        CU_ASSERT_PTR_EQUAL(item, sequence + pos);
+        CU_ASSERT_EQUAL(len, lens[i]);
+        pos += len;
+    }
+    CU_ASSERT_EQUAL(nanocbor_sequence_next(&seq, &item, &len),
+                    NANOCBOR_NOT_FOUND);
+
+    /* Truncated last item */
+    nanocbor_decoder_init(&seq, sequence, 3);
+    CU_ASSERT_EQUAL(nanocbor_sequence_next(&seq, &item, &len), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_sequence_next(&seq, &item, &len),
+                    NANOCBOR_ERR_END);
+    CU_ASSERT_PTR_EQUAL(seq.cur, sequence + 1);
+}
+
+static void test_sequence_split(void)
+{
+    size_t offsets[8];
+
+    CU_ASSERT_EQUAL(nanocbor_sequence_split(sequence, sizeof(sequence),
+                                            offsets, 3), 3);
+    /* Targets at 0, 4 and 8 */
+    CU_ASSERT_EQUAL(offsets[0], 0);
+    CU_ASSERT_EQUAL(offsets[1], 4);
+    CU_ASSERT_EQUAL(offsets[2], 8);
+
+    /* No more slices than items */
+    CU_ASSERT_EQUAL(nanocbor_sequence_split(sequence, sizeof(sequence),
+                                            offsets, 8), 5);
+    CU_ASSERT_EQUAL(offsets[4], 11);
+
+    CU_ASSERT_EQUAL(nanocbor_sequence_split(sequence, sizeof(sequence),
+                                            offsets, 1), 1);
+    CU_ASSERT_EQUAL(nanocbor_sequence_split(sequence, 0, offsets, 4), 0);
+
+    /* Truncated array before the last slice */
+    CU_ASSERT_EQUAL(nanocbor_sequence_split(sequence + 1, 2, offsets, 2),
+                    NANOCBOR_ERR_END);
+    /* The last slice is left for the consumer */
+    CU_ASSERT_EQUAL(nanocbor_sequence_split(sequence, 3, offsets, 2), 2);
+}
+
+static void test_sequence_mmap(void)
+{
+    char path[] = "/tmp/nanocbor_seq_XXXXXX";
+    nanocbor_mmap_t map;
+    int fd = mkstemp(path);
+
+    CU_ASSERT(fd >= 0);
+    if (fd < 0) {
+        return;
+    }
+    CU_ASSERT_EQUAL(write(fd, sequence, sizeof(sequence)),
+                    (ssize_t)sizeof(sequence));
+    close(fd);
+
+    CU_ASSERT_EQUAL(nanocbor_mmap_open(&map, path), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(map.len, sizeof(sequence));
+    CU_ASSERT_EQUAL(memcmp(map.buf, sequence, sizeof(sequence)), 0);
+    nanocbor_mmap_close(&map);
+    CU_ASSERT_PTR_NULL(map.buf);
+
+    unlink(path);
+    CU_ASSERT_EQUAL(nanocbor_mmap_open(&map, path), NANOCBOR_ERR_SYSTEM);
+    CU_ASSERT_EQUAL(map.error, ENOENT);
+}
+
+#define PARALLEL_RECORDS    (10000U)
+
+static uint8_t parallel_seq[PARALLEL_RECORDS * 8U];
+static uint8_t parallel_seen[PARALLEL_RECORDS];
+static size_t parallel_offsets[PARALLEL_RECORDS];
+
+/* Sequence of [i, "x"] records, returns the length */
+static size_t _parallel_prepare(void)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, parallel_seq, sizeof(parallel_seq));
+    for (uint32_t i = 0; i < PARALLEL_RECORDS; i++) {
+        parallel_offsets[i] = nanocbor_encoded_len(&enc);
+        nanocbor_fmt_array(&enc, 2);
+        nanocbor_fmt_uint(&enc, i);
+        nanocbor_put_tstr(&enc, "x");
+    }
+    memset(parallel_seen, 0, sizeof(parallel_seen));
+    return nanocbor_encoded_len(&enc);
+}
+
+static int _parallel_cb(void *ctx, nanocbor_value_t *record, size_t offset)
+{
+    uint32_t *fail = ctx;
+    nanocbor_value_t arr;
+    uint32_t num = 0;
+
+    (void)offset;
+    if (nanocbor_enter_array(record, &arr) < 0 ||
+        nanocbor_get_uint32(&arr, &num) < 0 || num >= PARALLEL_RECORDS) {
+        return NANOCBOR_ERR_INVALID_TYPE;
+    }
+    /* Every record has its own slot, no locking required */
+    parallel_seen[num]++;
+    return (fail && num >= *fail) ? NANOCBOR_NOT_FOUND : NANOCBOR_OK;
+}
+
+static void test_sequence_parallel(void)
+{
+    nanocbor_parallel_result_t result;
+    size_t len = _parallel_prepare();
+    uint32_t fail = 6000;
+
+    CU_ASSERT_EQUAL(nanocbor_parallel_process(parallel_seq, len, 4,
+                                              _parallel_cb, NULL, &result),
+                    NANOCBOR_OK);
+    CU_ASSERT_EQUAL(result.records, PARALLEL_RECORDS);
+    CU_ASSERT_EQUAL(result.offset, len);
+    size_t once = 0;
+    for (size_t i = 0; i < PARALLEL_RECORDS; i++) {
+        once += parallel_seen[i] == 1;
+    }
+    CU_ASSERT_EQUAL(once, PARALLEL_RECORDS);
+
+    /* The first failing record in sequence order is reported */
+    CU_ASSERT_EQUAL(nanocbor_parallel_process(parallel_seq, len, 4,
+                                              _parallel_cb, &fail, &result),
+                    NANOCBOR_NOT_FOUND);
+    CU_ASSERT_EQUAL(result.records, fail);
+    CU_ASSERT_EQUAL(result.offset, parallel_offsets[fail]);
+
+    /* Validation only */
+    CU_ASSERT_EQUAL(nanocbor_parallel_process(parallel_seq, len, 4, NULL,
+                                              NULL, &result), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(result.records, PARALLEL_RECORDS);
+
+    /* Text strings are validated by the threads, not by the split */
+    parallel_seq[parallel_offsets[3000] + 5] = 0xff;
+#if NANOCBOR_VALIDATE_UTF8
+    CU_ASSERT_EQUAL(nanocbor_parallel_process(parallel_seq, len, 4, NULL,
+                                              NULL, &result),
+                    NANOCBOR_ERR_INVALID_UTF8);
+    CU_ASSERT_EQUAL(result.records, 3000);
+    CU_ASSERT_EQUAL(result.offset, parallel_offsets[3000]);
+#else
+    CU_ASSERT_EQUAL(nanocbor_parallel_process(parallel_seq, len, 4, NULL,
+                                              NULL, &result), NANOCBOR_OK);
+#endif
+    parallel_seq[parallel_offsets[3000] + 5] = 'x';
+
+    /* Validation only, with a malformed record */
+    parallel_seq[parallel_offsets[2000]] = 0x1c;
+    CU_ASSERT(nanocbor_parallel_process(parallel_seq, len, 0, NULL, NULL,
+                                        &result) < 0);
+    CU_ASSERT_EQUAL(result.records, 2000);
+    CU_ASSERT_EQUAL(result.offset, parallel_offsets[2000]);
+
+    CU_ASSERT_EQUAL(nanocbor_parallel_process(parallel_seq, 0, 4, NULL, NULL,
+                                              &result), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(result.records, 0);
+}
+
+const test_t tests_sequence[] = {
+    {
+        .f = test_sequence_next,
+        .n = "CBOR sequence iterator test",
+    },
+    {
+        .f = test_sequence_split,
+        .n = "CBOR sequence split test",
+    },
+    {
+        .f = test_sequence_mmap,
+        .n = "Memory mapped file test",
+    },
+    {
+        .f = test_sequence_parallel,
+        .n = "Parallel sequence processing test",
+    },
+    {
+        .f = NULL,
+        .n = NULL,
+    }
+};
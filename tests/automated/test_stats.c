@@ -0,0 +1,177 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include "test.h"
+#include "nanocbor/config.h"
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/stats.h"
+#include <CUnit/CUnit.h>
+#include <string.h>
+
+#if NANOCBOR_STATS
+
+typedef struct {
+    unsigned calls;
+    nanocbor_trace_event_t event;
+    const uint8_t *pos;
+    int code;
+} trace_record_t;
+
+static void _trace(void *ctx, nanocbor_trace_event_t event,
+                   const uint8_t *pos, int code)
+{
+    trace_record_t *rec = ctx;
+
+    rec->calls++;
+    rec->event = event;
+    rec->pos = pos;
+    rec->code = code;
+}
+
+static int _sink_fail(nanocbor_encoder_t *enc, void *ctx, size_t len)
+{
+    (void)enc;
+    (void)ctx;
+    (void)len;
+    return NANOCBOR_ERR_END;
+}
+
+static void test_stats_skip(void)
+{
+    /* [1, [2, 3], {"a": 4, "b": 5}] */
+    static const uint8_t doc[] = {
+        0x83, 0x01, 0x82, 0x02, 0x03, 0xa2, 0x61, 0x61, 0x04, 0x61, 0x62,
+        0x05,
+    };
+    nanocbor_value_t it;
+
+    nanocbor_stats_reset();
+    nanocbor_decoder_init(&it, doc, sizeof(doc));
+    CU_ASSERT_EQUAL(nanocbor_skip(&it), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_stats.skipped, 10);
+    CU_ASSERT_EQUAL(nanocbor_stats.skipped_bytes, sizeof(doc));
+    CU_ASSERT_EQUAL(nanocbor_stats.skip_depth, 2);
+    CU_ASSERT_EQUAL(nanocbor_stats.decoded, 1);
+    CU_ASSERT_EQUAL(nanocbor_stats.errors, 0);
+}
+
+static void test_stats_key_probes(void)
+{
+    /* {"a": 4, "b": 5} */
+    static const uint8_t tstr_map[] = {
+        0xa2, 0x61, 0x61, 0x04, 0x61, 0x62, 0x05,
+    };
+    /* {1: 0, 2: 0, 3: 0} */
+    static const uint8_t int_map[] = {
+        0xa3, 0x01, 0x00, 0x02, 0x00, 0x03, 0x00,
+    };
+    nanocbor_value_t it;
+    nanocbor_value_t map;
+    nanocbor_value_t value;
+
+    nanocbor_stats_reset();
+    nanocbor_decoder_init(&it, tstr_map, sizeof(tstr_map));
+    CU_ASSERT_EQUAL(nanocbor_enter_map(&it, &map), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_get_key_tstr(&map, "b", &value), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_stats.key_probes, 2);
+
+    nanocbor_stats_reset();
+    nanocbor_decoder_init(&it, int_map, sizeof(int_map));
+    CU_ASSERT_EQUAL(nanocbor_enter_map(&it, &map), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_get_key_int(&map, 3, &value), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(nanocbor_stats.key_probes, 3);
+}
+
+static void test_stats_trace(void)
+{
+    static const uint8_t tstr[] = { 0x61, 0x61 };
+    /* [1, 2, truncated */
+    static const uint8_t truncated[] = { 0x83, 0x01, 0x02 };
+    trace_record_t rec = { 0 };
+    nanocbor_value_t it;
+    uint8_t num = 0;
+
+    nanocbor_stats_reset();
+    nanocbor_trace_set(_trace, &rec);
+
+    nanocbor_decoder_init(&it, tstr, sizeof(tstr));
+    CU_ASSERT_EQUAL(nanocbor_get_uint8(&it, &num), NANOCBOR_ERR_INVALID_TYPE);
+    CU_ASSERT_EQUAL(rec.calls, 1);
+    CU_ASSERT_EQUAL(rec.event, NANOCBOR_TRACE_DECODE_ERROR);
+    CU_ASSERT_PTR_EQUAL(rec.pos, tstr);
+    CU_ASSERT_EQUAL(rec.code, NANOCBOR_ERR_INVALID_TYPE);
+
+    nanocbor_decoder_init(&it, truncated, sizeof(truncated));
+    CU_ASSERT_EQUAL(nanocbor_skip(&it), NANOCBOR_ERR_END);
+    CU_ASSERT_EQUAL(rec.calls, 2);
+    CU_ASSERT_EQUAL(rec.event, NANOCBOR_TRACE_SKIP_ERROR);
+    CU_ASSERT_PTR_EQUAL(rec.pos, truncated);
+    CU_ASSERT_EQUAL(rec.code, NANOCBOR_ERR_END);
+    CU_ASSERT_EQUAL(nanocbor_stats.errors, 2);
+
+    /* Successful decoding is not traced */
+    nanocbor_decoder_init(&it, truncated + 1, 1);
+    CU_ASSERT_EQUAL(nanocbor_get_uint8(&it, &num), 1);
+    CU_ASSERT_EQUAL(rec.calls, 2);
+
+    nanocbor_trace_set(NULL, NULL);
+}
+
+static void test_stats_encoder(void)
+{
+    uint8_t buf[2];
+    trace_record_t rec = { 0 };
+    nanocbor_encoder_t enc;
+
+    nanocbor_stats_reset();
+    nanocbor_trace_set(_trace, &rec);
+
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    CU_ASSERT_EQUAL(nanocbor_fmt_uint(&enc, 1000), NANOCBOR_ERR_END);
+    CU_ASSERT_EQUAL(nanocbor_stats.encode_full, 1);
+    CU_ASSERT_EQUAL(rec.calls, 1);
+    CU_ASSERT_EQUAL(rec.event, NANOCBOR_TRACE_ENCODE_FULL);
+    CU_ASSERT_PTR_EQUAL(rec.pos, buf);
+
+    /* Determining the size is not an error */
+    nanocbor_encoder_init(&enc, NULL, 0);
+    CU_ASSERT(nanocbor_fmt_uint(&enc, 1000) < 0);
+    CU_ASSERT_EQUAL(nanocbor_encoded_len(&enc), 3);
+    CU_ASSERT_EQUAL(nanocbor_stats.encode_full, 1);
+    CU_ASSERT_EQUAL(rec.calls, 1);
+
+    nanocbor_encoder_sink_init(&enc, buf, sizeof(buf), _sink_fail, NULL);
+    CU_ASSERT_EQUAL(nanocbor_fmt_uint(&enc, 1000), NANOCBOR_ERR_END);
+    CU_ASSERT_EQUAL(nanocbor_stats.sink_calls, 1);
+    CU_ASSERT_EQUAL(nanocbor_stats.encode_full, 2);
+
+    nanocbor_trace_set(NULL, NULL);
+}
+
+#endif /* NANOCBOR_STATS */
+
+const test_t tests_stats[] = {
+#if NANOCBOR_STATS
+    {
+        .f = test_stats_skip,
+        .n = "Skip statistics test",
+    },
+    {
+        .f = test_stats_key_probes,
+        .n = "Key lookup statistics test",
+    },
+    {
+        .f = test_stats_trace,
+        .n = "Decoder trace hook test",
+    },
+    {
+        .f = test_stats_encoder,
+        .n = "Encoder statistics test",
+    },
+#endif
+    {
+        .f = NULL,
+        .n = NULL,
+    }
+};
@@ -0,0 +1,123 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include "test.h"
+#include "nanocbor/config.h"
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/tape.h"
+#include <CUnit/CUnit.h>
+#include <string.h>
+
+static void test_tape_build(void)
+{
+    /* {1: [2, 3, 4], "k": [_ [5], 6], 7: 1(8)}, 9 */
+    static const uint8_t doc[] = {
+        0xa3, 0x01, 0x83, 0x02, 0x03, 0x04, 0x61, 0x6b, 0x9f, 0x81, 0x05,
+        0x06, 0xff, 0x07, 0xc1, 0x08, 0x09,
+    };
+    nanocbor_tape_entry_t entries[16];
+    nanocbor_tape_t tape;
+    size_t child = 0;
+    uint32_t num = 0;
+
+    nanocbor_tape_init(&tape, entries, 16);
+    CU_ASSERT_EQUAL(nanocbor_tape_build(&tape, doc, sizeof(doc)), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(tape.used, 14);
+
+    /* Map */
+    CU_ASSERT_EQUAL(entries[0].type, NANOCBOR_TYPE_MAP);
+    CU_ASSERT_EQUAL(entries[0].count, 6);
+    CU_ASSERT_EQUAL(entries[0].end, sizeof(doc) - 1);
+    CU_ASSERT_EQUAL(nanocbor_tape_next(&tape, 0), 13);
+    CU_ASSERT_EQUAL(entries[13].offset, sizeof(doc) - 1);
+    CU_ASSERT_EQUAL(nanocbor_tape_next(&tape, 13), tape.used);
+
+    /* Array without nested containers, direct access */
+    CU_ASSERT_EQUAL(nanocbor_tape_child(&tape, 0, 1, &child), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(child, 2);
+    CU_ASSERT_EQUAL(entries[2].count, 3);
+    CU_ASSERT_EQUAL(nanocbor_tape_child(&tape, 2, 2, &child), NANOCBOR_OK);
+    nanocbor_value_t val;
+    nanocbor_tape_value(&tape, child, &val);
+    CU_ASSERT(nanocbor_get_uint32(&val, &num) > 0);
+    CU_ASSERT_EQUAL(num, 4);
+    CU_ASSERT_EQUAL(nanocbor_tape_child(&tape, 2, 3, &child),
+                    NANOCBOR_NOT_FOUND);
+
+    /* Indefinite array with a nested array */
+    CU_ASSERT_EQUAL(nanocbor_tape_child(&tape, 0, 3, &child), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(entries[child].count, 2);
+    CU_ASSERT_EQUAL(entries[child].end - entries[child].offset, 5);
+    CU_ASSERT_EQUAL(nanocbor_tape_child(&tape, child, 1, &child), NANOCBOR_OK);
+    nanocbor_tape_value(&tape, child, &val);
+    CU_ASSERT(nanocbor_get_uint32(&val, &num) > 0);
+    CU_ASSERT_EQUAL(num, 6);
+
+    /* Tagged item, the tag is part of the entry */
+    CU_ASSERT_EQUAL(nanocbor_tape_child(&tape, 0, 5, &child), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(entries[child].type, NANOCBOR_TYPE_UINT);
+    CU_ASSERT_EQUAL(entries[child].end - entries[child].offset, 2);
+    CU_ASSERT_EQUAL(doc[entries[child].offset], 0xc1);
+
+    /* Nested deeper, walks the preceding children */
+    CU_ASSERT_EQUAL(nanocbor_tape_child(&tape, 0, 4, &child), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(child, 11);
+
+    /* Not enough entries */
+    nanocbor_tape_init(&tape, entries, 8);
+    CU_ASSERT_EQUAL(nanocbor_tape_build(&tape, doc, sizeof(doc)),
+                    NANOCBOR_ERR_OVERFLOW);
+
+    /* Truncated */
+    nanocbor_tape_init(&tape, entries, 16);
+    CU_ASSERT_EQUAL(nanocbor_tape_build(&tape, doc, 5), NANOCBOR_ERR_END);
+
+    /* Tag number beyond 32 bits */
+    static const uint8_t tag64[] = {
+        0x81, 0xdb, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x01,
+    };
+    nanocbor_tape_init(&tape, entries, 16);
+    CU_ASSERT_EQUAL(nanocbor_tape_build(&tape, tag64, sizeof(tag64)),
+                    NANOCBOR_OK);
+    CU_ASSERT_EQUAL(tape.used, 2);
+    CU_ASSERT_EQUAL(entries[1].type, NANOCBOR_TYPE_UINT);
+    CU_ASSERT_EQUAL(entries[1].offset, 1);
+    CU_ASSERT_EQUAL(entries[1].end, sizeof(tag64));
+}
+
+static void test_tape_depth(void)
+{
+    uint8_t doc[NANOCBOR_RECURSION_MAX + 2];
+    nanocbor_tape_entry_t entries[NANOCBOR_RECURSION_MAX + 2];
+    nanocbor_tape_t tape;
+
+    /* Nested arrays up to the maximum depth */
+    memset(doc, 0x81, sizeof(doc));
+    doc[NANOCBOR_RECURSION_MAX] = 0x00;
+    nanocbor_tape_init(&tape, entries, NANOCBOR_RECURSION_MAX + 2);
+    CU_ASSERT_EQUAL(nanocbor_tape_build(&tape, doc, NANOCBOR_RECURSION_MAX + 1),
+                    NANOCBOR_OK);
+    CU_ASSERT_EQUAL(tape.used, NANOCBOR_RECURSION_MAX + 1);
+    CU_ASSERT_EQUAL(entries[0].next, NANOCBOR_RECURSION_MAX + 1);
+
+    doc[NANOCBOR_RECURSION_MAX] = 0x81;
+    doc[NANOCBOR_RECURSION_MAX + 1] = 0x00;
+    CU_ASSERT_EQUAL(nanocbor_tape_build(&tape, doc, sizeof(doc)),
+                    NANOCBOR_ERR_RECURSION);
+}
+
+const test_t tests_tape[] = {
+    {
+        .f = test_tape_build,
+        .n = "Tape build and navigation test",
+    },
+    {
+        .f = test_tape_depth,
+        .n = "Tape nesting depth test",
+    },
+    {
+        .f = NULL,
+        .n = NULL,
+    }
+};
@@ -0,0 +1,136 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+#include "test.h"
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/typed_array.h"
+#include <CUnit/CUnit.h>
+#include <string.h>
+
+static void test_typed_array_encode(void)
+{
+    static const uint16_t samples[] = { 0x0102, 0x0304, 0xfffe };
+    uint8_t buf[16];
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    CU_ASSERT_EQUAL(nanocbor_put_typed_array(&enc, NANOCBOR_TAG_TYPED_UINT16,
+                                             samples, 3), NANOCBOR_OK);
+    /* Tag 69 or 65, followed by a 6 byte bstr */
+    CU_ASSERT_EQUAL(nanocbor_encoded_len(&enc), 2 + 1 + sizeof(samples));
+    CU_ASSERT_EQUAL(buf[0], 0xd8);
+    CU_ASSERT_EQUAL(buf[1], NANOCBOR_TAG_TYPED_UINT16);
+    CU_ASSERT_EQUAL(buf[2], 0x46);
+    CU_ASSERT_EQUAL(memcmp(buf + 3, samples, sizeof(samples)), 0);
+
+    CU_ASSERT_EQUAL(nanocbor_put_typed_array(&enc, 76, samples, 3),
+                    NANOCBOR_ERR_INVALID_TYPE);
+    CU_ASSERT_EQUAL(nanocbor_put_typed_array(&enc, 88, samples, 3),
+                    NANOCBOR_ERR_INVALID_TYPE);
+}
+
+static void test_typed_array_decode(void)
+{
+    /* 65([0x0102, 0x0304]), 85([1.0f]), 64(h'0102') */
+    static const uint8_t input[] = {
+        0xd8, 0x41, 0x44, 0x01, 0x02, 0x03, 0x04,
+        0xd8, 0x55, 0x44, 0x00, 0x00, 0x80, 0x3f,
+        0xd8, 0x40, 0x42, 0x01, 0x02,
+    };
+    /* uint32 array with a length that isn't a multiple of 4 */
+    static const uint8_t invalid[] = { 0xd8, 0x42, 0x43, 0x01, 0x02, 0x03 };
+    nanocbor_typed_array_t arr;
+    nanocbor_value_t val;
+    uint16_t u16[2];
+    float f32[1];
+
+    nanocbor_decoder_init(&val, input, sizeof(input));
+    CU_ASSERT_EQUAL(nanocbor_get_typed_array(&val, &arr), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(arr.tag, NANOCBOR_TAG_TYPED_UINT16_BE);
+    CU_ASSERT_EQUAL(arr.type, NANOCBOR_TAG_TYPED_UINT16);
+    CU_ASSERT_EQUAL(arr.num, 2);
+    CU_ASSERT_EQUAL(arr.size, 2);
+    CU_ASSERT_EQUAL(arr.buf, input + 3);
+    CU_ASSERT_EQUAL(nanocbor_typed_array_copy(&arr, u16, 2), 2);
+    CU_ASSERT_EQUAL(u16[0], 0x0102);
+    CU_ASSERT_EQUAL(u16[1], 0x0304);
+    /* Only as many elements as fit */
+    u16[1] = 0;
+    CU_ASSERT_EQUAL(nanocbor_typed_array_copy(&arr, u16, 1), 1);
+    CU_ASSERT_EQUAL(u16[1], 0);
+
+    CU_ASSERT_EQUAL(nanocbor_get_typed_array(&val, &arr), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(arr.tag, NANOCBOR_TAG_TYPED_FLOAT32_LE);
+    CU_ASSERT_EQUAL(arr.num, 1);
+    CU_ASSERT_EQUAL(nanocbor_typed_array_copy(&arr, f32, 1), 1);
+    CU_ASSERT_EQUAL(f32[0], 1.0f);
+
+    CU_ASSERT_EQUAL(nanocbor_get_typed_array(&val, &arr), NANOCBOR_OK);
+    CU_ASSERT_EQUAL(arr.type, NANOCBOR_TAG_TYPED_UINT8);
+    /* Single byte elements are always accessible in place */
+    CU_ASSERT_EQUAL(nanocbor_typed_array_view(&arr), input + 17);
+    CU_ASSERT(nanocbor_at_end(&val));
+
+    nanocbor_decoder_init(&val, invalid, sizeof(invalid));
+    CU_ASSERT_EQUAL(nanocbor_get_typed_array(&val, &arr),
+                    NANOCBOR_ERR_INVALID_TYPE);
+    CU_ASSERT_EQUAL(val.cur, invalid);
+
+    /* Not a typed array tag */
+    static const uint8_t other[] = { 0xc1, 0x41, 0x00 };
+    nanocbor_decoder_init(&val, other, sizeof(other));
+    CU_ASSERT_EQUAL(nanocbor_get_typed_array(&val, &arr),
+                    NANOCBOR_ERR_INVALID_TYPE);
+}
+
+static void test_typed_array_view(void)
+{
+    /* Round trip in the host byte order is zero-copy when aligned */
+    static const uint32_t samples[] = { 1, 2, 0xdeadbeef, UINT32_MAX };
+    union {
+        uint32_t align;
+        uint8_t buf[32];
+    } storage;
+    nanocbor_encoder_t enc;
+    nanocbor_typed_array_t arr;
+    nanocbor_value_t val;
+
+    /* Place the elements at a 4 byte aligned offset, tag and header take 3
+     * bytes */
+    nanocbor_encoder_init(&enc, storage.buf + 1, sizeof(storage.buf) - 1);
+    CU_ASSERT_EQUAL(nanocbor_put_typed_array(&enc, NANOCBOR_TAG_TYPED_UINT32,
+                                             samples, 4), NANOCBOR_OK);
+
+    nanocbor_decoder_init(&val, storage.buf + 1, nanocbor_encoded_len(&enc));
+    CU_ASSERT_EQUAL(nanocbor_get_typed_array(&val, &arr), NANOCBOR_OK);
+    const uint32_t *view = nanocbor_typed_array_view(&arr);
+    CU_ASSERT_PTR_EQUAL(view, storage.buf + 4);
+    CU_ASSERT_EQUAL(memcmp(view, samples, sizeof(samples)), 0);
+
+    /* Misaligned elements require a copy */
+    nanocbor_encoder_init(&enc, storage.buf, sizeof(storage.buf));
+    nanocbor_put_typed_array(&enc, NANOCBOR_TAG_TYPED_UINT32, samples, 4);
+    nanocbor_decoder_init(&val, storage.buf, nanocbor_encoded_len(&enc));
+    CU_ASSERT_EQUAL(nanocbor_get_typed_array(&val, &arr), NANOCBOR_OK);
+    CU_ASSERT_PTR_NULL(nanocbor_typed_array_view(&arr));
+}
+
+const test_t tests_typed_array[] = {
+    {
+        .f = test_typed_array_encode,
+        .n = "Typed array encode test",
+    },
+    {
+        .f = test_typed_array_decode,
+        .n = "Typed array decode test",
+    },
+    {
+        .f = test_typed_array_view,
+        .n = "Typed array zero-copy view test",
+    },
+    {
+        .f = NULL,
+        .n = NULL,
+    }
+};
@@ -0,0 +1,534 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * Micro-benchmarks for the decoder and encoder hot paths.
+ *
+ * Every workload is repeated until it ran for at least BENCH_MIN_NS, the
+ * result is reported as time per CBOR item and as throughput over the CBOR
+ * bytes processed.
+ *
+ * Files passed as arguments are inputs of the worst case corpus, they are
+ * skipped and searched for an absent map key. For these an item is an input
+ * byte.
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "nanocbor/nanocbor.h"
+
+#define BENCH_MIN_NS        (200U * 1000U * 1000U)
+#define NS_PER_SEC          (1000U * 1000U * 1000U)
+
+#define SENML_RECORDS       (4096U)
+#define INT_ARRAY_LEN       (4096U)
+#define NESTED_DEPTH        (8U)
+#define NESTED_COUNT        (512U)
+#define BSTR_COUNT          (8U)
+#define BSTR_LEN            (16U * 1024U)
+#define TEXT_LEN            (16U * 1024U)
+#define CORPUS_MAX          (64U * 1024U)
+
+typedef struct {
+    const char *name;       /* Name of the workload */
+    void (*prepare)(void);  /* Prepare the input once, may be NULL */
+    size_t (*run)(size_t *bytes); /* Run once, returns the number of items */
+} bench_t;
+
+static uint8_t senml[SENML_RECORDS * 24U];
+static size_t senml_len;
+
+static uint8_t ints[INT_ARRAY_LEN * 5U + 8U];
+static size_t ints_len;
+static int32_t int_values[INT_ARRAY_LEN];
+
+static uint8_t nested[NESTED_COUNT * NESTED_DEPTH * 8U + 8U];
+static size_t nested_len;
+
+static uint8_t payload[BSTR_LEN];
+static uint8_t bstrs[BSTR_COUNT * (BSTR_LEN + 8U) + 8U];
+static size_t bstrs_len;
+
+static uint8_t text[TEXT_LEN];
+
+static uint8_t encode_buf[SENML_RECORDS * 24U];
+
+static uint8_t corpus[CORPUS_MAX];
+static size_t corpus_len;
+
+/* Results are accumulated here to keep the compiler from optimizing the
+ * decode away */
+static volatile uint64_t sink;
+
+static uint64_t _now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+/* SenML pack with a base name and base time in the first record */
+static void _encode_senml(nanocbor_encoder_t *enc)
+{
+    nanocbor_fmt_array(enc, SENML_RECORDS);
+    for (unsigned i = 0; i < SENML_RECORDS; i++) {
+        nanocbor_fmt_map(enc, i == 0 ? 4 : 3);
+        if (i == 0) {
+            nanocbor_fmt_int(enc, -2);
+            nanocbor_put_tstr(enc, "urn:dev:ow:10e2073a01080063:");
+            nanocbor_fmt_int(enc, -3);
+            nanocbor_fmt_uint(enc, 1700000000U);
+        }
+        nanocbor_fmt_int(enc, 0);
+        nanocbor_put_tstr(enc, (i % 2) ? "temp" : "humidity");
+        nanocbor_fmt_int(enc, 2);
+        nanocbor_fmt_float(enc, 20.0f + (float)(i % 16) * 0.125f);
+        if (i > 0) {
+            nanocbor_fmt_int(enc, 6);
+            nanocbor_fmt_int(enc, (int64_t)i * 60);
+        }
+    }
+}
+
+static void _prepare_senml(void)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, senml, sizeof(senml));
+    _encode_senml(&enc);
+    senml_len = nanocbor_encoded_len(&enc);
+}
+
+static size_t _bench_senml_decode(size_t *bytes)
+{
+    nanocbor_value_t val;
+    nanocbor_value_t arr;
+    uint64_t acc = 0;
+
+    nanocbor_decoder_init(&val, senml, senml_len);
+    nanocbor_enter_array(&val, &arr);
+    while (!nanocbor_at_end(&arr)) {
+        nanocbor_value_t map;
+        if (nanocbor_enter_map(&arr, &map) < 0) {
+            break;
+        }
+        while (!nanocbor_at_end(&map)) {
+            int32_t key = 0;
+            const uint8_t *str = NULL;
+            size_t len = 0;
+            int64_t num = 0;
+            float value = 0;
+
+            nanocbor_get_int32(&map, &key);
+            switch (key) {
+                case -2:
+                case 0:
+                    nanocbor_get_tstr(&map, &str, &len);
+                    acc += len;
+                    break;
+                case -3:
+                case 6:
+                    nanocbor_get_int64(&map, &num);
+                    acc += (uint64_t)num;
+                    break;
+                case 2:
+                    nanocbor_get_float(&map, &value);
+                    acc += (uint64_t)value;
+                    break;
+                default:
+                    nanocbor_skip(&map);
+            }
+        }
+        nanocbor_leave_container(&arr, &map);
+    }
+    sink += acc;
+    *bytes = senml_len;
+    return SENML_RECORDS;
+}
+
+static size_t _bench_senml_skip(size_t *bytes)
+{
+    nanocbor_value_t val;
+
+    nanocbor_decoder_init(&val, senml, senml_len);
+    sink += (uint64_t)nanocbor_skip(&val);
+    *bytes = senml_len;
+    return SENML_RECORDS;
+}
+
+static size_t _bench_senml_encode_two_pass(size_t *bytes)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, NULL, 0);
+    _encode_senml(&enc);
+    size_t len = nanocbor_encoded_len(&enc);
+
+    nanocbor_encoder_init(&enc, encode_buf, len);
+    _encode_senml(&enc);
+    sink += encode_buf[len - 1];
+    *bytes = len;
+    return SENML_RECORDS;
+}
+
+static size_t _bench_senml_encode(size_t *bytes)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, encode_buf, sizeof(encode_buf));
+    _encode_senml(&enc);
+    size_t len = nanocbor_encoded_len(&enc);
+
+    sink += encode_buf[len - 1];
+    *bytes = len;
+    return SENML_RECORDS;
+}
+
+static int32_t _int_value(unsigned i)
+{
+    return (int32_t)((i * 7919U) % 140000U) - 70000;
+}
+
+static void _prepare_ints(void)
+{
+    nanocbor_encoder_t enc;
+
+    for (unsigned i = 0; i < INT_ARRAY_LEN; i++) {
+        int_values[i] = _int_value(i);
+    }
+    nanocbor_encoder_init(&enc, ints, sizeof(ints));
+    nanocbor_fmt_array(&enc, INT_ARRAY_LEN);
+    for (unsigned i = 0; i < INT_ARRAY_LEN; i++) {
+        nanocbor_fmt_int(&enc, _int_value(i));
+    }
+    ints_len = nanocbor_encoded_len(&enc);
+}
+
+static size_t _bench_int_decode(size_t *bytes)
+{
+    nanocbor_value_t val;
+    nanocbor_value_t arr;
+    int64_t acc = 0;
+
+    nanocbor_decoder_init(&val, ints, ints_len);
+    nanocbor_enter_array(&val, &arr);
+    while (!nanocbor_at_end(&arr)) {
+        int32_t tmp = 0;
+        if (nanocbor_get_int32(&arr, &tmp) < 0) {
+            break;
+        }
+        acc += tmp;
+    }
+    sink += (uint64_t)acc;
+    *bytes = ints_len;
+    return INT_ARRAY_LEN;
+}
+
+static size_t _bench_int_decode_batch(size_t *bytes)
+{
+    static int32_t out[INT_ARRAY_LEN];
+    nanocbor_value_t val;
+    size_t count = 0;
+
+    nanocbor_decoder_init(&val, ints, ints_len);
+    nanocbor_get_int32_array(&val, out, INT_ARRAY_LEN, &count);
+    sink += (uint64_t)out[count / 2];
+    *bytes = ints_len;
+    return INT_ARRAY_LEN;
+}
+
+static size_t _bench_int_encode(size_t *bytes)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, encode_buf, sizeof(encode_buf));
+    nanocbor_fmt_array(&enc, INT_ARRAY_LEN);
+    for (unsigned i = 0; i < INT_ARRAY_LEN; i++) {
+        nanocbor_fmt_int(&enc, _int_value(i));
+    }
+    sink += encode_buf[0];
+    *bytes = nanocbor_encoded_len(&enc);
+    return INT_ARRAY_LEN;
+}
+
+static size_t _bench_int_encode_batch(size_t *bytes)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, encode_buf, sizeof(encode_buf));
+    nanocbor_fmt_int_array(&enc, int_values, INT_ARRAY_LEN);
+    sink += encode_buf[0];
+    *bytes = nanocbor_encoded_len(&enc);
+    return INT_ARRAY_LEN;
+}
+
+static size_t _bench_int_skip(size_t *bytes)
+{
+    nanocbor_value_t val;
+
+    nanocbor_decoder_init(&val, ints, ints_len);
+    sink += (uint64_t)nanocbor_skip(&val);
+    *bytes = ints_len;
+    return INT_ARRAY_LEN;
+}
+
+/* Array of maps nested NESTED_DEPTH deep: {1: 2, 3: {1: 2, 3: {...}}} */
+static void _prepare_nested(void)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, nested, sizeof(nested));
+    nanocbor_fmt_array(&enc, NESTED_COUNT);
+    for (unsigned i = 0; i < NESTED_COUNT; i++) {
+        for (unsigned depth = 0; depth < NESTED_DEPTH; depth++) {
+            nanocbor_fmt_map(&enc, depth == NESTED_DEPTH - 1 ? 1 : 2);
+            nanocbor_fmt_uint(&enc, 1);
+            nanocbor_fmt_uint(&enc, depth);
+            if (depth != NESTED_DEPTH - 1) {
+                nanocbor_fmt_uint(&enc, 3);
+            }
+        }
+    }
+    nested_len = nanocbor_encoded_len(&enc);
+}
+
+static size_t _bench_nested_skip(size_t *bytes)
+{
+    nanocbor_value_t val;
+
+    nanocbor_decoder_init(&val, nested, nested_len);
+    sink += (uint64_t)nanocbor_skip(&val);
+    *bytes = nested_len;
+    return NESTED_COUNT * NESTED_DEPTH;
+}
+
+static size_t _bench_nested_decode(size_t *bytes)
+{
+    nanocbor_value_t val;
+    nanocbor_value_t arr;
+    uint64_t acc = 0;
+
+    nanocbor_decoder_init(&val, nested, nested_len);
+    nanocbor_enter_array(&val, &arr);
+    while (!nanocbor_at_end(&arr)) {
+        nanocbor_value_t maps[NESTED_DEPTH + 1];
+        maps[0] = arr;
+        unsigned depth = 0;
+        /* Walk down to the innermost map */
+        while (depth < NESTED_DEPTH &&
+               nanocbor_enter_map(&maps[depth], &maps[depth + 1]) == NANOCBOR_OK) {
+            uint32_t key = 0;
+            uint32_t value = 0;
+            depth++;
+            nanocbor_get_uint32(&maps[depth], &key);
+            nanocbor_get_uint32(&maps[depth], &value);
+            acc += value;
+            if (!nanocbor_at_end(&maps[depth])) {
+                nanocbor_get_uint32(&maps[depth], &key);
+            }
+        }
+        /* And back up again */
+        while (depth > 0) {
+            nanocbor_leave_container(&maps[depth - 1], &maps[depth]);
+            depth--;
+        }
+        if (maps[0].cur == arr.cur) {
+            break;
+        }
+        arr = maps[0];
+    }
+    sink += acc;
+    *bytes = nested_len;
+    return NESTED_COUNT * NESTED_DEPTH;
+}
+
+static void _prepare_bstrs(void)
+{
+    nanocbor_encoder_t enc;
+
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)i;
+    }
+    nanocbor_encoder_init(&enc, bstrs, sizeof(bstrs));
+    nanocbor_fmt_array(&enc, BSTR_COUNT);
+    for (unsigned i = 0; i < BSTR_COUNT; i++) {
+        nanocbor_put_bstr(&enc, payload, sizeof(payload));
+    }
+    bstrs_len = nanocbor_encoded_len(&enc);
+}
+
+static size_t _bench_bstr_decode(size_t *bytes)
+{
+    nanocbor_value_t val;
+    nanocbor_value_t arr;
+    uint64_t acc = 0;
+
+    nanocbor_decoder_init(&val, bstrs, bstrs_len);
+    nanocbor_enter_array(&val, &arr);
+    while (!nanocbor_at_end(&arr)) {
+        const uint8_t *buf = NULL;
+        size_t len = 0;
+        if (nanocbor_get_bstr(&arr, &buf, &len) < 0) {
+            break;
+        }
+        acc += buf[len - 1];
+    }
+    sink += acc;
+    *bytes = bstrs_len;
+    return BSTR_COUNT;
+}
+
+static size_t _bench_bstr_encode(size_t *bytes)
+{
+    static uint8_t buf[sizeof(bstrs)];
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, buf, sizeof(buf));
+    nanocbor_fmt_array(&enc, BSTR_COUNT);
+    for (unsigned i = 0; i < BSTR_COUNT; i++) {
+        nanocbor_put_bstr(&enc, payload, sizeof(payload));
+    }
+    sink += buf[nanocbor_encoded_len(&enc) - 1];
+    *bytes = nanocbor_encoded_len(&enc);
+    return BSTR_COUNT;
+}
+
+/* Mostly ASCII text with a two byte sequence every 64 bytes */
+static void _prepare_text(void)
+{
+    for (size_t i = 0; i < sizeof(text); i++) {
+        text[i] = (uint8_t)('a' + i % 26U);
+    }
+    for (size_t i = 0; i + 1 < sizeof(text); i += 64U) {
+        text[i] = 0xc3;
+        text[i + 1] = 0xa9;
+    }
+}
+
+static size_t _bench_utf8_validate(size_t *bytes)
+{
+    sink += nanocbor_utf8_valid(text, sizeof(text));
+    *bytes = sizeof(text);
+    return 1;
+}
+
+static size_t _bench_corpus_skip(size_t *bytes)
+{
+    nanocbor_value_t val;
+
+    nanocbor_decoder_init(&val, corpus, corpus_len);
+    while (!nanocbor_at_end(&val) && nanocbor_skip(&val) == NANOCBOR_OK) {}
+    sink += (uint64_t)(val.end - val.cur);
+    *bytes = corpus_len;
+    return corpus_len ? corpus_len : 1;
+}
+
+static size_t _bench_corpus_key(size_t *bytes)
+{
+    nanocbor_value_t val;
+    nanocbor_value_t map;
+    nanocbor_value_t value;
+
+    nanocbor_decoder_init(&val, corpus, corpus_len);
+    if (nanocbor_enter_map(&val, &map) == NANOCBOR_OK) {
+        sink += (uint64_t)nanocbor_get_key_tstr(&map, "absent", &value);
+    }
+    *bytes = corpus_len;
+    return corpus_len ? corpus_len : 1;
+}
+
+static int _load_corpus(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+    corpus_len = fread(corpus, 1, sizeof(corpus), f);
+    fclose(f);
+    return 0;
+}
+
+static const bench_t benchmarks[] = {
+    { "senml decode", _prepare_senml, _bench_senml_decode },
+    { "senml skip", NULL, _bench_senml_skip },
+    { "senml encode", NULL, _bench_senml_encode },
+    { "senml encode two-pass", NULL, _bench_senml_encode_two_pass },
+    { "int array decode", _prepare_ints, _bench_int_decode },
+    { "int array decode batch", NULL, _bench_int_decode_batch },
+    { "int array encode", NULL, _bench_int_encode },
+    { "int array encode batch", NULL, _bench_int_encode_batch },
+    { "int array skip", NULL, _bench_int_skip },
+    { "nested map decode", _prepare_nested, _bench_nested_decode },
+    { "nested map skip", NULL, _bench_nested_skip },
+    { "bstr decode", _prepare_bstrs, _bench_bstr_decode },
+    { "bstr encode", NULL, _bench_bstr_encode },
+    { "utf8 validate", _prepare_text, _bench_utf8_validate },
+};
+
+static void _run(const bench_t *bench)
+{
+    size_t items = 0;
+    size_t bytes = 0;
+    uint64_t runs = 0;
+    uint64_t elapsed = 0;
+
+    if (bench->prepare) {
+        bench->prepare();
+    }
+    uint64_t start = _now_ns();
+    do {
+        items += bench->run(&bytes);
+        runs++;
+        elapsed = _now_ns() - start;
+    } while (elapsed < BENCH_MIN_NS);
+
+    double ns_per_item = (double)elapsed / (double)items;
+    double mb_per_sec = ((double)bytes * (double)runs * 1e3) / (double)elapsed;
+
+    printf("%-24s %10llu %12.2f %12.2f\n", bench->name,
+           (unsigned long long)runs, ns_per_item, mb_per_sec);
+}
+
+int main(int argc, char **argv)
+{
+    printf("%-24s %10s %12s %12s\n", "workload", "runs", "ns/item", "MB/s");
+    for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
+        _run(&benchmarks[i]);
+    }
+    for (int i = 1; i < argc; i++) {
+        const char *base = strrchr(argv[i], '/');
+        char name[2][32];
+
+        if (_load_corpus(argv[i]) < 0) {
+            return 1;
+        }
+        base = base ? base + 1 : argv[i];
+        int base_len = (int)strcspn(base, ".");
+        if (base_len > 19) {
+            base_len = 19;
+        }
+        snprintf(name[0], sizeof(name[0]), "%.*s skip", base_len, base);
+        snprintf(name[1], sizeof(name[1]), "%.*s key", base_len, base);
+        const bench_t corpus_benchmarks[] = {
+            { name[0], NULL, _bench_corpus_skip },
+            { name[1], NULL, _bench_corpus_key },
+        };
+        _run(&corpus_benchmarks[0]);
+        /* Key lookups only apply to maps */
+        nanocbor_value_t val;
+        nanocbor_decoder_init(&val, corpus, corpus_len);
+        if (nanocbor_get_type(&val) == NANOCBOR_TYPE_MAP) {
+            _run(&corpus_benchmarks[1]);
+        }
+    }
+    return 0;
+}
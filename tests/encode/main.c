@@ -5,6 +5,7 @@
 #include <stdio.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
@@ -31,25 +32,44 @@ static void _encode(nanocbor_encoder_t *enc)
     nanocbor_fmt_end_indefinite(enc);
 }
 
+typedef struct {
+    uint8_t *buf;
+    size_t size;
+} _buffer_t;
+
+static int _grow(nanocbor_encoder_t *enc, void *ctx, size_t len)
+{
+    _buffer_t *buffer = ctx;
+    size_t used = buffer->buf ? (size_t)(enc->cur - buffer->buf) : 0;
+    size_t size = buffer->size * 2 + len;
+
+    uint8_t *buf = realloc(buffer->buf, size);
+    if (!buf) {
+        return -1;
+    }
+    buffer->buf = buf;
+    buffer->size = size;
+    enc->cur = buf + used;
+    enc->end = buf + size;
+    return 0;
+}
+
 int main(void)
 {
     nanocbor_encoder_t enc;
-    nanocbor_encoder_init(&enc, NULL, 0);
+    _buffer_t buffer = { NULL, 0 };
 
+    /* Single pass, the buffer grows on demand */
+    nanocbor_encoder_sink_init(&enc, NULL, 0, _grow, &buffer);
     _encode(&enc);
 
-    size_t required = nanocbor_encoded_len(&enc);
-
-    uint8_t *buf = malloc(required);
-    if (!buf) {
+    if (!buffer.buf) {
         return -1;
     }
 
-    nanocbor_encoder_init(&enc, buf, required);
-    _encode(&enc);
-
     //printf("Bytes: %u\n", (unsigned)nanocbor_encoded_len(&enc));
-    fwrite(buf, 1, nanocbor_encoded_len(&enc), stdout);
+    fwrite(buffer.buf, 1, nanocbor_encoded_len(&enc), stdout);
+    free(buffer.buf);
 
     return 0;
 }
@@ -104,12 +104,22 @@ static int _parse_type(nanocbor_value_t *value, unsigned indent)
             {
                 const uint8_t *buf;
                 size_t len;
-                if (nanocbor_get_tstr(value, &buf, &len) >= 0) {
-                    printf("\"%.*s\"", (int)len, buf);
+                nanocbor_value_t chunks;
+                if (nanocbor_enter_tstr(value, &chunks) < 0) {
+                    return -1;
                 }
-                else {
+                printf("\"");
+                while (!nanocbor_at_end(&chunks)) {
+                    if (nanocbor_get_tstr(&chunks, &buf, &len) < 0) {
+                        return -1;
+                    }
+                    printf("%.*s", (int)len, buf);
+                }
+                printf("\"");
+                if (nanocbor_needs_input(&chunks)) {
                     return -1;
                 }
+                nanocbor_leave_container(value, &chunks);
             }
             break;
         case NANOCBOR_TYPE_ARR:
@@ -145,12 +155,16 @@ static int _parse_type(nanocbor_value_t *value, unsigned indent)
         case NANOCBOR_TYPE_FLOAT:
             {
                 bool test;
+                double num;
                 if (nanocbor_get_bool(value, &test) >= NANOCBOR_OK) {
                     test ? printf("True") : printf("False");
                 }
                 else if (nanocbor_get_null(value) >= NANOCBOR_OK) {
                     printf("NULL");
                 }
+                else if (nanocbor_get_double(value, &num) >= 0) {
+                    printf("%f", num);
+                }
                 else if (nanocbor_skip_simple(value) >= 0) {
                     printf("Unsupported float");
                 }
@@ -0,0 +1,697 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * Performance fuzzing harness.
+ *
+ * Runs every decoder operation that walks a whole document over an input
+ * and counts the work done with the decoder statistics: items decoded,
+ * items skipped and map keys compared. Work must be linear in the input
+ * length, an operation doing more than PERF_ITEMS_PER_BYTE items per input
+ * byte is reported as a blowup. Work outside of the decoder core, for
+ * example the header walk of the canonical check, isn't counted; when
+ * checking files the time per byte is therefore also compared against
+ * skipping a plain integer array.
+ *
+ * Without arguments a single input is read from stdin and a blowup aborts,
+ * so afl-fuzz reports the input as a crash. With files as arguments every
+ * file is checked and the time per input byte is reported, `-o dir` copies
+ * the inputs with a blowup to a directory. `-g dir` writes the built-in worst
+ * case inputs to a directory.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "nanocbor/nanocbor.h"
+#include "nanocbor/canonical.h"
+#include "nanocbor/dom.h"
+#include "nanocbor/map_index.h"
+#include "nanocbor/query.h"
+#include "nanocbor/schema.h"
+#include "nanocbor/sequence.h"
+#include "nanocbor/stats.h"
+#include "nanocbor/tape.h"
+
+#if !NANOCBOR_STATS
+#error "The performance harness requires NANOCBOR_STATS=1"
+#endif
+
+#define PERF_ITEMS_PER_BYTE (4U)
+#define PERF_INPUT_MAX      (64U * 1024U)
+#define PERF_NODES          (PERF_INPUT_MAX)
+#define PERF_MIN_NS         (2U * 1000U * 1000U)
+#define PERF_SLOWDOWN_MAX   (128U)  /* Time per byte relative to the
+                                     * baseline */
+#define PERF_TIMED_LEN_MIN  (1024U) /* Shorter inputs are dominated by the
+                                     * setup of an operation */
+#define PERF_BASELINE_ITEMS (4096U)
+#define PERF_QUERY_NODES    (32U)
+#define NS_PER_SEC          (1000U * 1000U * 1000U)
+
+typedef struct {
+    const char *name;
+    void (*run)(const uint8_t *buf, size_t len);
+} perf_op_t;
+
+typedef struct {
+    const char *name;
+    size_t (*generate)(uint8_t *buf, size_t len);
+} perf_input_t;
+
+static uint8_t input[PERF_INPUT_MAX];
+static nanocbor_tape_entry_t tape_entries[PERF_NODES];
+static nanocbor_dom_node_t dom_nodes[PERF_NODES];
+static nanocbor_map_index_entry_t index_entries[PERF_NODES];
+static nanocbor_query_node_t query_nodes[PERF_QUERY_NODES];
+static nanocbor_query_t query;
+static nanocbor_value_t query_results[PERF_QUERY_NODES];
+
+/* Paths descending through arrays and maps, absent keys and deep paths.
+ * Tags in front of every step are passed over. */
+static const char *const query_paths[] = {
+    "/0/0/0/0/0/0/0/0/0",
+    "/1",
+    "/-1/0",
+    "/\"a\"/1",
+    "/0/\"absent\"",
+};
+
+/* Record referring to itself, any map nests as deep as the input does */
+typedef struct {
+    uint64_t id;
+    nanocbor_schema_str_t name;
+    nanocbor_value_t any;
+} perf_record_t;
+
+static const nanocbor_schema_t record_schema;
+
+static const nanocbor_schema_field_t record_fields[] = {
+    { .key = 1, .type = NANOCBOR_SCHEMA_UINT,
+      NANOCBOR_SCHEMA_MEMBER(perf_record_t, id) },
+    { .name = "a", .type = NANOCBOR_SCHEMA_TSTR,
+      NANOCBOR_SCHEMA_MEMBER(perf_record_t, name) },
+    { .key = -1, .type = NANOCBOR_SCHEMA_VALUE,
+      NANOCBOR_SCHEMA_MEMBER(perf_record_t, any) },
+    { .key = 0, .type = NANOCBOR_SCHEMA_MAP, .nested = &record_schema,
+      .offset = 0, .size = sizeof(perf_record_t) },
+};
+
+static const nanocbor_schema_t record_schema = {
+    record_fields, sizeof(record_fields) / sizeof(record_fields[0])
+};
+
+/* Time per byte of skipping an integer array */
+static double baseline;
+
+/* Keeps the compiler from optimizing the operations away */
+static volatile int sink;
+
+static uint64_t _now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+static void _op_skip(const uint8_t *buf, size_t len)
+{
+    nanocbor_value_t it;
+
+    nanocbor_decoder_init(&it, buf, len);
+    while (!nanocbor_at_end(&it) && nanocbor_skip(&it) == NANOCBOR_OK) {}
+    sink += (int)(it.end - it.cur);
+}
+
+static void _op_sequence(const uint8_t *buf, size_t len)
+{
+    nanocbor_value_t it;
+    const uint8_t *item = NULL;
+    size_t item_len = 0;
+
+    nanocbor_decoder_init(&it, buf, len);
+    while (nanocbor_sequence_next(&it, &item, &item_len) == NANOCBOR_OK) {}
+    sink += (int)item_len;
+}
+
+/* Key lookups for an absent key check every key of the map */
+static void _op_key_tstr(const uint8_t *buf, size_t len)
+{
+    nanocbor_value_t it;
+    nanocbor_value_t map;
+    nanocbor_value_t value;
+
+    nanocbor_decoder_init(&it, buf, len);
+    if (nanocbor_enter_map(&it, &map) == NANOCBOR_OK) {
+        sink += nanocbor_get_key_tstr(&map, "absent", &value);
+    }
+}
+
+static void _op_key_int(const uint8_t *buf, size_t len)
+{
+    nanocbor_value_t it;
+    nanocbor_value_t map;
+    nanocbor_value_t value;
+
+    nanocbor_decoder_init(&it, buf, len);
+    if (nanocbor_enter_map(&it, &map) == NANOCBOR_OK) {
+        sink += nanocbor_get_key_int(&map, INT32_MIN, &value);
+    }
+}
+
+static void _op_map_index(const uint8_t *buf, size_t len)
+{
+    nanocbor_map_index_t index;
+    nanocbor_value_t it;
+    nanocbor_value_t map;
+
+    nanocbor_decoder_init(&it, buf, len);
+    if (nanocbor_enter_map(&it, &map) == NANOCBOR_OK) {
+        /* Every pair takes at least two bytes, the index is at most half
+         * full and initializing it doesn't dominate for small inputs */
+        nanocbor_map_index_init(&index, index_entries,
+                                len < PERF_NODES ? len : PERF_NODES);
+        sink += nanocbor_map_index_build(&index, &map);
+    }
+}
+
+static void _op_canonical(const uint8_t *buf, size_t len)
+{
+    nanocbor_value_t it;
+
+    nanocbor_decoder_init(&it, buf, len);
+    sink += nanocbor_canonical_check(&it);
+}
+
+static void _op_tape(const uint8_t *buf, size_t len)
+{
+    nanocbor_tape_t tape;
+
+    nanocbor_tape_init(&tape, tape_entries, PERF_NODES);
+    sink += nanocbor_tape_build(&tape, buf, len);
+}
+
+static void _op_dom(const uint8_t *buf, size_t len)
+{
+    nanocbor_dom_t dom;
+    nanocbor_value_t it;
+    size_t root = 0;
+
+    nanocbor_dom_init(&dom, dom_nodes, PERF_NODES);
+    nanocbor_decoder_init(&it, buf, len);
+    while (!nanocbor_at_end(&it) &&
+           nanocbor_dom_build(&dom, &it, &root) == NANOCBOR_OK) {}
+    sink += (int)root;
+}
+
+static void _op_query(const uint8_t *buf, size_t len)
+{
+    nanocbor_value_t it;
+
+    nanocbor_decoder_init(&it, buf, len);
+    sink += nanocbor_query_run(&query, &it, query_results);
+}
+
+static void _op_schema(const uint8_t *buf, size_t len)
+{
+    perf_record_t record;
+    nanocbor_value_t it;
+    uint32_t found = 0;
+
+    nanocbor_decoder_init(&it, buf, len);
+    sink += nanocbor_schema_decode(&it, &record_schema, &record, &found);
+    sink += (int)found;
+}
+
+static const perf_op_t ops[] = {
+    { "skip", _op_skip },
+    { "sequence", _op_sequence },
+    { "key tstr", _op_key_tstr },
+    { "key int", _op_key_int },
+    { "map index", _op_map_index },
+    { "canonical", _op_canonical },
+    { "tape", _op_tape },
+    { "dom", _op_dom },
+    { "query", _op_query },
+    { "schema", _op_schema },
+};
+
+#define NUM_OPS (sizeof(ops) / sizeof(ops[0]))
+
+static void _query_compile(void)
+{
+    nanocbor_query_init(&query, query_nodes, PERF_QUERY_NODES);
+    for (size_t i = 0; i < sizeof(query_paths) / sizeof(query_paths[0]); i++) {
+        if (nanocbor_query_add(&query, query_paths[i]) < 0) {
+            fprintf(stderr, "%s: can't add query path\n", query_paths[i]);
+            abort();
+        }
+    }
+}
+
+static uint64_t _work(const perf_op_t *op, const uint8_t *buf, size_t len)
+{
+    nanocbor_stats_reset();
+    op->run(buf, len);
+    return nanocbor_stats.decoded + nanocbor_stats.skipped +
+           nanocbor_stats.key_probes;
+}
+
+static bool _blowup(uint64_t work, size_t len)
+{
+    return work > (uint64_t)PERF_ITEMS_PER_BYTE * ((uint64_t)len + 1U);
+}
+
+static double _ns_per_byte(const perf_op_t *op, const uint8_t *buf,
+                           size_t len)
+{
+    uint64_t runs = 0;
+    uint64_t elapsed = 0;
+    uint64_t start = _now_ns();
+
+    do {
+        op->run(buf, len);
+        runs++;
+        elapsed = _now_ns() - start;
+    } while (elapsed < PERF_MIN_NS);
+    return (double)elapsed / ((double)runs * (double)(len ? len : 1));
+}
+
+static void _measure_baseline(void)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, input, sizeof(input));
+    nanocbor_fmt_array(&enc, PERF_BASELINE_ITEMS);
+    for (unsigned i = 0; i < PERF_BASELINE_ITEMS; i++) {
+        nanocbor_fmt_uint(&enc, i);
+    }
+    baseline = _ns_per_byte(&ops[0], input, nanocbor_encoded_len(&enc));
+}
+
+static bool _slow(double ns_per_byte, size_t len)
+{
+    return len >= PERF_TIMED_LEN_MIN &&
+           ns_per_byte > baseline * PERF_SLOWDOWN_MAX;
+}
+
+/* Worst case inputs, every generator returns the length written */
+
+/* Map declaring SIZE_MAX pairs with only a few present */
+static size_t _gen_map_huge_count(uint8_t *buf, size_t len)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, buf, len);
+    nanocbor_fmt_map(&enc, SIZE_MAX);
+    for (unsigned i = 0; i < 16; i++) {
+        nanocbor_put_tstr(&enc, "key");
+        nanocbor_fmt_array(&enc, UINT32_MAX);
+    }
+    return nanocbor_encoded_len(&enc);
+}
+
+/* Array declaring 2^32 - 1 items followed by a run of small integers */
+static size_t _gen_array_huge_count(uint8_t *buf, size_t len)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, buf, len);
+    nanocbor_fmt_array(&enc, UINT32_MAX);
+    for (unsigned i = 0; i < 4096; i++) {
+        nanocbor_fmt_uint(&enc, i % 24U);
+    }
+    return nanocbor_encoded_len(&enc);
+}
+
+/* Byte string header declaring more bytes than present */
+static size_t _gen_bstr_huge_len(uint8_t *buf, size_t len)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, buf, len);
+    nanocbor_fmt_array(&enc, 2);
+    nanocbor_fmt_uint(&enc, 0);
+    nanocbor_fmt_bstr(&enc, SIZE_MAX);
+    return nanocbor_encoded_len(&enc);
+}
+
+/* Arrays nested up to the recursion limit, repeated */
+static size_t _gen_nested_limit(uint8_t *buf, size_t len)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, buf, len);
+    nanocbor_fmt_array(&enc, 1024);
+    for (unsigned i = 0; i < 1024; i++) {
+        for (unsigned depth = 1; depth < NANOCBOR_RECURSION_MAX; depth++) {
+            nanocbor_fmt_array(&enc, 1);
+        }
+        nanocbor_fmt_uint(&enc, i % 24U);
+    }
+    return nanocbor_encoded_len(&enc);
+}
+
+/* Maps nested far beyond the recursion limit */
+static size_t _gen_nested_deep(uint8_t *buf, size_t len)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, buf, len);
+    for (unsigned i = 0; i < 4096; i++) {
+        nanocbor_fmt_map(&enc, 1);
+        nanocbor_fmt_uint(&enc, 0);
+    }
+    nanocbor_fmt_null(&enc);
+    return nanocbor_encoded_len(&enc);
+}
+
+/* Indefinite length arrays nested to the limit, never closed */
+static size_t _gen_indefinite_open(uint8_t *buf, size_t len)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, buf, len);
+    for (unsigned depth = 0; depth < NANOCBOR_RECURSION_MAX; depth++) {
+        nanocbor_fmt_array_indefinite(&enc);
+    }
+    for (unsigned i = 0; i < 4096; i++) {
+        nanocbor_fmt_bool(&enc, i & 1U);
+    }
+    return nanocbor_encoded_len(&enc);
+}
+
+/* Indefinite length arrays nested below the limit, closed around
+ * thousands of items in the innermost one */
+static size_t _gen_indefinite_wide(uint8_t *buf, size_t len)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, buf, len);
+    for (unsigned depth = 0; depth < NANOCBOR_RECURSION_MAX - 1; depth++) {
+        nanocbor_fmt_array_indefinite(&enc);
+    }
+    for (unsigned i = 0; i < 4000; i++) {
+        nanocbor_fmt_uint(&enc, 0);
+    }
+    for (unsigned depth = 0; depth < NANOCBOR_RECURSION_MAX - 1; depth++) {
+        nanocbor_fmt_end_indefinite(&enc);
+    }
+    return nanocbor_encoded_len(&enc);
+}
+
+/* Indefinite length byte string with thousands of empty chunks */
+static size_t _gen_empty_chunks(uint8_t *buf, size_t len)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, buf, len);
+    nanocbor_fmt_bstr_indefinite(&enc);
+    for (unsigned i = 0; i < 8192; i++) {
+        nanocbor_fmt_bstr(&enc, 0);
+    }
+    nanocbor_fmt_end_indefinite(&enc);
+    return nanocbor_encoded_len(&enc);
+}
+
+/* Long chain of tags around a single integer */
+static size_t _gen_tag_chain(uint8_t *buf, size_t len)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, buf, len);
+    for (unsigned i = 0; i < 8192; i++) {
+        nanocbor_fmt_tag(&enc, 6);
+    }
+    nanocbor_fmt_uint(&enc, 0);
+    return nanocbor_encoded_len(&enc);
+}
+
+/* Records nested beyond the limit under key 0, matching the schema and
+ * the query paths at every level */
+static size_t _gen_nested_maps(uint8_t *buf, size_t len)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, buf, len);
+    for (unsigned depth = 0; depth <= NANOCBOR_RECURSION_MAX; depth++) {
+        nanocbor_fmt_map(&enc, 4);
+        nanocbor_fmt_uint(&enc, 1);
+        nanocbor_fmt_uint(&enc, depth);
+        nanocbor_put_tstr(&enc, "a");
+        nanocbor_put_tstr(&enc, "x");
+        nanocbor_fmt_int(&enc, -1);
+        nanocbor_fmt_array(&enc, 256);
+        for (unsigned i = 0; i < 256; i++) {
+            nanocbor_fmt_map(&enc, 0);
+        }
+        nanocbor_fmt_uint(&enc, 0);
+    }
+    nanocbor_fmt_null(&enc);
+    return nanocbor_encoded_len(&enc);
+}
+
+/* Maps nested under key 0 up to the limit, every step behind a 64 bit tag
+ * and a chain of small tags, around thousands of tagged integers */
+static size_t _gen_tagged_paths(uint8_t *buf, size_t len)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, buf, len);
+    for (unsigned depth = 0; depth < NANOCBOR_RECURSION_MAX - 1; depth++) {
+        nanocbor_fmt_tag(&enc, UINT64_MAX);
+        for (unsigned i = 0; i < 64; i++) {
+            nanocbor_fmt_tag(&enc, i);
+        }
+        nanocbor_fmt_map(&enc, 2);
+        nanocbor_fmt_int(&enc, -1);
+        nanocbor_fmt_tag(&enc, 1);
+        nanocbor_fmt_uint(&enc, depth);
+        nanocbor_fmt_uint(&enc, 0);
+    }
+    nanocbor_fmt_array(&enc, 4096);
+    for (unsigned i = 0; i < 4096; i++) {
+        nanocbor_fmt_tag(&enc, 1);
+        nanocbor_fmt_uint(&enc, 0);
+    }
+    return nanocbor_encoded_len(&enc);
+}
+
+/* Map with many integer keys and empty container values */
+static size_t _gen_many_int_keys(uint8_t *buf, size_t len)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, buf, len);
+    nanocbor_fmt_map(&enc, 4096);
+    for (unsigned i = 0; i < 4096; i++) {
+        nanocbor_fmt_uint(&enc, i);
+        nanocbor_fmt_array(&enc, 0);
+    }
+    return nanocbor_encoded_len(&enc);
+}
+
+/* Map with many text string keys sharing a long prefix */
+static size_t _gen_many_tstr_keys(uint8_t *buf, size_t len)
+{
+    nanocbor_encoder_t enc;
+    char key[] = "absen00";
+
+    nanocbor_encoder_init(&enc, buf, len);
+    nanocbor_fmt_map(&enc, 1024);
+    for (unsigned i = 0; i < 1024; i++) {
+        key[5] = (char)('a' + i / 26U % 26U);
+        key[6] = (char)('a' + i % 26U);
+        nanocbor_put_tstr(&enc, key);
+        nanocbor_fmt_uint(&enc, i % 24U);
+    }
+    return nanocbor_encoded_len(&enc);
+}
+
+/* Map of a huge declared size with truncated nested containers as values */
+static size_t _gen_truncated_values(uint8_t *buf, size_t len)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, buf, len);
+    nanocbor_fmt_map(&enc, UINT32_MAX);
+    for (unsigned i = 0; i < 2048; i++) {
+        nanocbor_fmt_int(&enc, -1 - (int64_t)(i % 24U));
+        nanocbor_fmt_map(&enc, 1);
+    }
+    return nanocbor_encoded_len(&enc);
+}
+
+/* Sequence of empty arrays and maps */
+static size_t _gen_empty_containers(uint8_t *buf, size_t len)
+{
+    nanocbor_encoder_t enc;
+
+    nanocbor_encoder_init(&enc, buf, len);
+    for (unsigned i = 0; i < 8192; i++) {
+        if (i & 1U) {
+            nanocbor_fmt_map(&enc, 0);
+        }
+        else {
+            nanocbor_fmt_array(&enc, 0);
+        }
+    }
+    return nanocbor_encoded_len(&enc);
+}
+
+static const perf_input_t inputs[] = {
+    { "map_huge_count", _gen_map_huge_count },
+    { "array_huge_count", _gen_array_huge_count },
+    { "bstr_huge_len", _gen_bstr_huge_len },
+    { "nested_limit", _gen_nested_limit },
+    { "nested_deep", _gen_nested_deep },
+    { "indefinite_open", _gen_indefinite_open },
+    { "indefinite_wide", _gen_indefinite_wide },
+    { "empty_chunks", _gen_empty_chunks },
+    { "tag_chain", _gen_tag_chain },
+    { "nested_maps", _gen_nested_maps },
+    { "tagged_paths", _gen_tagged_paths },
+    { "many_int_keys", _gen_many_int_keys },
+    { "many_tstr_keys", _gen_many_tstr_keys },
+    { "truncated_values", _gen_truncated_values },
+    { "empty_containers", _gen_empty_containers },
+};
+
+static int _write_file(const char *dir, const char *name,
+                       const uint8_t *buf, size_t len)
+{
+    char path[512];
+
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return -1;
+    }
+    size_t written = fwrite(buf, 1, len, f);
+    if (fclose(f) != 0 || written != len) {
+        fprintf(stderr, "%s: write failed\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+static int _generate(const char *dir)
+{
+    for (size_t i = 0; i < sizeof(inputs) / sizeof(inputs[0]); i++) {
+        char name[64];
+        size_t len = inputs[i].generate(input, sizeof(input));
+
+        if (len > sizeof(input)) {
+            fprintf(stderr, "%s: larger than the input buffer\n",
+                    inputs[i].name);
+            return -1;
+        }
+        snprintf(name, sizeof(name), "%s.cbor", inputs[i].name);
+        if (_write_file(dir, name, input, len) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static size_t _read(FILE *f)
+{
+    size_t len = fread(input, 1, sizeof(input), f);
+
+    if (len == sizeof(input) && fgetc(f) != EOF) {
+        fprintf(stderr, "input larger than %u bytes, truncated\n",
+                (unsigned)sizeof(input));
+    }
+    return len;
+}
+
+/* Checks a single input from stdin, aborts on a blowup */
+static int _fuzz(void)
+{
+    size_t len = _read(stdin);
+
+    for (size_t i = 0; i < NUM_OPS; i++) {
+        if (_blowup(_work(&ops[i], input, len), len)) {
+            fprintf(stderr, "blowup in %s\n", ops[i].name);
+            abort();
+        }
+    }
+    return 0;
+}
+
+/* Checks and times a file, returns the number of operations flagged */
+static unsigned _check(const char *path, const char *out)
+{
+    FILE *f = fopen(path, "rb");
+    unsigned blowups = 0;
+
+    if (f == NULL) {
+        fprintf(stderr, "%s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    size_t len = _read(f);
+    fclose(f);
+
+    const char *name = strrchr(path, '/');
+    name = name ? name + 1 : path;
+    for (size_t i = 0; i < NUM_OPS; i++) {
+        uint64_t work = _work(&ops[i], input, len);
+        double ns = _ns_per_byte(&ops[i], input, len);
+        bool blowup = _blowup(work, len);
+        bool slow = _slow(ns, len);
+
+        printf("%-24s %-10s %8u %10.2f %10.2f%s%s\n", name, ops[i].name,
+               (unsigned)len, (double)work / (double)(len ? len : 1), ns,
+               blowup ? "  BLOWUP" : "", slow ? "  SLOW" : "");
+        blowups += blowup || slow;
+    }
+    if (blowups && out && _write_file(out, name, input, len) < 0) {
+        return blowups + 1;
+    }
+    return blowups;
+}
+
+int main(int argc, char **argv)
+{
+    const char *out = NULL;
+    unsigned blowups = 0;
+    int opt = 0;
+
+    while ((opt = getopt(argc, argv, "g:o:")) != -1) {
+        switch (opt) {
+            case 'g':
+                return _generate(optarg) < 0 ? 1 : 0;
+            case 'o':
+                out = optarg;
+                break;
+            default:
+                fprintf(stderr, "usage: %s [-g dir] [-o dir] [file...]\n",
+                        argv[0]);
+                return 1;
+        }
+    }
+    _query_compile();
+    if (optind == argc) {
+        return _fuzz();
+    }
+    _measure_baseline();
+    printf("baseline %.2f ns/B\n", baseline);
+    printf("%-24s %-10s %8s %10s %10s\n", "input", "operation", "bytes",
+           "items/B", "ns/B");
+    for (int i = optind; i < argc; i++) {
+        blowups += _check(argv[i], out);
+    }
+    return blowups ? 2 : 0;
+}
@@ -0,0 +1,1528 @@
+/*
+ * SPDX-License-Identifier: CC0-1.0
+ */
+
+/**
+ * @file
+ * @brief   Generate NanoCBOR encoders and decoders from a CDDL subset
+ *
+ * Reads a CDDL file and writes a header and a C file with a struct, an
+ * encode and a decode function for every rule. See README.md for the
+ * supported subset.
+ */
+
+#include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define NAME_LEN_MAX    (64U)   /* Identifier and string literal length */
+#define RULES_MAX       (128U)  /* Rules in a single CDDL file */
+#define ENTRIES_MAX     (32U)   /* Entries in an array or map */
+#define CONST_LEN_MAX   (256U)  /* Constant bytes in a single run */
+#define SIZE_BOUND_MAX  (UINT32_MAX) /* Larger bounds are reported as
+                                      * unbounded */
+
+typedef enum {
+    TOK_EOF,
+    TOK_IDENT,
+    TOK_INT,
+    TOK_STR,
+    TOK_PUNCT,
+    TOK_CTRL,   /* Control operator, text without the leading dot */
+} tok_kind_t;
+
+typedef struct {
+    tok_kind_t kind;
+    char text[NAME_LEN_MAX];
+    int64_t num;
+    int line;
+} token_t;
+
+typedef enum {
+    TYPE_UINT,
+    TYPE_INT,
+    TYPE_BOOL,
+    TYPE_FLOAT,
+    TYPE_DOUBLE,
+    TYPE_TSTR,
+    TYPE_BSTR,
+    TYPE_REF,
+    TYPE_ARRAY,
+    TYPE_MAP,
+    TYPE_CONST_INT,
+    TYPE_CONST_STR,
+} type_kind_t;
+
+typedef struct type type_t;
+typedef struct rule rule_t;
+
+typedef struct {
+    char name[NAME_LEN_MAX];    /* C member name */
+    char keyref[NAME_LEN_MAX];  /* Constant rule used as key */
+    char skey[NAME_LEN_MAX];    /* Text string key */
+    int64_t ikey;               /* Integer key */
+    type_t *type;
+    uint64_t min;               /* Occurrences of a repeated entry */
+    uint64_t max;
+    bool has_key;
+    bool str_key;
+    bool optional;
+    bool repeat;
+    int line;
+} entry_t;
+
+struct type {
+    type_kind_t kind;
+    char ref[NAME_LEN_MAX];     /* Referenced rule or string constant */
+    const rule_t *rule;         /* Resolved reference */
+    entry_t entries[ENTRIES_MAX];
+    size_t num;
+    int64_t lo;                 /* Integer range or integer constant */
+    int64_t hi;
+    uint64_t size;              /* Maximum string length */
+    unsigned width;             /* Integer width in bytes */
+    bool ranged;
+    bool sized;
+    int line;
+};
+
+struct rule {
+    char name[NAME_LEN_MAX];    /* CDDL name */
+    char cname[NAME_LEN_MAX];   /* C identifier without prefix */
+    type_t *type;
+    int line;
+    int state;                  /* 0: pending, 1: in progress, 2: done */
+};
+
+/* Pending constant bytes of the encoder */
+typedef struct {
+    uint8_t buf[CONST_LEN_MAX];
+    size_t len;
+    unsigned count;
+} run_t;
+
+static const char *_file;
+static const char *_prefix = "";
+static char _uprefix[NAME_LEN_MAX];
+
+static token_t *_toks;
+static size_t _num_toks;
+static size_t _pos;
+
+static rule_t _rules[RULES_MAX];
+static size_t _num_rules;
+
+static void _fail(int line, const char *fmt, ...)
+{
+    va_list args;
+
+    fprintf(stderr, "%s:%d: error: ", _file, line);
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+    fprintf(stderr, "\n");
+    exit(EXIT_FAILURE);
+}
+
+static void *_alloc(size_t size)
+{
+    void *ptr = calloc(1, size);
+
+    if (!ptr) {
+        fprintf(stderr, "out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+/* Tokenizer */
+
+static void _push(const token_t *tok)
+{
+    static size_t size;
+
+    if (_num_toks == size) {
+        size = size ? size * 2 : 256;
+        token_t *toks = realloc(_toks, size * sizeof(token_t));
+        if (!toks) {
+            fprintf(stderr, "out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+        _toks = toks;
+    }
+    _toks[_num_toks++] = *tok;
+}
+
+static bool _ident_start(char c)
+{
+    return isalpha((unsigned char)c) || c == '_' || c == '$' || c == '@';
+}
+
+static bool _ident_char(char c)
+{
+    return _ident_start(c) || isdigit((unsigned char)c);
+}
+
+static void _copy_text(token_t *tok, const char *start, size_t len)
+{
+    if (len >= NAME_LEN_MAX) {
+        _fail(tok->line, "identifier or string too long");
+    }
+    memcpy(tok->text, start, len);
+    tok->text[len] = '\0';
+}
+
+static void _tokenize(const char *p)
+{
+    int line = 1;
+
+    for (;;) {
+        token_t tok;
+        memset(&tok, 0, sizeof(tok));
+
+        while (*p) {
+            if (*p == '\n') {
+                line++;
+                p++;
+            }
+            else if (isspace((unsigned char)*p)) {
+                p++;
+            }
+            else if (*p == ';') {
+                while (*p && *p != '\n') {
+                    p++;
+                }
+            }
+            else {
+                break;
+            }
+        }
+        tok.line = line;
+
+        if (!*p) {
+            tok.kind = TOK_EOF;
+            _push(&tok);
+            return;
+        }
+        if (_ident_start(*p)) {
+            const char *start = p;
+            /* Dashes are allowed inside names */
+            while (_ident_char(*p) || (*p == '-' && _ident_char(p[1]))) {
+                p++;
+            }
+            tok.kind = TOK_IDENT;
+            _copy_text(&tok, start, (size_t)(p - start));
+        }
+        else if (isdigit((unsigned char)*p) ||
+                 (*p == '-' && isdigit((unsigned char)p[1]))) {
+            char *end = NULL;
+            errno = 0;
+            tok.kind = TOK_INT;
+            tok.num = strtoll(p, &end, 0);
+            if (errno == ERANGE) {
+                _fail(line, "integer out of range");
+            }
+            p = end;
+        }
+        else if (*p == '"') {
+            const char *start = ++p;
+            while (*p && *p != '"' && *p != '\n') {
+                p++;
+            }
+            if (*p != '"') {
+                _fail(line, "unterminated string");
+            }
+            tok.kind = TOK_STR;
+            _copy_text(&tok, start, (size_t)(p - start));
+            p++;
+        }
+        else if (*p == '.' && isalpha((unsigned char)p[1])) {
+            const char *start = ++p;
+            while (_ident_char(*p)) {
+                p++;
+            }
+            tok.kind = TOK_CTRL;
+            _copy_text(&tok, start, (size_t)(p - start));
+        }
+        else if (p[0] == '=' && p[1] == '>') {
+            tok.kind = TOK_PUNCT;
+            _copy_text(&tok, p, 2);
+            p += 2;
+        }
+        else if (p[0] == '.' && p[1] == '.') {
+            size_t len = p[2] == '.' ? 3 : 2;
+            tok.kind = TOK_PUNCT;
+            _copy_text(&tok, p, len);
+            p += len;
+        }
+        else if (strchr("=[]{}(),:?*+/", *p)) {
+            tok.kind = TOK_PUNCT;
+            _copy_text(&tok, p, 1);
+            p++;
+        }
+        else {
+            _fail(line, "unexpected character '%c'", *p);
+        }
+        _push(&tok);
+    }
+}
+
+/* Parser */
+
+static const token_t *_peek(size_t n)
+{
+    size_t pos = _pos + n;
+    return pos < _num_toks ? &_toks[pos] : &_toks[_num_toks - 1];
+}
+
+static const token_t *_next(void)
+{
+    const token_t *tok = _peek(0);
+
+    if (tok->kind != TOK_EOF) {
+        _pos++;
+    }
+    return tok;
+}
+
+static bool _is_punct(size_t n, const char *text)
+{
+    const token_t *tok = _peek(n);
+    return tok->kind == TOK_PUNCT && strcmp(tok->text, text) == 0;
+}
+
+static void _expect(const char *text)
+{
+    if (!_is_punct(0, text)) {
+        _fail(_peek(0)->line, "expected '%s'", text);
+    }
+    _next();
+}
+
+static int64_t _expect_int(void)
+{
+    const token_t *tok = _next();
+
+    if (tok->kind != TOK_INT) {
+        _fail(tok->line, "expected an integer");
+    }
+    return tok->num;
+}
+
+/* Copy @p name as C identifier */
+static void _c_name(char *out, const char *name, int line)
+{
+    size_t len = strlen(name);
+
+    if (len + 2 > NAME_LEN_MAX) {
+        _fail(line, "name too long");
+    }
+    if (isdigit((unsigned char)*name) || *name == '\0') {
+        *out++ = '_';
+    }
+    for (; *name; name++) {
+        *out++ = isalnum((unsigned char)*name) ? *name : '_';
+    }
+    *out = '\0';
+}
+
+/* Smallest integer width holding the range */
+static unsigned _range_width(int64_t lo, int64_t hi)
+{
+    unsigned width = 1;
+
+    if (lo >= 0) {
+        while (width < 8 && (uint64_t)hi >= (UINT64_C(1) << (8 * width))) {
+            width *= 2;
+        }
+        return width;
+    }
+    while (width < 8 && (lo < -(INT64_C(1) << (8 * width - 1)) ||
+                         hi >= (INT64_C(1) << (8 * width - 1)))) {
+        width *= 2;
+    }
+    return width;
+}
+
+static const struct {
+    const char *name;
+    type_kind_t kind;
+} _builtins[] = {
+    { "uint", TYPE_UINT },
+    { "int", TYPE_INT },
+    { "bool", TYPE_BOOL },
+    { "float16", TYPE_FLOAT },
+    { "float32", TYPE_FLOAT },
+    { "float64", TYPE_DOUBLE },
+    { "float", TYPE_DOUBLE },
+    { "tstr", TYPE_TSTR },
+    { "text", TYPE_TSTR },
+    { "bstr", TYPE_BSTR },
+    { "bytes", TYPE_BSTR },
+};
+
+static void _parse_group(type_t *type, const char *close);
+
+static type_t *_parse_type(void)
+{
+    const token_t *tok = _next();
+    type_t *type = _alloc(sizeof(type_t));
+
+    type->line = tok->line;
+    type->width = 8;
+
+    if (tok->kind == TOK_INT && _is_punct(0, "..")) {
+        _next();
+        type->lo = tok->num;
+        type->hi = _expect_int();
+        if (type->lo > type->hi) {
+            _fail(tok->line, "empty range");
+        }
+        type->kind = type->lo >= 0 ? TYPE_UINT : TYPE_INT;
+        type->width = _range_width(type->lo, type->hi);
+        type->ranged = true;
+    }
+    else if (tok->kind == TOK_INT) {
+        type->kind = TYPE_CONST_INT;
+        type->lo = tok->num;
+    }
+    else if (tok->kind == TOK_STR) {
+        type->kind = TYPE_CONST_STR;
+        strcpy(type->ref, tok->text);
+    }
+    else if (tok->kind == TOK_IDENT) {
+        type->kind = TYPE_REF;
+        strcpy(type->ref, tok->text);
+        for (size_t i = 0; i < sizeof(_builtins) / sizeof(_builtins[0]); i++) {
+            if (strcmp(tok->text, _builtins[i].name) == 0) {
+                type->kind = _builtins[i].kind;
+            }
+        }
+    }
+    else if (tok->kind == TOK_PUNCT && strcmp(tok->text, "[") == 0) {
+        type->kind = TYPE_ARRAY;
+        _parse_group(type, "]");
+    }
+    else if (tok->kind == TOK_PUNCT && strcmp(tok->text, "{") == 0) {
+        type->kind = TYPE_MAP;
+        _parse_group(type, "}");
+    }
+    else {
+        _fail(tok->line, "expected a type");
+    }
+
+    while (_peek(0)->kind == TOK_CTRL) {
+        tok = _next();
+        if (strcmp(tok->text, "size") != 0) {
+            _fail(tok->line, "unsupported control operator .%s", tok->text);
+        }
+        int64_t size = _expect_int();
+        if (type->kind == TYPE_TSTR || type->kind == TYPE_BSTR) {
+            if (size < 0) {
+                _fail(tok->line, "negative string size");
+            }
+            type->size = (uint64_t)size;
+            type->sized = true;
+        }
+        else if ((type->kind == TYPE_UINT || type->kind == TYPE_INT) &&
+                 !type->ranged &&
+                 (size == 1 || size == 2 || size == 4 || size == 8)) {
+            type->width = (unsigned)size;
+        }
+        else {
+            _fail(tok->line, ".size is only supported on strings and on "
+                  "integers with a size of 1, 2, 4 or 8");
+        }
+    }
+    return type;
+}
+
+static void _parse_occurrence(entry_t *entry)
+{
+    if (_is_punct(0, "?")) {
+        _next();
+        entry->optional = true;
+        return;
+    }
+    if (!_is_punct(0, "*") && !_is_punct(0, "+") &&
+        !(_peek(0)->kind == TOK_INT && _is_punct(1, "*"))) {
+        return;
+    }
+    entry->repeat = true;
+    entry->min = 0;
+    entry->max = UINT64_MAX;
+    if (_is_punct(0, "+")) {
+        _next();
+        entry->min = 1;
+        return;
+    }
+    if (_peek(0)->kind == TOK_INT) {
+        int64_t min = _expect_int();
+        if (min < 0) {
+            _fail(entry->line, "negative occurrence");
+        }
+        entry->min = (uint64_t)min;
+    }
+    _expect("*");
+    if (_peek(0)->kind == TOK_INT && !_is_punct(1, "=>") &&
+        !_is_punct(1, ":") && !_is_punct(1, "..")) {
+        int64_t max = _expect_int();
+        if (max < 0 || (uint64_t)max < entry->min) {
+            _fail(entry->line, "invalid occurrence");
+        }
+        entry->max = (uint64_t)max;
+    }
+}
+
+static void _parse_key(entry_t *entry, bool map)
+{
+    const token_t *tok = _peek(0);
+    bool colon = _is_punct(1, ":");
+    bool arrow = _is_punct(1, "=>");
+
+    if (!colon && !arrow) {
+        if (map) {
+            _fail(entry->line, "map entries need a key");
+        }
+        return;
+    }
+    if (tok->kind == TOK_IDENT && colon) {
+        _c_name(entry->name, tok->text, entry->line);
+        strcpy(entry->skey, tok->text);
+        entry->str_key = true;
+    }
+    else if (tok->kind == TOK_IDENT && arrow) {
+        _c_name(entry->name, tok->text, entry->line);
+        strcpy(entry->keyref, tok->text);
+    }
+    else if (tok->kind == TOK_INT) {
+        entry->ikey = tok->num;
+        if (tok->num < 0) {
+            snprintf(entry->name, sizeof(entry->name), "km%" PRIu64,
+                     (uint64_t)(-(tok->num + 1)) + 1);
+        }
+        else {
+            snprintf(entry->name, sizeof(entry->name), "k%" PRId64, tok->num);
+        }
+    }
+    else if (tok->kind == TOK_STR) {
+        _c_name(entry->name, tok->text, entry->line);
+        strcpy(entry->skey, tok->text);
+        entry->str_key = true;
+    }
+    else {
+        _fail(entry->line, "invalid member key");
+    }
+    if (!map && (arrow || tok->kind != TOK_IDENT)) {
+        _fail(entry->line, "array entries only take a name");
+    }
+    entry->has_key = map;
+    _next();
+    _next();
+}
+
+static void _parse_group(type_t *type, const char *close)
+{
+    bool map = type->kind == TYPE_MAP;
+
+    while (!_is_punct(0, close)) {
+        if (_peek(0)->kind == TOK_EOF) {
+            _fail(type->line, "unterminated group");
+        }
+        if (type->num == ENTRIES_MAX) {
+            _fail(_peek(0)->line, "too many entries");
+        }
+        entry_t *entry = &type->entries[type->num++];
+        entry->line = _peek(0)->line;
+
+        _parse_occurrence(entry);
+        _parse_key(entry, map);
+        entry->type = _parse_type();
+
+        if (entry->type->kind == TYPE_ARRAY || entry->type->kind == TYPE_MAP) {
+            _fail(entry->line, "nested containers must be separate rules");
+        }
+        if (entry->type->kind == TYPE_CONST_INT ||
+            entry->type->kind == TYPE_CONST_STR) {
+            _fail(entry->line, "literal values are only supported as keys");
+        }
+        if (_is_punct(0, ",")) {
+            _next();
+        }
+    }
+    _next();
+}
+
+static void _parse(void)
+{
+    while (_peek(0)->kind != TOK_EOF) {
+        const token_t *tok = _next();
+
+        if (tok->kind != TOK_IDENT) {
+            _fail(tok->line, "expected a rule name");
+        }
+        if (_num_rules == RULES_MAX) {
+            _fail(tok->line, "too many rules");
+        }
+        rule_t *rule = &_rules[_num_rules++];
+        strcpy(rule->name, tok->text);
+        _c_name(rule->cname, tok->text, tok->line);
+        rule->line = tok->line;
+        if (_is_punct(0, "/") || _is_punct(1, "/")) {
+            _fail(tok->line, "choices are not supported");
+        }
+        _expect("=");
+        rule->type = _parse_type();
+        if (_is_punct(0, "/")) {
+            _fail(tok->line, "choices are not supported");
+        }
+    }
+}
+
+/* Semantic checks */
+
+static rule_t *_find_rule(const char *name)
+{
+    for (size_t i = 0; i < _num_rules; i++) {
+        if (strcmp(_rules[i].name, name) == 0) {
+            return &_rules[i];
+        }
+    }
+    return NULL;
+}
+
+static bool _is_const(const rule_t *rule)
+{
+    return rule->type->kind == TYPE_CONST_INT ||
+           rule->type->kind == TYPE_CONST_STR;
+}
+
+static void _resolve(type_t *type)
+{
+    if (type->kind != TYPE_REF) {
+        return;
+    }
+    rule_t *rule = _find_rule(type->ref);
+    if (!rule) {
+        _fail(type->line, "unknown rule '%s'", type->ref);
+    }
+    if (_is_const(rule)) {
+        _fail(type->line, "constant '%s' used as type", type->ref);
+    }
+    type->rule = rule;
+}
+
+static void _check_entries(type_t *type)
+{
+    bool map = type->kind == TYPE_MAP;
+
+    for (size_t i = 0; i < type->num; i++) {
+        entry_t *entry = &type->entries[i];
+
+        _resolve(entry->type);
+        if (entry->keyref[0]) {
+            rule_t *rule = _find_rule(entry->keyref);
+            if (!rule || !_is_const(rule)) {
+                _fail(entry->line, "key '%s' is not a constant",
+                      entry->keyref);
+            }
+            if (rule->type->kind == TYPE_CONST_STR) {
+                strcpy(entry->skey, rule->type->ref);
+                entry->str_key = true;
+            }
+            else {
+                entry->ikey = rule->type->lo;
+            }
+        }
+        if (!map && entry->optional) {
+            _fail(entry->line, "optional array entries are not supported");
+        }
+        if (map && entry->repeat) {
+            _fail(entry->line, "repeated map entries are not supported");
+        }
+        if (entry->repeat && type->num != 1) {
+            _fail(entry->line, "a repeated entry must be the only entry of "
+                  "its array");
+        }
+        if (entry->repeat && entry->max == UINT64_MAX) {
+            _fail(entry->line, "repeated entries need an upper bound");
+        }
+        if (entry->repeat) {
+            strcpy(entry->name, "items");
+        }
+        else if (!entry->name[0]) {
+            snprintf(entry->name, sizeof(entry->name), "m%zu", i);
+        }
+        if (map && entry->str_key && strlen(entry->skey) > 23) {
+            _fail(entry->line, "text keys are limited to 23 bytes");
+        }
+        for (size_t j = 0; j < i; j++) {
+            const entry_t *other = &type->entries[j];
+            if (strcmp(other->name, entry->name) == 0) {
+                _fail(entry->line, "duplicate member '%s'", entry->name);
+            }
+            if (map && other->str_key == entry->str_key &&
+                (entry->str_key ? strcmp(other->skey, entry->skey) == 0
+                                : other->ikey == entry->ikey)) {
+                _fail(entry->line, "duplicate key");
+            }
+        }
+    }
+}
+
+static void _check(void)
+{
+    for (size_t i = 0; i < _num_rules; i++) {
+        rule_t *rule = &_rules[i];
+
+        for (size_t j = 0; j < i; j++) {
+            if (strcmp(_rules[j].cname, rule->cname) == 0) {
+                _fail(rule->line, "duplicate rule '%s'", rule->name);
+            }
+        }
+        _resolve(rule->type);
+        _check_entries(rule->type);
+    }
+}
+
+/* Encoded size bounds */
+
+static uint64_t _head_size(uint64_t arg)
+{
+    return arg < 24 ? 1 : arg <= UINT8_MAX ? 2 : arg <= UINT16_MAX ? 3
+         : arg <= UINT32_MAX ? 5 : 9;
+}
+
+/* Natural range of the C type of an integer */
+static void _natural_range(const type_t *type, int64_t *lo, uint64_t *hi)
+{
+    unsigned bits = type->width * 8;
+
+    if (type->kind == TYPE_UINT) {
+        *lo = 0;
+        *hi = bits == 64 ? UINT64_MAX : (UINT64_C(1) << bits) - 1;
+    }
+    else {
+        *lo = bits == 64 ? INT64_MIN : -(INT64_C(1) << (bits - 1));
+        *hi = (UINT64_C(1) << (bits - 1)) - 1;
+    }
+}
+
+static uint64_t _int_max_arg(const type_t *type)
+{
+    int64_t lo = type->lo;
+    uint64_t hi = (uint64_t)type->hi;
+
+    if (!type->ranged) {
+        _natural_range(type, &lo, &hi);
+    }
+    uint64_t neg = lo < 0 ? (uint64_t)(-(lo + 1)) : 0;
+    if (type->ranged && type->hi < 0) {
+        hi = 0;
+    }
+    return hi > neg ? hi : neg;
+}
+
+static bool _add_bound(uint64_t *size, uint64_t add)
+{
+    if (add > SIZE_BOUND_MAX || *size + add > SIZE_BOUND_MAX) {
+        return false;
+    }
+    *size += add;
+    return true;
+}
+
+static bool _max_size(const type_t *type, uint64_t *size);
+
+static bool _key_size(const entry_t *entry, uint64_t *size)
+{
+    if (entry->str_key) {
+        size_t len = strlen(entry->skey);
+        return _add_bound(size, _head_size(len) + len);
+    }
+    return _add_bound(size, _head_size(entry->ikey < 0
+                                       ? (uint64_t)(-(entry->ikey + 1))
+                                       : (uint64_t)entry->ikey));
+}
+
+static bool _max_size(const type_t *type, uint64_t *size)
+{
+    uint64_t item = 0;
+
+    switch (type->kind) {
+    case TYPE_UINT:
+    case TYPE_INT:
+        return _add_bound(size, _head_size(_int_max_arg(type)));
+    case TYPE_BOOL:
+        return _add_bound(size, 1);
+    case TYPE_FLOAT:
+        return _add_bound(size, 1 + sizeof(float));
+    case TYPE_DOUBLE:
+        return _add_bound(size, 1 + sizeof(double));
+    case TYPE_TSTR:
+    case TYPE_BSTR:
+        return type->sized && _add_bound(size, _head_size(type->size)) &&
+               _add_bound(size, type->size);
+    case TYPE_REF:
+        return _max_size(type->rule->type, size);
+    case TYPE_ARRAY:
+        if (type->num == 1 && type->entries[0].repeat) {
+            uint64_t max = type->entries[0].max;
+            if (!_max_size(type->entries[0].type, &item) ||
+                (item && max > SIZE_BOUND_MAX / item)) {
+                return false;
+            }
+            return _add_bound(size, _head_size(max)) &&
+                   _add_bound(size, item * max);
+        }
+    /* fall through */
+    case TYPE_MAP:
+        if (!_add_bound(size, _head_size(type->num))) {
+            return false;
+        }
+        for (size_t i = 0; i < type->num; i++) {
+            if ((type->kind == TYPE_MAP && !_key_size(&type->entries[i], size)) ||
+                !_max_size(type->entries[i].type, size)) {
+                return false;
+            }
+        }
+        return true;
+    case TYPE_CONST_INT:
+    case TYPE_CONST_STR:
+        break;
+    }
+    return false;
+}
+
+/* Code generation */
+
+static void _out(FILE *f, int indent, const char *fmt, ...)
+{
+    va_list args;
+
+    fprintf(f, "%*s", indent * 4, "");
+    va_start(args, fmt);
+    vfprintf(f, fmt, args);
+    va_end(args);
+}
+
+static void _upper(char *out, const char *in)
+{
+    for (; *in; in++) {
+        *out++ = (char)toupper((unsigned char)*in);
+    }
+    *out = '\0';
+}
+
+static const char *_c_type(const type_t *type, char *buf, size_t len)
+{
+    switch (type->kind) {
+    case TYPE_UINT:
+        snprintf(buf, len, "uint%u_t", type->width * 8);
+        break;
+    case TYPE_INT:
+        snprintf(buf, len, "int%u_t", type->width * 8);
+        break;
+    case TYPE_BOOL:
+        snprintf(buf, len, "bool");
+        break;
+    case TYPE_FLOAT:
+        snprintf(buf, len, "float");
+        break;
+    case TYPE_DOUBLE:
+        snprintf(buf, len, "double");
+        break;
+    case TYPE_TSTR:
+    case TYPE_BSTR:
+        snprintf(buf, len, "%sstr_t", _prefix);
+        break;
+    case TYPE_REF:
+        snprintf(buf, len, "%s%s_t", _prefix, type->rule->cname);
+        break;
+    default:
+        buf[0] = '\0';
+        break;
+    }
+    return buf;
+}
+
+/* Value expressions: @p val is the lvalue, @p ptr its address and @p mem
+ * the prefix for struct member access */
+typedef struct {
+    char val[3 * NAME_LEN_MAX];
+    char ptr[3 * NAME_LEN_MAX];
+    char mem[3 * NAME_LEN_MAX];
+} expr_t;
+
+static void _expr_member(expr_t *expr, const char *fmt, const char *name)
+{
+    char member[2 * NAME_LEN_MAX];
+
+    snprintf(member, sizeof(member), fmt, name);
+    snprintf(expr->val, sizeof(expr->val), "v->%s", member);
+    snprintf(expr->ptr, sizeof(expr->ptr), "&v->%s", member);
+    snprintf(expr->mem, sizeof(expr->mem), "v->%s.", member);
+}
+
+static void _expr_self(expr_t *expr)
+{
+    strcpy(expr->val, "*v");
+    strcpy(expr->ptr, "v");
+    strcpy(expr->mem, "v->");
+}
+
+static void _ret_if(FILE *c, int indent, const char *cond, const char *ret)
+{
+    _out(c, indent, "if (%s) {\n", cond);
+    _out(c, indent + 1, "return %s;\n", ret);
+    _out(c, indent, "}\n");
+}
+
+static void _call(FILE *c, int indent, const char *fmt, ...)
+{
+    char call[512];
+    char cond[600];
+    va_list args;
+
+    va_start(args, fmt);
+    vsnprintf(call, sizeof(call), fmt, args);
+    va_end(args);
+    snprintf(cond, sizeof(cond), "(res = %s) < 0", call);
+    _ret_if(c, indent, cond, "res");
+}
+
+/* Checks of an integer value against a range narrower than its C type */
+static void _range_check(FILE *c, int indent, const type_t *type,
+                         const char *val)
+{
+    int64_t lo = 0;
+    uint64_t hi = 0;
+    char cond[256];
+
+    if (!type->ranged) {
+        return;
+    }
+    _natural_range(type, &lo, &hi);
+    if (type->lo > lo && type->kind == TYPE_UINT) {
+        snprintf(cond, sizeof(cond), "(uint64_t)%s < UINT64_C(%" PRIu64 ")",
+                 val, (uint64_t)type->lo);
+        _ret_if(c, indent, cond, "NANOCBOR_ERR_OVERFLOW");
+    }
+    else if (type->lo > lo) {
+        snprintf(cond, sizeof(cond), "(int64_t)%s < INT64_C(%" PRId64 ")",
+                 val, type->lo);
+        _ret_if(c, indent, cond, "NANOCBOR_ERR_OVERFLOW");
+    }
+    if ((type->hi < 0 || (uint64_t)type->hi < hi) && type->kind == TYPE_UINT) {
+        snprintf(cond, sizeof(cond), "(uint64_t)%s > UINT64_C(%" PRIu64 ")",
+                 val, (uint64_t)type->hi);
+        _ret_if(c, indent, cond, "NANOCBOR_ERR_OVERFLOW");
+    }
+    else if (type->hi < 0 || (uint64_t)type->hi < hi) {
+        snprintf(cond, sizeof(cond), "(int64_t)%s > INT64_C(%" PRId64 ")",
+                 val, type->hi);
+        _ret_if(c, indent, cond, "NANOCBOR_ERR_OVERFLOW");
+    }
+}
+
+static void _str_check(FILE *c, int indent, const type_t *type,
+                       const expr_t *expr)
+{
+    char cond[256];
+
+    if (type->sized) {
+        snprintf(cond, sizeof(cond), "%slen > %" PRIu64 "U", expr->mem,
+                 type->size);
+        _ret_if(c, indent, cond, "NANOCBOR_ERR_OVERFLOW");
+    }
+}
+
+static void _run_add(run_t *run, const uint8_t *buf, size_t len)
+{
+    if (run->len + len > sizeof(run->buf)) {
+        fprintf(stderr, "constant run too long\n");
+        exit(EXIT_FAILURE);
+    }
+    memcpy(run->buf + run->len, buf, len);
+    run->len += len;
+}
+
+static void _run_head(run_t *run, uint8_t major, uint64_t arg)
+{
+    uint8_t buf[9];
+    size_t len = (size_t)_head_size(arg);
+
+    buf[0] = (uint8_t)(major << 5);
+    if (len == 1) {
+        buf[0] |= (uint8_t)arg;
+    }
+    else {
+        buf[0] |= (uint8_t)(len == 2 ? 24 : len == 3 ? 25 : len == 5 ? 26 : 27);
+        for (size_t i = 1; i < len; i++) {
+            buf[i] = (uint8_t)(arg >> (8 * (len - 1 - i)));
+        }
+    }
+    _run_add(run, buf, len);
+}
+
+static void _run_key(run_t *run, const entry_t *entry)
+{
+    if (entry->str_key) {
+        size_t len = strlen(entry->skey);
+        _run_head(run, 3, len);
+        _run_add(run, (const uint8_t *)entry->skey, len);
+    }
+    else if (entry->ikey < 0) {
+        _run_head(run, 1, (uint64_t)(-(entry->ikey + 1)));
+    }
+    else {
+        _run_head(run, 0, (uint64_t)entry->ikey);
+    }
+}
+
+/* Write the pending constant bytes with a single copy */
+static void _run_flush(FILE *c, int indent, run_t *run)
+{
+    if (!run->len) {
+        return;
+    }
+    _out(c, indent, "static const uint8_t hdr%u[] = {", run->count);
+    for (size_t i = 0; i < run->len; i++) {
+        fprintf(c, "%s0x%02x", i ? ", " : " ", run->buf[i]);
+    }
+    fprintf(c, " };\n");
+    _call(c, indent, "nanocbor_put_raw(enc, hdr%u, sizeof(hdr%u))",
+          run->count, run->count);
+    run->count++;
+    run->len = 0;
+}
+
+static void _encode_value(FILE *c, int indent, const type_t *type,
+                          const expr_t *expr, run_t *run)
+{
+    _run_flush(c, indent, run);
+
+    switch (type->kind) {
+    case TYPE_UINT:
+        _range_check(c, indent, type, expr->val);
+        _call(c, indent, "nanocbor_fmt_uint(enc, %s)", expr->val);
+        break;
+    case TYPE_INT:
+        _range_check(c, indent, type, expr->val);
+        _call(c, indent, "nanocbor_fmt_int(enc, %s)", expr->val);
+        break;
+    case TYPE_BOOL:
+        _call(c, indent, "nanocbor_fmt_bool(enc, %s)", expr->val);
+        break;
+    case TYPE_FLOAT:
+        _call(c, indent, "nanocbor_fmt_float(enc, %s)", expr->val);
+        break;
+    case TYPE_DOUBLE:
+        _call(c, indent, "nanocbor_fmt_double(enc, %s)", expr->val);
+        break;
+    case TYPE_TSTR:
+    case TYPE_BSTR:
+        _str_check(c, indent, type, expr);
+        _call(c, indent, "nanocbor_fmt_%s(enc, %slen)",
+              type->kind == TYPE_TSTR ? "tstr" : "bstr", expr->mem);
+        _call(c, indent, "nanocbor_put_raw(enc, %sbuf, %slen)", expr->mem,
+              expr->mem);
+        break;
+    case TYPE_REF:
+        _call(c, indent, "%s%s_encode(enc, %s)", _prefix, type->rule->cname,
+              expr->ptr);
+        break;
+    default:
+        break;
+    }
+}
+
+static void _decode_value(FILE *c, int indent, const type_t *type,
+                          const char *dec, const expr_t *expr)
+{
+    switch (type->kind) {
+    case TYPE_UINT:
+        _call(c, indent, "nanocbor_get_uint%u(%s, %s)", type->width * 8, dec,
+              expr->ptr);
+        _range_check(c, indent, type, expr->val);
+        break;
+    case TYPE_INT:
+        _call(c, indent, "nanocbor_get_int%u(%s, %s)", type->width * 8, dec,
+              expr->ptr);
+        _range_check(c, indent, type, expr->val);
+        break;
+    case TYPE_BOOL:
+        _call(c, indent, "nanocbor_get_bool(%s, %s)", dec, expr->ptr);
+        break;
+    case TYPE_FLOAT:
+        _call(c, indent, "nanocbor_get_float(%s, %s)", dec, expr->ptr);
+        break;
+    case TYPE_DOUBLE:
+        _call(c, indent, "nanocbor_get_double(%s, %s)", dec, expr->ptr);
+        break;
+    case TYPE_TSTR:
+    case TYPE_BSTR:
+        _call(c, indent, "nanocbor_get_%s(%s, &%sbuf, &%slen)",
+              type->kind == TYPE_TSTR ? "tstr" : "bstr", dec, expr->mem,
+              expr->mem);
+        _str_check(c, indent, type, expr);
+        break;
+    case TYPE_REF:
+        _call(c, indent, "%s%s_decode(%s, %s)", _prefix, type->rule->cname,
+              dec, expr->ptr);
+        break;
+    default:
+        break;
+    }
+}
+
+static void _encode_array(FILE *c, const type_t *type, run_t *run)
+{
+    const entry_t *first = &type->entries[0];
+    expr_t expr;
+    char cond[128];
+
+    if (type->num == 1 && first->repeat) {
+        if (first->min > 0) {
+            snprintf(cond, sizeof(cond), "v->count < %" PRIu64 "U || "
+                     "v->count > %" PRIu64 "U", first->min, first->max);
+        }
+        else {
+            snprintf(cond, sizeof(cond), "v->count > %" PRIu64 "U",
+                     first->max);
+        }
+        _ret_if(c, 1, cond, "NANOCBOR_ERR_OVERFLOW");
+        _call(c, 1, "nanocbor_fmt_array(enc, v->count)");
+        _out(c, 1, "for (size_t i = 0; i < v->count; i++) {\n");
+        _expr_member(&expr, "%s[i]", first->name);
+        _encode_value(c, 2, first->type, &expr, run);
+        _out(c, 1, "}\n");
+        return;
+    }
+    _run_head(run, 4, type->num);
+    for (size_t i = 0; i < type->num; i++) {
+        _expr_member(&expr, "%s", type->entries[i].name);
+        _encode_value(c, 1, type->entries[i].type, &expr, run);
+    }
+}
+
+static void _encode_map(FILE *c, const type_t *type, run_t *run)
+{
+    size_t required = 0;
+    bool optional = false;
+    expr_t expr;
+
+    for (size_t i = 0; i < type->num; i++) {
+        if (type->entries[i].optional) {
+            optional = true;
+        }
+        else {
+            required++;
+        }
+    }
+    if (optional) {
+        _out(c, 1, "size_t num = %zu;\n", required);
+        for (size_t i = 0; i < type->num; i++) {
+            if (type->entries[i].optional) {
+                _out(c, 1, "num += v->has_%s;\n", type->entries[i].name);
+            }
+        }
+        _call(c, 1, "nanocbor_fmt_map(enc, num)");
+    }
+    else {
+        _run_head(run, 5, type->num);
+    }
+    for (size_t i = 0; i < type->num; i++) {
+        const entry_t *entry = &type->entries[i];
+        int indent = 1;
+
+        _expr_member(&expr, "%s", entry->name);
+        if (entry->optional) {
+            _run_flush(c, indent, run);
+            _out(c, indent++, "if (v->has_%s) {\n", entry->name);
+        }
+        _run_key(run, entry);
+        _encode_value(c, indent, entry->type, &expr, run);
+        if (entry->optional) {
+            _out(c, 1, "}\n");
+        }
+    }
+}
+
+static void _leave(FILE *c, const char *container)
+{
+    char cond[64];
+
+    snprintf(cond, sizeof(cond), "nanocbor_needs_input(&%s)", container);
+    _ret_if(c, 1, cond, "NANOCBOR_ERR_END");
+}
+
+static void _decode_array(FILE *c, const type_t *type)
+{
+    const entry_t *first = &type->entries[0];
+    expr_t expr;
+    char cond[64];
+
+    _out(c, 1, "nanocbor_value_t arr;\n");
+    _call(c, 1, "nanocbor_enter_array(it, &arr)");
+    if (type->num == 1 && first->repeat) {
+        _out(c, 1, "v->count = 0;\n");
+        _out(c, 1, "while (!nanocbor_at_end(&arr)) {\n");
+        snprintf(cond, sizeof(cond), "v->count == %" PRIu64 "U", first->max);
+        _ret_if(c, 2, cond, "NANOCBOR_ERR_OVERFLOW");
+        _expr_member(&expr, "%s[v->count]", first->name);
+        _decode_value(c, 2, first->type, "&arr", &expr);
+        _out(c, 2, "v->count++;\n");
+        _out(c, 1, "}\n");
+        _leave(c, "arr");
+        if (first->min > 0) {
+            snprintf(cond, sizeof(cond), "v->count < %" PRIu64 "U", first->min);
+            _ret_if(c, 1, cond, "NANOCBOR_ERR_INVALID_TYPE");
+        }
+    }
+    else {
+        for (size_t i = 0; i < type->num; i++) {
+            _expr_member(&expr, "%s", type->entries[i].name);
+            _decode_value(c, 1, type->entries[i].type, "&arr", &expr);
+        }
+        _ret_if(c, 1, "!nanocbor_at_end(&arr)", "NANOCBOR_ERR_INVALID_TYPE");
+        _leave(c, "arr");
+    }
+    _out(c, 1, "nanocbor_leave_container(it, &arr);\n");
+}
+
+static void _decode_map(FILE *c, const type_t *type)
+{
+    bool int_keys = false;
+    bool str_keys = false;
+    uint32_t required = 0;
+    expr_t expr;
+
+    for (size_t i = 0; i < type->num; i++) {
+        const entry_t *entry = &type->entries[i];
+        if (entry->str_key) {
+            str_keys = true;
+        }
+        else {
+            int_keys = true;
+        }
+        if (!entry->optional) {
+            required |= UINT32_C(1) << i;
+        }
+    }
+
+    _out(c, 1, "nanocbor_value_t map;\n");
+    _out(c, 1, "uint32_t found = 0;\n");
+    _call(c, 1, "nanocbor_enter_map(it, &map)");
+    _out(c, 1, "while (!nanocbor_at_end(&map)) {\n");
+    _out(c, 2, "int type = nanocbor_get_type(&map);\n");
+    _out(c, 2, "int idx = -1;\n");
+    _out(c, 2, "");
+    if (int_keys) {
+        fprintf(c, "if (type == NANOCBOR_TYPE_UINT || "
+                "type == NANOCBOR_TYPE_NINT) {\n");
+        _out(c, 3, "int64_t key = 0;\n");
+        _out(c, 3, "res = nanocbor_get_int64(&map, &key);\n");
+        _out(c, 3, "switch (res < 0 ? INT64_MIN : key) {\n");
+        for (size_t i = 0; i < type->num; i++) {
+            const entry_t *entry = &type->entries[i];
+            if (!entry->str_key) {
+                _out(c, 3, "case INT64_C(%" PRId64 "):\n", entry->ikey);
+                _out(c, 4, "idx = %zu;\n", i);
+                _out(c, 4, "break;\n");
+            }
+        }
+        _out(c, 3, "default:\n");
+        _out(c, 4, "break;\n");
+        _out(c, 3, "}\n");
+        _out(c, 3, "if (res == NANOCBOR_ERR_OVERFLOW) {\n");
+        _out(c, 4, "res = nanocbor_skip(&map);\n");
+        _out(c, 3, "}\n");
+        _out(c, 2, "}\n");
+        _out(c, 2, "else ");
+    }
+    if (str_keys) {
+        fprintf(c, "if (type == NANOCBOR_TYPE_TSTR) {\n");
+        _out(c, 3, "const uint8_t *key = NULL;\n");
+        _out(c, 3, "size_t key_len = 0;\n");
+        _out(c, 3, "res = nanocbor_get_tstr(&map, &key, &key_len);\n");
+        bool first = true;
+        for (size_t i = 0; i < type->num; i++) {
+            const entry_t *entry = &type->entries[i];
+            if (entry->str_key) {
+                size_t len = strlen(entry->skey);
+                _out(c, 3, "%sif (res == NANOCBOR_OK && key_len == %zuU && "
+                     "memcmp(key, \"%s\", %zuU) == 0) {\n",
+                     first ? "" : "else ", len, entry->skey, len);
+                _out(c, 4, "idx = %zu;\n", i);
+                _out(c, 3, "}\n");
+                first = false;
+            }
+        }
+        _out(c, 2, "}\n");
+        _out(c, 2, "else ");
+    }
+    fprintf(c, "{\n");
+    _out(c, 3, "res = nanocbor_skip(&map);\n");
+    _out(c, 2, "}\n");
+    _ret_if(c, 2, "res < 0", "res");
+    _out(c, 2, "/* Only the first occurrence of a key is used */\n");
+    _out(c, 2, "if (idx >= 0 && (found & (UINT32_C(1) << idx))) {\n");
+    _out(c, 3, "idx = -1;\n");
+    _out(c, 2, "}\n");
+    _out(c, 2, "switch (idx) {\n");
+    for (size_t i = 0; i < type->num; i++) {
+        _out(c, 2, "case %zu:\n", i);
+        _expr_member(&expr, "%s", type->entries[i].name);
+        _decode_value(c, 3, type->entries[i].type, "&map", &expr);
+        _out(c, 3, "break;\n");
+    }
+    _out(c, 2, "default:\n");
+    _call(c, 3, "nanocbor_skip(&map)");
+    _out(c, 3, "break;\n");
+    _out(c, 2, "}\n");
+    _out(c, 2, "if (idx >= 0) {\n");
+    _out(c, 3, "found |= UINT32_C(1) << idx;\n");
+    _out(c, 2, "}\n");
+    _out(c, 1, "}\n");
+    _leave(c, "map");
+    if (required) {
+        char cond[64];
+        snprintf(cond, sizeof(cond), "(found & 0x%08" PRIx32 "U) != "
+                 "0x%08" PRIx32 "U", required, required);
+        _ret_if(c, 1, cond, "NANOCBOR_NOT_FOUND");
+    }
+    for (size_t i = 0; i < type->num; i++) {
+        if (type->entries[i].optional) {
+            _out(c, 1, "v->has_%s = (found & 0x%08" PRIx32 "U) != 0;\n",
+                 type->entries[i].name, UINT32_C(1) << i);
+        }
+    }
+    _out(c, 1, "nanocbor_leave_container(it, &map);\n");
+}
+
+static void _emit_struct(FILE *h, const rule_t *rule)
+{
+    const type_t *type = rule->type;
+    char ctype[2 * NAME_LEN_MAX];
+
+    switch (type->kind) {
+    case TYPE_ARRAY:
+    case TYPE_MAP:
+        break;
+    default:
+        _out(h, 0, "typedef %s %s%s_t;\n", _c_type(type, ctype, sizeof(ctype)),
+             _prefix, rule->cname);
+        return;
+    }
+    _out(h, 0, "typedef struct %s%s {\n", _prefix, rule->cname);
+    for (size_t i = 0; i < type->num; i++) {
+        const entry_t *entry = &type->entries[i];
+        _c_type(entry->type, ctype, sizeof(ctype));
+        if (entry->repeat) {
+            _out(h, 1, "size_t count;\n");
+            _out(h, 1, "%s %s[%" PRIu64 "];\n", ctype, entry->name,
+                 entry->max);
+        }
+        else {
+            _out(h, 1, "%s %s;\n", ctype, entry->name);
+        }
+        if (entry->optional) {
+            _out(h, 1, "bool has_%s;\n", entry->name);
+        }
+    }
+    _out(h, 0, "} %s%s_t;\n", _prefix, rule->cname);
+}
+
+static void _emit_rule(FILE *h, FILE *c, rule_t *rule)
+{
+    const type_t *type = rule->type;
+    char upper[NAME_LEN_MAX];
+    uint64_t size = 0;
+    run_t run;
+    expr_t expr;
+
+    if (rule->state == 2 || _is_const(rule)) {
+        return;
+    }
+    if (rule->state == 1) {
+        _fail(rule->line, "recursive rule '%s'", rule->name);
+    }
+    rule->state = 1;
+    /* Referenced structs are defined first */
+    if (type->kind == TYPE_REF) {
+        _emit_rule(h, c, (rule_t *)type->rule);
+    }
+    for (size_t i = 0; i < type->num; i++) {
+        if (type->entries[i].type->kind == TYPE_REF) {
+            _emit_rule(h, c, (rule_t *)type->entries[i].type->rule);
+        }
+    }
+    rule->state = 2;
+
+    _upper(upper, rule->cname);
+    fprintf(h, "/**\n * @brief CDDL rule `%s`\n */\n", rule->name);
+    _emit_struct(h, rule);
+    fprintf(h, "\n");
+    if (_max_size(type, &size)) {
+        fprintf(h, "/**\n * @brief Maximum encoded size of @ref %s%s_t\n */\n",
+                _prefix, rule->cname);
+        fprintf(h, "#define %s%s_MAX_SIZE (%" PRIu64 "U)\n\n", _uprefix,
+                upper, size);
+    }
+    fprintf(h, "/**\n * @brief Encode a @ref %s%s_t\n *\n", _prefix,
+            rule->cname);
+    fprintf(h, " * @return NANOCBOR_OK on success, negative on error\n */\n");
+    fprintf(h, "int %s%s_encode(nanocbor_encoder_t *enc, const %s%s_t *v);\n\n",
+            _prefix, rule->cname, _prefix, rule->cname);
+    fprintf(h, "/**\n * @brief Decode a @ref %s%s_t\n *\n", _prefix,
+            rule->cname);
+    fprintf(h, " * @return NANOCBOR_OK on success, negative on error\n */\n");
+    fprintf(h, "int %s%s_decode(nanocbor_value_t *it, %s%s_t *v);\n\n",
+            _prefix, rule->cname, _prefix, rule->cname);
+
+    memset(&run, 0, sizeof(run));
+    fprintf(c, "int %s%s_encode(nanocbor_encoder_t *enc, const %s%s_t *v)\n{\n",
+            _prefix, rule->cname, _prefix, rule->cname);
+    _out(c, 1, "int res = 0;\n\n");
+    if (type->kind == TYPE_ARRAY) {
+        _encode_array(c, type, &run);
+    }
+    else if (type->kind == TYPE_MAP) {
+        _encode_map(c, type, &run);
+    }
+    else {
+        _expr_self(&expr);
+        _encode_value(c, 1, type, &expr, &run);
+    }
+    _run_flush(c, 1, &run);
+    _out(c, 1, "return NANOCBOR_OK;\n}\n\n");
+
+    fprintf(c, "int %s%s_decode(nanocbor_value_t *it, %s%s_t *v)\n{\n",
+            _prefix, rule->cname, _prefix, rule->cname);
+    _out(c, 1, "int res = 0;\n\n");
+    if (type->kind == TYPE_ARRAY) {
+        _decode_array(c, type);
+    }
+    else if (type->kind == TYPE_MAP) {
+        _decode_map(c, type);
+    }
+    else {
+        _expr_self(&expr);
+        _decode_value(c, 1, type, "it", &expr);
+    }
+    _out(c, 1, "return NANOCBOR_OK;\n}\n\n");
+}
+
+static char *_read_file(const char *path)
+{
+    FILE *f = fopen(path, "rb");
+    size_t len = 0;
+    size_t size = 4096;
+    char *buf = NULL;
+
+    if (!f) {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+    buf = _alloc(size);
+    for (;;) {
+        len += fread(buf + len, 1, size - len - 1, f);
+        if (len < size - 1) {
+            break;
+        }
+        size *= 2;
+        char *tmp = realloc(buf, size);
+        if (!tmp) {
+            fprintf(stderr, "out of memory\n");
+            exit(EXIT_FAILURE);
+        }
+        buf = tmp;
+    }
+    buf[len] = '\0';
+    fclose(f);
+    return buf;
+}
+
+static FILE *_open(const char *base, const char *ext)
+{
+    char path[4096];
+    FILE *f = NULL;
+
+    snprintf(path, sizeof(path), "%s%s", base, ext);
+    f = fopen(path, "w");
+    if (!f) {
+        perror(path);
+        exit(EXIT_FAILURE);
+    }
+    return f;
+}
+
+static void _usage(const char *name)
+{
+    fprintf(stderr, "usage: %s [-p prefix] input.cddl output\n"
+            "Writes output.h and output.c\n", name);
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char **argv)
+{
+    int arg = 1;
+
+    if (arg + 1 < argc && strcmp(argv[arg], "-p") == 0) {
+        _prefix = argv[arg + 1];
+        arg += 2;
+    }
+    if (argc - arg != 2 || strlen(_prefix) >= NAME_LEN_MAX / 2) {
+        _usage(argv[0]);
+    }
+    _upper(_uprefix, _prefix);
+    _file = argv[arg];
+    const char *base = argv[arg + 1];
+    const char *name = strrchr(base, '/') ? strrchr(base, '/') + 1 : base;
+
+    char *src = _read_file(_file);
+    _tokenize(src);
+    _parse();
+    _check();
+
+    char guard[NAME_LEN_MAX * 2];
+    _c_name(guard, name, 0);
+    _upper(guard, guard);
+    strcat(guard, "_H");
+
+    FILE *h = _open(base, ".h");
+    FILE *c = _open(base, ".c");
+
+    fprintf(h, "/*\n * Generated by cddlgen from %s, do not edit\n */\n\n",
+            _file);
+    fprintf(h, "#ifndef %s\n#define %s\n\n", guard, guard);
+    fprintf(h, "#include <stdbool.h>\n#include <stddef.h>\n"
+            "#include <stdint.h>\n\n#include \"nanocbor/nanocbor.h\"\n\n");
+    fprintf(h, "#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n");
+    fprintf(h, "/**\n * @brief String pointing into the decoded buffer\n */\n");
+    fprintf(h, "typedef struct {\n    const uint8_t *buf;\n    size_t len;\n"
+            "} %sstr_t;\n\n", _prefix);
+
+    fprintf(c, "/*\n * Generated by cddlgen from %s, do not edit\n */\n\n",
+            _file);
+    fprintf(c, "#include <stdbool.h>\n#include <stddef.h>\n"
+            "#include <stdint.h>\n#include <string.h>\n\n"
+            "#include \"nanocbor/nanocbor.h\"\n#include \"%s.h\"\n\n", name);
+
+    for (size_t i = 0; i < _num_rules; i++) {
+        _emit_rule(h, c, &_rules[i]);
+    }
+
+    fprintf(h, "#ifdef __cplusplus\n}\n#endif\n\n#endif /* %s */\n", guard);
+    fclose(h);
+    fclose(c);
+    free(src);
+    return 0;
+}